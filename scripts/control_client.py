@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+#
+# Sends commands to the control socket of a running RazerGenie, see
+# src/controlserver.h for the protocol. Meant for trying it out and as an
+# example for writing clients.
+#
+# Usage:
+#   control_client.py brightness <serial> <percent>
+#   control_client.py static <serial> <rrggbb>
+#   control_client.py frame <serial> <rows> <columns> <rrggbb>
+#   control_client.py profile <name>
+#   control_client.py bench <serial> <rows> <columns> [frames]
+#     Sends frames as fast as the replies come back and prints the rate.
+
+import os
+import socket
+import struct
+import sys
+import time
+
+STATUS = ['ok', 'malformed', 'unknown device', 'failed', 'replaced']
+# Values of openrazer::Effect
+STATIC_EFFECT = 2
+ALL_LEDS = 255
+
+
+def string(value):
+    data = value.encode()
+    return struct.pack('>B', len(data)) + data
+
+
+def set_brightness(serial, percent):
+    return struct.pack('>B', 2) + string(serial) + struct.pack('>BB', ALL_LEDS, percent)
+
+
+def set_static(serial, color):
+    return struct.pack('>B', 1) + string(serial) + struct.pack('>BBB', ALL_LEDS, STATIC_EFFECT, 1) + color
+
+
+def push_frame(serial, rows, columns, colors):
+    return struct.pack('>B', 3) + string(serial) + struct.pack('>BB', rows, columns) + colors
+
+
+def apply_profile(name):
+    return struct.pack('>B', 4) + string(name)
+
+
+def receive(sock, size):
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError('connection closed')
+        data += chunk
+    return data
+
+
+def send_batch(sock, commands):
+    payload = struct.pack('>H', len(commands)) + b''.join(commands)
+    sock.sendall(struct.pack('>I', len(payload)) + payload)
+    length, = struct.unpack('>I', receive(sock, 4))
+    reply = receive(sock, length)
+    count, = struct.unpack('>H', reply[:2])
+    return [STATUS[status] for status in reply[2:2 + count]]
+
+
+def main():
+    if len(sys.argv) < 3:
+        print('Usage: %s <brightness|static|frame|profile|bench> <arguments>, see the script' % sys.argv[0])
+        sys.exit(1)
+
+    path = os.path.join(os.environ.get('XDG_RUNTIME_DIR', '/tmp'), 'razergenie.sock')
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(path)
+
+    command = sys.argv[1]
+    if command == 'brightness':
+        print(send_batch(sock, [set_brightness(sys.argv[2], int(sys.argv[3]))]))
+    elif command == 'static':
+        print(send_batch(sock, [set_static(sys.argv[2], bytes.fromhex(sys.argv[3]))]))
+    elif command == 'frame':
+        rows, columns = int(sys.argv[3]), int(sys.argv[4])
+        colors = bytes.fromhex(sys.argv[5]) * (rows * columns)
+        print(send_batch(sock, [push_frame(sys.argv[2], rows, columns, colors)]))
+    elif command == 'profile':
+        print(send_batch(sock, [apply_profile(sys.argv[2])]))
+    elif command == 'bench':
+        rows, columns = int(sys.argv[3]), int(sys.argv[4])
+        frames = int(sys.argv[5]) if len(sys.argv) > 5 else 500
+        start = time.monotonic()
+        for i in range(frames):
+            colors = bytes([i % 256, 0, 255 - i % 256]) * (rows * columns)
+            send_batch(sock, [push_frame(sys.argv[2], rows, columns, colors)])
+        elapsed = time.monotonic() - start
+        print('%d frames in %.2f s, %.1f frames/s' % (frames, elapsed, frames / elapsed))
+    else:
+        print('Unknown command %s' % command)
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,56 @@
+#!/bin/bash -e
+#
+# Creates a fake openrazer attribute tree for trying out the sysfs backend
+# without hardware. It contains a keyboard and a wireless mouse.
+#
+# Writes end up in the files, so what RazerGenie sent can be inspected with
+# e.g. 'xxd <root>/bus/hid/drivers/razerkbd/*/matrix_custom_frame'.
+#
+# Usage: fake_sysfs.sh [root]
+# Then run: RAZERGENIE_SYSFS_ROOT=<root> razergenie (with the "sysfs" backend selected)
+
+ROOT=${1:-$(mktemp -d)}
+
+keyboard=$ROOT/bus/hid/drivers/razerkbd/0003:1532:0203.0001
+mouse=$ROOT/bus/hid/drivers/razermouse/0003:1532:0073.0002
+
+mkdir -p "$keyboard" "$mouse" "$ROOT/module/razerkbd" "$ROOT/module/razermouse"
+# The second interface of the keyboard is bound too, but without attributes
+mkdir -p "$ROOT/bus/hid/drivers/razerkbd/0003:1532:0203.0003"
+
+echo "3.0.1" > "$ROOT/module/razerkbd/version"
+echo "3.0.1" > "$ROOT/module/razermouse/version"
+
+# Same keys the kernel sends in the uevents of the devices
+printf 'DRIVER=razerkbd\nHID_ID=0003:00001532:00000203\nHID_NAME=Razer BlackWidow Chroma\n' > "$keyboard/uevent"
+printf 'DRIVER=razermouse\nHID_ID=0003:00001532:00000073\nHID_NAME=Razer Mamba Wireless\n' > "$mouse/uevent"
+
+echo "Razer BlackWidow Chroma" > "$keyboard/device_type"
+echo "XX0000000001" > "$keyboard/device_serial"
+echo "v1.0" > "$keyboard/firmware_version"
+echo "01" > "$keyboard/kbd_layout"
+echo "255" > "$keyboard/matrix_brightness"
+for attribute in matrix_custom_frame matrix_effect_custom matrix_effect_none matrix_effect_static \
+        matrix_effect_breath matrix_effect_spectrum matrix_effect_wave matrix_effect_reactive \
+        logo_matrix_effect_static logo_matrix_effect_none; do
+    : > "$keyboard/$attribute"
+done
+
+echo "Razer Mamba Wireless" > "$mouse/device_type"
+echo "XX0000000002" > "$mouse/device_serial"
+echo "v1.0" > "$mouse/firmware_version"
+echo "800:800" > "$mouse/dpi"
+printf '\x01\x03\x20\x03\x20\x06\x40\x06\x40' > "$mouse/dpi_stages"
+echo "500" > "$mouse/poll_rate"
+echo "200" > "$mouse/charge_level"
+echo "0" > "$mouse/charge_status"
+echo "300" > "$mouse/device_idle_time"
+echo "38" > "$mouse/charge_low_threshold"
+echo "255" > "$mouse/scroll_led_brightness"
+echo "255" > "$mouse/logo_led_brightness"
+for attribute in scroll_matrix_effect_none scroll_matrix_effect_static scroll_matrix_effect_spectrum \
+        logo_matrix_effect_none logo_matrix_effect_static logo_matrix_effect_breath; do
+    : > "$mouse/$attribute"
+done
+
+echo "$ROOT"
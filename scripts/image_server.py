@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+#
+# Stand-in for the server hosting the device images, for trying out the
+# image cache without touching the real one.
+#
+# Serves the files of a directory with ETag and Last-Modified headers and
+# answers conditional requests with 304 if the file didn't change. Every
+# request gets logged with its response code, so a revalidation shows up as
+# a single 304 line.
+#
+# Usage: image_server.py <directory> [port]
+# Then point the image URL of a (fake) device to http://localhost:<port>/<file>
+
+import email.utils
+import hashlib
+import http.server
+import os
+import sys
+
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    def send_head(self):
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            self.send_error(404)
+            return None
+
+        with open(path, 'rb') as f:
+            data = f.read()
+        etag = '"%s"' % hashlib.sha1(data).hexdigest()
+        mtime = int(os.path.getmtime(path))
+        last_modified = email.utils.formatdate(mtime, usegmt=True)
+
+        not_modified = False
+        if 'If-None-Match' in self.headers:
+            not_modified = self.headers['If-None-Match'] == etag
+        elif 'If-Modified-Since' in self.headers:
+            since = email.utils.parsedate_to_datetime(self.headers['If-Modified-Since'])
+            not_modified = since is not None and mtime <= since.timestamp()
+
+        if not_modified:
+            self.send_response(304)
+            self.send_header('ETag', etag)
+            self.send_header('Last-Modified', last_modified)
+            self.end_headers()
+            return None
+
+        self.send_response(200)
+        self.send_header('Content-Type', self.guess_type(path))
+        self.send_header('Content-Length', str(len(data)))
+        self.send_header('ETag', etag)
+        self.send_header('Last-Modified', last_modified)
+        self.end_headers()
+        if self.command == 'GET':
+            self.wfile.write(data)
+        return None
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('Usage: %s <directory> [port]' % sys.argv[0])
+        sys.exit(1)
+    os.chdir(sys.argv[1])
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else 8000
+    http.server.ThreadingHTTPServer(('localhost', port), Handler).serve_forever()
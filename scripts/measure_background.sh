@@ -0,0 +1,70 @@
+#!/bin/bash -e
+#
+# Measures the memory usage and idle wakeups of 'razergenie --background'.
+#
+# Needs a running OpenRazer daemon, usually one using the fake driver from
+# the OpenRazer repository. Set MOCK_DAEMON to a command that starts it and
+# it'll be started and stopped around the measurement.
+#
+# Usage: measure_background.sh <path to razergenie>
+
+RAZERGENIE=${1:-./builddir/src/razergenie}
+# Seconds to wait for startup to settle before measuring
+SETTLE=${SETTLE:-10}
+# Seconds to count wakeups for
+DURATION=${DURATION:-60}
+# Targets
+MAX_RSS_KB=${MAX_RSS_KB:-40960}
+MAX_WAKEUPS_PER_MINUTE=${MAX_WAKEUPS_PER_MINUTE:-60}
+
+export QT_QPA_PLATFORM=${QT_QPA_PLATFORM:-offscreen}
+
+if [ -n "$MOCK_DAEMON" ]; then
+    echo "Starting mock daemon: $MOCK_DAEMON"
+    $MOCK_DAEMON &
+    daemon_pid=$!
+    sleep 5
+fi
+
+"$RAZERGENIE" --background &
+pid=$!
+
+cleanup() {
+    kill $pid 2>/dev/null || true
+    if [ -n "$daemon_pid" ]; then
+        kill $daemon_pid 2>/dev/null || true
+    fi
+}
+trap cleanup EXIT
+
+# Context switches of all threads, every one of them is a wakeup
+wakeups() {
+    cat /proc/$pid/task/*/status | awk '/^(voluntary|nonvoluntary)_ctxt_switches:/ { sum += $2 } END { print sum }'
+}
+
+sleep "$SETTLE"
+if ! kill -0 $pid 2>/dev/null; then
+    echo "razergenie exited during startup"
+    exit 1
+fi
+
+start=$(wakeups)
+sleep "$DURATION"
+end=$(wakeups)
+
+rss=$(awk '/^VmRSS:/ { print $2 }' /proc/$pid/status)
+wakeups_per_minute=$(( (end - start) * 60 / DURATION ))
+
+echo "RSS:     $rss kB (target: <= $MAX_RSS_KB kB)"
+echo "Wakeups: $wakeups_per_minute per minute (target: <= $MAX_WAKEUPS_PER_MINUTE)"
+
+failed=0
+if [ "$rss" -gt "$MAX_RSS_KB" ]; then
+    echo "RSS target missed"
+    failed=1
+fi
+if [ "$wakeups_per_minute" -gt "$MAX_WAKEUPS_PER_MINUTE" ]; then
+    echo "Wakeup target missed"
+    failed=1
+fi
+exit $failed
@@ -0,0 +1,401 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "backgroundservices.h"
+
+#include "battery/batterymonitor.h"
+#include "controlserver.h"
+#include "devicecommandqueue.h"
+#include "devicestate.h"
+#include "profiles/profileapplier.h"
+#include "profiles/profileswitcher.h"
+#include "razerimagedownloader.h"
+#include "sysfs/sysfsmanager.h"
+#include "util.h"
+
+#include <QDBusServiceWatcher>
+#include <QDebug>
+
+BackgroundServices::BackgroundServices(QObject *parent)
+    : QObject(parent)
+{
+    devicesChangedConnected = false;
+    imageDownloader = nullptr;
+
+    /* Migrate setting values */
+    if (settings.contains("noAutostartDaemon")) {
+        qInfo() << "Migrating setting key noAutostartDaemon...";
+        settings.setValue("askAutostartDaemon", !settings.value("noAutostartDaemon").toBool());
+        settings.remove("noAutostartDaemon");
+    }
+
+    manager = createManager(settings.value("backend").toString());
+
+    commandQueue = new DeviceCommandQueue(this);
+    // Nothing can set a direction on the LEDs anymore at that point
+    connect(commandQueue, &DeviceCommandQueue::deviceDeleted, this, &LedSettings::forgetDevice);
+
+    batteryMonitor = new BatteryMonitor(commandQueue, this);
+    connect(batteryMonitor, &BatteryMonitor::lowBattery, this, &BackgroundServices::lowBattery);
+
+    profileApplier = new ProfileApplier(commandQueue, this);
+
+    // Switch profiles while configured applications are running
+    profileSwitcher = new ProfileSwitcher(this);
+    connect(profileSwitcher, &ProfileSwitcher::switchProfile, this, [=](const QString &name) {
+        if (!applyProfile(name))
+            qWarning("Failed to load the profile %s", qUtf8Printable(name));
+    });
+
+    daemonRunning = manager->isDaemonRunning();
+    if (daemonRunning)
+        refreshDevices();
+
+    connectServiceWatcher();
+
+    // Lets other programs drive the devices through this instance
+    controlServer = new ControlServer(this, this);
+}
+
+BackgroundServices::~BackgroundServices()
+{
+    // Nothing may still be working on the devices when they get deleted
+    for (libopenrazer::Device *device : getDevices())
+        releaseDevice(device);
+    devicePaths.clear();
+    devices.clear();
+
+    // The managers have to outlive the calls still running on them
+    managerPool.waitForDone();
+    qDeleteAll(retiredManagers);
+    delete manager;
+}
+
+static QString readSerial(libopenrazer::Device *device)
+{
+    try {
+        return device->getSerial();
+    } catch (const libopenrazer::DBusException &e) {
+        qWarning("Failed to get serial of %s", qUtf8Printable(device->objectPath().path()));
+        return QString();
+    }
+}
+
+libopenrazer::Manager *BackgroundServices::createManager(const QString &backend)
+{
+    if (backend == "OpenRazer")
+        return new libopenrazer::openrazer::Manager();
+    if (backend == "razer_test")
+        return new libopenrazer::razer_test::Manager();
+    if (backend == "sysfs")
+        return new SysfsManager();
+
+    qWarning() << "Invalid backend value. Using openrazer backend.";
+    return new libopenrazer::openrazer::Manager();
+}
+
+libopenrazer::Manager *BackgroundServices::getManager() const
+{
+    return manager;
+}
+
+void BackgroundServices::switchBackend(const QString &backend)
+{
+    settings.setValue("backend", backend);
+
+    libopenrazer::Manager *oldManager = manager;
+    oldManager->getServiceWatcher()->disconnect(this);
+    manager = createManager(backend);
+    devicesChangedConnected = false;
+    connectServiceWatcher();
+
+    // One enumeration of the new backend. Devices it knows as well are
+    // handed over, so the window can keep their pages.
+    daemonRunning = manager->isDaemonRunning();
+    rematchDevices(false);
+
+    // Listeners of managerChanged can then tell whether asking the new
+    // manager anything makes sense
+    emit daemonRunningChanged(daemonRunning);
+    emit managerChanged(manager);
+
+    // Calls still running on the old manager delete it once they returned
+    if (managerCalls.value(oldManager) > 0)
+        retiredManagers.insert(oldManager);
+    else
+        delete oldManager;
+}
+
+bool BackgroundServices::isDaemonRunning() const
+{
+    return daemonRunning;
+}
+
+QList<libopenrazer::Device *> BackgroundServices::getDevices() const
+{
+    QList<libopenrazer::Device *> list;
+    for (const QDBusObjectPath &devicePath : devicePaths)
+        list.append(devices.value(devicePath));
+    return list;
+}
+
+QString BackgroundServices::getSerial(libopenrazer::Device *device) const
+{
+    return serials.value(device);
+}
+
+bool BackgroundServices::hasDeviceInfo(libopenrazer::Device *device) const
+{
+    return deviceInfos.contains(device);
+}
+
+QString BackgroundServices::getDeviceName(libopenrazer::Device *device) const
+{
+    if (!deviceInfos.contains(device))
+        return device->objectPath().path();
+    return deviceInfos.value(device).name;
+}
+
+QString BackgroundServices::getDeviceImageUrl(libopenrazer::Device *device) const
+{
+    return deviceInfos.value(device).imageUrl;
+}
+
+DeviceCommandQueue *BackgroundServices::getCommandQueue() const
+{
+    return commandQueue;
+}
+
+BatteryMonitor *BackgroundServices::getBatteryMonitor() const
+{
+    return batteryMonitor;
+}
+
+ProfileApplier *BackgroundServices::getProfileApplier() const
+{
+    return profileApplier;
+}
+
+ProfileSwitcher *BackgroundServices::getProfileSwitcher() const
+{
+    return profileSwitcher;
+}
+
+RazerImageDownloader *BackgroundServices::getImageDownloader()
+{
+    if (imageDownloader == nullptr)
+        imageDownloader = new RazerImageDownloader(this);
+    return imageDownloader;
+}
+
+bool BackgroundServices::applyProfile(const QString &name)
+{
+    Profile profile = Profile::load(name);
+    if (profile.isNull())
+        return false;
+
+    emit profileApplyStarted(name);
+    profileApplier->apply(profile, getDevices());
+    return true;
+}
+
+void BackgroundServices::devicesChanged()
+{
+    qInfo() << "DEVICE HAVE CHANGED!";
+    refreshDevices();
+}
+
+void BackgroundServices::refreshDevices()
+{
+    if (!devicesChangedConnected) {
+        manager->connectDevicesChanged(this, SLOT(devicesChanged()));
+        devicesChangedConnected = true;
+    }
+
+    QList<QDBusObjectPath> newDevicePaths = manager->getDevices();
+
+    for (const QDBusObjectPath &devicePath : QList<QDBusObjectPath>(devicePaths)) {
+        if (!newDevicePaths.contains(devicePath)) {
+            qDebug() << "Remove: " << devicePath.path();
+            removeDevice(devicePath);
+        }
+    }
+
+    for (const QDBusObjectPath &devicePath : newDevicePaths) {
+        if (devices.contains(devicePath))
+            continue;
+        qDebug() << "Add: " << devicePath.path();
+
+        libopenrazer::Device *device = addDevice(devicePath);
+        if (device != nullptr)
+            emit deviceAdded(device);
+    }
+}
+
+void BackgroundServices::rematchDevices(bool keepHandles)
+{
+    QList<libopenrazer::Device *> oldDevices = getDevices();
+    QHash<QDBusObjectPath, libopenrazer::Device *> oldDevicesByPath = devices;
+    QHash<QString, libopenrazer::Device *> oldDevicesBySerial;
+    for (libopenrazer::Device *device : oldDevices) {
+        QString serial = serials.value(device);
+        if (!serial.isEmpty())
+            oldDevicesBySerial.insert(serial, device);
+    }
+    devicePaths.clear();
+    devices.clear();
+
+    if (daemonRunning) {
+        if (!devicesChangedConnected) {
+            manager->connectDevicesChanged(this, SLOT(devicesChanged()));
+            devicesChangedConnected = true;
+        }
+
+        for (const QDBusObjectPath &devicePath : manager->getDevices()) {
+            // The handles talk to the daemon by its name, so they work again
+            // once it's back. Only the state of such a device has to be read again.
+            libopenrazer::Device *oldDevice = oldDevicesByPath.value(devicePath);
+            QString serial = serials.value(oldDevice);
+            if (keepHandles && oldDevice != nullptr && !serial.isEmpty() && readSerial(oldDevice) == serial) {
+                qDebug() << "Reconnect: " << devicePath.path();
+                devicePaths.append(devicePath);
+                devices.insert(devicePath, oldDevice);
+                oldDevicesBySerial.remove(serial);
+                oldDevices.removeOne(oldDevice);
+                batteryMonitor->refresh(oldDevice);
+                emit deviceReconnected(oldDevice);
+                continue;
+            }
+
+            libopenrazer::Device *device = addDevice(devicePath);
+            if (device == nullptr)
+                continue;
+
+            oldDevice = oldDevicesBySerial.take(serials.value(device));
+            if (oldDevice != nullptr) {
+                qDebug() << "Replace: " << devicePath.path();
+                emit deviceReplaced(oldDevice, device);
+                oldDevices.removeOne(oldDevice);
+                releaseDevice(oldDevice);
+            } else {
+                qDebug() << "Add: " << devicePath.path();
+                emit deviceAdded(device);
+            }
+        }
+    }
+
+    for (libopenrazer::Device *device : oldDevices) {
+        qDebug() << "Remove: " << device->objectPath().path();
+        emit deviceRemoved(device);
+        releaseDevice(device);
+    }
+}
+
+libopenrazer::Device *BackgroundServices::addDevice(const QDBusObjectPath &devicePath)
+{
+    libopenrazer::Device *device = manager->getDevice(devicePath);
+    if (device == nullptr)
+        return nullptr;
+
+    devicePaths.append(devicePath);
+    devices.insert(devicePath, device);
+    // Identifies the device across backends and daemon restarts
+    serials.insert(device, readSerial(device));
+    readDeviceInfo(device);
+    batteryMonitor->addDevice(device);
+    return device;
+}
+
+void BackgroundServices::readDeviceInfo(libopenrazer::Device *device)
+{
+    commandQueue->read<DeviceInfo>(
+            device, this, [=]() {
+                DeviceInfo info;
+                info.name = device->getDeviceName();
+                info.imageUrl = device->getDeviceImageUrl();
+                return info;
+            },
+            [=](const DeviceInfo &info) {
+                deviceInfos.insert(device, info);
+                emit deviceInfoRead(device);
+            },
+            [=](const QString & /* error */) {
+                // Also called when the device gets released
+                if (!serials.contains(device))
+                    return;
+                qWarning("Failed to get the name of %s", qUtf8Printable(device->objectPath().path()));
+                DeviceInfo info;
+                info.name = device->objectPath().path();
+                deviceInfos.insert(device, info);
+                emit deviceInfoRead(device);
+            });
+}
+
+void BackgroundServices::removeDevice(const QDBusObjectPath &devicePath)
+{
+    libopenrazer::Device *device = devices.value(devicePath);
+    if (device == nullptr)
+        return;
+
+    emit deviceRemoved(device);
+
+    devicePaths.removeOne(devicePath);
+    devices.remove(devicePath);
+    releaseDevice(device);
+}
+
+void BackgroundServices::releaseDevice(libopenrazer::Device *device)
+{
+    // The services go first, the queue fails callbacks that could otherwise
+    // queue new commands for the device.
+    profileApplier->removeDevice(device);
+    batteryMonitor->removeDevice(device);
+    serials.remove(device);
+    deviceInfos.remove(device);
+    // Deletes the device, once a command still running on it returned
+    commandQueue->removeDevice(device);
+}
+
+void BackgroundServices::managerCallFinished(libopenrazer::Manager *manager)
+{
+    if (--managerCalls[manager] > 0)
+        return;
+    managerCalls.remove(manager);
+    if (retiredManagers.remove(manager))
+        delete manager;
+}
+
+void BackgroundServices::connectServiceWatcher()
+{
+    // Watch for dbus service changes (= daemon ends or gets started)
+    QDBusServiceWatcher *watcher = manager->getServiceWatcher();
+    connect(watcher, &QDBusServiceWatcher::serviceRegistered,
+            this, &BackgroundServices::dbusServiceRegistered);
+    connect(watcher, &QDBusServiceWatcher::serviceUnregistered,
+            this, &BackgroundServices::dbusServiceUnregistered);
+}
+
+void BackgroundServices::dbusServiceRegistered(const QString &serviceName)
+{
+    qInfo() << "Registered! " << serviceName;
+    // Devices that are back get their handles and pages kept
+    daemonRunning = true;
+    rematchDevices(true);
+    emit daemonRunningChanged(true);
+}
+
+void BackgroundServices::dbusServiceUnregistered(const QString &serviceName)
+{
+    qInfo() << "Unregistered! " << serviceName;
+    // The devices stay around until the daemon is back, they get matched up
+    // with what it announces then
+    daemonRunning = false;
+    emit daemonRunningChanged(false);
+}
+
+void BackgroundServices::lowBattery(libopenrazer::Device *device, double percent)
+{
+    util::sendNotification(tr("Low battery"),
+                           tr("%1 is at %2% battery.").arg(getDeviceName(device)).arg(qRound(percent)));
+}
@@ -0,0 +1,173 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BACKGROUNDSERVICES_H
+#define BACKGROUNDSERVICES_H
+
+#include <QDBusObjectPath>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QSettings>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+#include <functional>
+#include <libopenrazer.h>
+#include <memory>
+
+class BatteryMonitor;
+class ControlServer;
+class DeviceCommandQueue;
+class ProfileApplier;
+class ProfileSwitcher;
+class RazerImageDownloader;
+
+/*
+ * Everything that keeps running without a window: the connection to the
+ * daemon, the list of devices and the services working on them.
+ *
+ * The main window only presents what's in here, so it can be created and
+ * destroyed at any time while RazerGenie runs in the background.
+ */
+class BackgroundServices : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BackgroundServices(QObject *parent = nullptr);
+    ~BackgroundServices() override;
+
+    libopenrazer::Manager *getManager() const;
+    /* Calls the manager off the UI thread. finished or failed is called on
+     * the UI thread unless context is gone by then. Results of a manager
+     * that got replaced in the meantime are dropped, the old manager is only
+     * deleted once its calls returned. */
+    template<typename T>
+    void callManager(QObject *context, std::function<T(libopenrazer::Manager *manager)> command,
+                     std::function<void(const T &)> finished, std::function<void()> failed = nullptr);
+    /* Creates the manager of the backend named in the settings */
+    static libopenrazer::Manager *createManager(const QString &backend);
+    /* Replaces the manager with one of the given backend. Devices with the
+     * same serial under both backends are reported with deviceReplaced(),
+     * the others are removed or added. */
+    void switchBackend(const QString &backend);
+    /* False while the daemon is gone, the devices are kept until it's back */
+    bool isDaemonRunning() const;
+    /* The connected devices, in the order the daemon reported them */
+    QList<libopenrazer::Device *> getDevices() const;
+    /* The serial read when the device was added, empty if that failed */
+    QString getSerial(libopenrazer::Device *device) const;
+    /* Name and image URL are read off the UI thread after the device was
+     * added, see deviceInfoRead(). Until then or if that failed, the name
+     * is the object path and the image URL is empty. */
+    bool hasDeviceInfo(libopenrazer::Device *device) const;
+    QString getDeviceName(libopenrazer::Device *device) const;
+    QString getDeviceImageUrl(libopenrazer::Device *device) const;
+
+    /* All calls to the devices go through this, see DeviceCommandQueue */
+    DeviceCommandQueue *getCommandQueue() const;
+    BatteryMonitor *getBatteryMonitor() const;
+    ProfileApplier *getProfileApplier() const;
+    ProfileSwitcher *getProfileSwitcher() const;
+    /* Created on first use, the background mode never downloads anything */
+    RazerImageDownloader *getImageDownloader();
+
+    /* Returns false if the profile couldn't be loaded */
+    bool applyProfile(const QString &name);
+
+signals:
+    void deviceAdded(libopenrazer::Device *device);
+    /* Emitted right before the device gets deleted */
+    void deviceRemoved(libopenrazer::Device *device);
+    /* The old device gets deleted right after this, newDevice takes its place */
+    void deviceReplaced(libopenrazer::Device *oldDevice, libopenrazer::Device *newDevice);
+    /* The device is back after a daemon restart, its settings might have changed */
+    void deviceReconnected(libopenrazer::Device *device);
+    /* Name and image URL of the device were read, or failed to be */
+    void deviceInfoRead(libopenrazer::Device *device);
+    /* On a backend switch this comes right before managerChanged */
+    void daemonRunningChanged(bool running);
+    /* Emitted before the previous manager gets deleted */
+    void managerChanged(libopenrazer::Manager *manager);
+    void profileApplyStarted(const QString &name);
+
+private slots:
+    void devicesChanged();
+
+private:
+    QSettings settings;
+
+    libopenrazer::Manager *manager;
+    /* Calls running per manager, and replaced managers waiting for theirs */
+    QHash<libopenrazer::Manager *, int> managerCalls;
+    QSet<libopenrazer::Manager *> retiredManagers;
+    QThreadPool managerPool;
+    QList<QDBusObjectPath> devicePaths;
+    QHash<QDBusObjectPath, libopenrazer::Device *> devices;
+    QHash<libopenrazer::Device *, QString> serials;
+    struct DeviceInfo {
+        QString name;
+        QString imageUrl;
+    };
+    QHash<libopenrazer::Device *, DeviceInfo> deviceInfos;
+    bool devicesChangedConnected;
+    bool daemonRunning;
+
+    DeviceCommandQueue *commandQueue;
+    BatteryMonitor *batteryMonitor;
+    ProfileApplier *profileApplier;
+    ProfileSwitcher *profileSwitcher;
+    RazerImageDownloader *imageDownloader;
+    ControlServer *controlServer;
+
+    void connectServiceWatcher();
+    void managerCallFinished(libopenrazer::Manager *manager);
+
+    void refreshDevices();
+    /* Enumerates all devices again and matches them up with the known ones
+     * by serial. keepHandles keeps the handles of devices at the same path. */
+    void rematchDevices(bool keepHandles);
+    libopenrazer::Device *addDevice(const QDBusObjectPath &devicePath);
+    void readDeviceInfo(libopenrazer::Device *device);
+    void removeDevice(const QDBusObjectPath &devicePath);
+    void releaseDevice(libopenrazer::Device *device);
+
+    void dbusServiceRegistered(const QString &serviceName);
+    void dbusServiceUnregistered(const QString &serviceName);
+    void lowBattery(libopenrazer::Device *device, double percent);
+};
+
+template<typename T>
+void BackgroundServices::callManager(QObject *context, std::function<T(libopenrazer::Manager *manager)> command,
+                                     std::function<void(const T &)> finished, std::function<void()> failed)
+{
+    // Filled in on the worker thread, read on the UI thread once the call is done
+    auto result = std::make_shared<T>();
+    auto success = std::make_shared<bool>(false);
+    QPointer<QObject> guard(context);
+    libopenrazer::Manager *manager = this->manager;
+    managerCalls[manager]++;
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [=]() {
+        watcher->deleteLater();
+        managerCallFinished(manager);
+        if (guard.isNull() || manager != this->manager)
+            return;
+        if (*success)
+            finished(*result);
+        else if (failed)
+            failed();
+    });
+    watcher->setFuture(QtConcurrent::run(&managerPool, [=]() {
+        try {
+            *result = command(manager);
+            *success = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Call to the daemon failed: %s", qUtf8Printable(e.message()));
+        }
+    }));
+}
+
+#endif // BACKGROUNDSERVICES_H
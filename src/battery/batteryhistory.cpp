@@ -0,0 +1,158 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "batteryhistory.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QUrl>
+#include <cstring>
+#include <sys/file.h>
+
+static const quint32 historyMagic = 0x52474248; // "RGBH"
+static const quint16 historyVersion = 1;
+
+BatteryHistory::BatteryHistory(const QString &filePath, quint32 capacity)
+    : file(filePath)
+{
+    this->capacity = capacity;
+    data = nullptr;
+
+    qint64 size = sizeof(Header) + qint64(sizeof(BatterySample)) * capacity;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    if (file.open(QIODevice::ReadWrite)) {
+        // Two instances writing the same ring buffer would corrupt it
+        if (flock(file.handle(), LOCK_EX | LOCK_NB) != 0) {
+            qWarning("BatteryHistory: %s is in use, keeping the history in memory", qUtf8Printable(filePath));
+            file.close();
+        } else {
+            bool fresh = file.size() != size;
+            if (fresh && !file.resize(size))
+                qWarning("BatteryHistory: Failed to resize %s", qUtf8Printable(filePath));
+            else
+                data = file.map(0, size);
+            if (data != nullptr && fresh)
+                initialize();
+        }
+    } else {
+        qWarning("BatteryHistory: Failed to open %s", qUtf8Printable(filePath));
+    }
+
+    if (data == nullptr) {
+        fallback.resize(size);
+        data = reinterpret_cast<uchar *>(fallback.data());
+        initialize();
+        return;
+    }
+
+    // Start over if the file was written by an incompatible version
+    Header *h = header();
+    if (h->magic != historyMagic || h->version != historyVersion || h->sampleSize != sizeof(BatterySample)
+        || h->capacity != capacity || h->head >= capacity || h->count > capacity)
+        initialize();
+}
+
+BatteryHistory::~BatteryHistory()
+{
+    if (data != nullptr && fallback.isEmpty())
+        file.unmap(data);
+}
+
+void BatteryHistory::initialize()
+{
+    memset(data, 0, sizeof(Header) + sizeof(BatterySample) * capacity);
+    Header *h = header();
+    h->magic = historyMagic;
+    h->version = historyVersion;
+    h->sampleSize = sizeof(BatterySample);
+    h->capacity = capacity;
+}
+
+BatteryHistory::Header *BatteryHistory::header() const
+{
+    return reinterpret_cast<Header *>(data);
+}
+
+BatterySample *BatteryHistory::samples() const
+{
+    return reinterpret_cast<BatterySample *>(data + sizeof(Header));
+}
+
+void BatteryHistory::append(const BatterySample &sample)
+{
+    Header *h = header();
+    samples()[h->head] = sample;
+    h->head = (h->head + 1) % capacity;
+    if (h->count < capacity)
+        h->count++;
+}
+
+int BatteryHistory::count() const
+{
+    return header()->count;
+}
+
+BatterySample BatteryHistory::at(int i) const
+{
+    Header *h = header();
+    return samples()[(h->head + capacity - h->count + i) % capacity];
+}
+
+BatterySample BatteryHistory::last() const
+{
+    return at(count() - 1);
+}
+
+BatteryEstimate BatteryHistory::estimate(quint32 maxAge) const
+{
+    BatteryEstimate estimate;
+    if (count() == 0)
+        return estimate;
+
+    BatterySample newest = last();
+    if (newest.charging)
+        return estimate;
+
+    // Least squares fit of the charge over time, in hours relative to the newest sample
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    int n = 0;
+    double span = 0;
+    for (int i = count() - 1; i >= 0; i--) {
+        BatterySample sample = at(i);
+        if (sample.charging || sample.time > newest.time || newest.time - sample.time > maxAge)
+            break;
+        double x = (double(sample.time) - double(newest.time)) / 3600.0;
+        double y = sample.percent();
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+        span = -x;
+        n++;
+    }
+
+    // Need some minutes worth of samples for anything meaningful
+    if (n < 3 || span < 10.0 / 60.0)
+        return estimate;
+
+    double denominator = n * sumXX - sumX * sumX;
+    if (denominator <= 0)
+        return estimate;
+    double slope = (n * sumXY - sumX * sumY) / denominator;
+    if (slope >= 0)
+        return estimate;
+
+    estimate.valid = true;
+    estimate.dischargeRate = -slope;
+    estimate.secondsRemaining = qint64(newest.percent() / estimate.dischargeRate * 3600.0);
+    return estimate;
+}
+
+QString BatteryHistory::getHistoryPath(const QString &serial)
+{
+    QString fileName = QString::fromUtf8(QUrl::toPercentEncoding(serial));
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/razergenie/battery/" + fileName + ".bin";
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BATTERYHISTORY_H
+#define BATTERYHISTORY_H
+
+#include <QFile>
+#include <QtGlobal>
+
+struct BatterySample {
+    /* Seconds since the epoch */
+    quint32 time;
+    /* Charge in hundredths of a percent */
+    quint16 charge;
+    quint8 charging;
+    quint8 reserved;
+
+    double percent() const { return charge / 100.0; }
+};
+
+struct BatteryEstimate {
+    bool valid = false;
+    /* Percent per hour, positive while discharging */
+    double dischargeRate = 0.0;
+    qint64 secondsRemaining = 0;
+};
+
+/*
+ * Fixed-size ring buffer of battery samples.
+ *
+ * The buffer is mapped from a file, so the history survives restarts without
+ * any explicit saving and appending a sample is a plain memory write. The
+ * file is locked while it's mapped. If it can't be mapped, e.g. because
+ * another instance of RazerGenie has it, the history is only kept in memory.
+ */
+class BatteryHistory
+{
+public:
+    /* About 34 hours of samples at the fastest poll interval of 30 seconds */
+    static const quint32 defaultCapacity = 4096;
+
+    explicit BatteryHistory(const QString &filePath, quint32 capacity = defaultCapacity);
+    ~BatteryHistory();
+
+    void append(const BatterySample &sample);
+    /* Number of stored samples */
+    int count() const;
+    /* Sample i, counted from the oldest one */
+    BatterySample at(int i) const;
+    /* The newest sample, count() has to be non-zero */
+    BatterySample last() const;
+
+    /* Estimates the discharge rate from the samples since the device was
+     * last unplugged, up to maxAge seconds back */
+    BatteryEstimate estimate(quint32 maxAge = 12 * 3600) const;
+
+    static QString getHistoryPath(const QString &serial);
+
+private:
+    struct Header {
+        quint32 magic;
+        quint16 version;
+        quint16 sampleSize;
+        quint32 capacity;
+        quint32 head;
+        quint32 count;
+    };
+
+    QFile file;
+    QByteArray fallback;
+    uchar *data;
+    quint32 capacity;
+
+    Header *header() const;
+    BatterySample *samples() const;
+    void initialize();
+
+    Q_DISABLE_COPY(BatteryHistory)
+};
+
+#endif // BATTERYHISTORY_H
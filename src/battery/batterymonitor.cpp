@@ -0,0 +1,205 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "batterymonitor.h"
+
+#include "devicecommandqueue.h"
+
+#include <QDateTime>
+#include <QTimer>
+
+/* Poll intervals in milliseconds */
+static const int chargingInterval = 2 * 60 * 1000;
+static const int nearThresholdInterval = 30 * 1000;
+static const int approachingThresholdInterval = 60 * 1000;
+static const int idleInterval = 5 * 60 * 1000;
+static const int maxIdleInterval = 15 * 60 * 1000;
+static const int retryInterval = 5 * 60 * 1000;
+
+BatteryMonitor::BatteryMonitor(DeviceCommandQueue *commandQueue, QObject *parent)
+    : QObject(parent)
+{
+    this->commandQueue = commandQueue;
+}
+
+BatteryMonitor::~BatteryMonitor()
+{
+    clear();
+}
+
+void BatteryMonitor::addDevice(libopenrazer::Device *device)
+{
+    if (entries.contains(device) || !device->hasFeature("battery"))
+        return;
+
+    auto *entry = new Entry;
+    entry->device = device;
+
+    entry->timer = new QTimer(this);
+    entry->timer->setSingleShot(true);
+    connect(entry->timer, &QTimer::timeout, this, [=]() {
+        sample(entry);
+    });
+
+    // Receives the readings, so readings of a removed device get dropped
+    entry->context = new QObject(this);
+
+    entries.insert(device, entry);
+    sample(entry);
+}
+
+void BatteryMonitor::removeDevice(libopenrazer::Device *device)
+{
+    Entry *entry = entries.take(device);
+    if (entry == nullptr)
+        return;
+
+    delete entry->context;
+    delete entry->timer;
+    delete entry->history;
+    delete entry;
+}
+
+void BatteryMonitor::clear()
+{
+    for (libopenrazer::Device *device : entries.keys())
+        removeDevice(device);
+}
+
+void BatteryMonitor::refresh(libopenrazer::Device *device)
+{
+    Entry *entry = entries.value(device);
+    if (entry == nullptr)
+        return;
+    entry->timer->stop();
+    sample(entry);
+}
+
+bool BatteryMonitor::isMonitored(libopenrazer::Device *device) const
+{
+    return entries.contains(device);
+}
+
+const BatteryHistory *BatteryMonitor::history(libopenrazer::Device *device) const
+{
+    Entry *entry = entries.value(device);
+    if (entry == nullptr)
+        return nullptr;
+    return entry->history;
+}
+
+BatteryEstimate BatteryMonitor::estimate(libopenrazer::Device *device) const
+{
+    const BatteryHistory *history = this->history(device);
+    if (history == nullptr)
+        return BatteryEstimate();
+    return history->estimate();
+}
+
+uchar BatteryMonitor::lowBatteryThreshold(libopenrazer::Device *device) const
+{
+    Entry *entry = entries.value(device);
+    if (entry == nullptr)
+        return defaultThreshold;
+    return entry->threshold;
+}
+
+void BatteryMonitor::sample(Entry *entry)
+{
+    if (entry->reading)
+        return;
+    entry->reading = true;
+
+    libopenrazer::Device *device = entry->device;
+    bool needSerial = entry->serial.isEmpty();
+    commandQueue->read<Reading>(
+            device, entry->context,
+            [=]() {
+                return BatteryMonitor::read(device, needSerial);
+            },
+            [=](const Reading &reading) {
+                sampleFinished(entry, reading);
+            },
+            [=](const QString & /* error */) {
+                // Timed out or rejected, try again later like any failed reading
+                sampleFinished(entry, Reading());
+            });
+}
+
+void BatteryMonitor::sampleFinished(Entry *entry, const Reading &reading)
+{
+    entry->reading = false;
+    if (!reading.ok) {
+        entry->timer->start(retryInterval);
+        return;
+    }
+
+    if (entry->history == nullptr) {
+        entry->serial = reading.serial;
+        entry->history = new BatteryHistory(BatteryHistory::getHistoryPath(entry->serial));
+    }
+    if (reading.hasThreshold)
+        entry->threshold = reading.threshold;
+
+    BatterySample sample;
+    sample.time = QDateTime::currentSecsSinceEpoch();
+    sample.charge = qBound(0, qRound(reading.percent * 100), 10000);
+    sample.charging = reading.charging;
+    sample.reserved = 0;
+
+    bool changed = entry->history->count() == 0
+            || entry->history->last().charge != sample.charge
+            || entry->history->last().charging != sample.charging;
+    entry->stableSamples = changed ? 0 : entry->stableSamples + 1;
+
+    entry->history->append(sample);
+    emit sampleAdded(entry->device);
+
+    // Notify once per crossing, with some hysteresis against readings jumping around the threshold
+    if (!reading.charging && reading.percent <= entry->threshold) {
+        if (!entry->belowThreshold) {
+            entry->belowThreshold = true;
+            emit lowBattery(entry->device, reading.percent);
+        }
+    } else if (reading.charging || reading.percent > entry->threshold + 2) {
+        entry->belowThreshold = false;
+    }
+
+    entry->timer->start(nextInterval(entry, sample));
+}
+
+int BatteryMonitor::nextInterval(Entry *entry, const BatterySample &sample) const
+{
+    if (sample.charging)
+        return chargingInterval;
+
+    double margin = sample.percent() - entry->threshold;
+    if (margin <= 5)
+        return nearThresholdInterval;
+    if (margin <= 15)
+        return approachingThresholdInterval;
+
+    // Back off while nothing changes
+    return qMin(idleInterval << qMin(entry->stableSamples, 2), maxIdleInterval);
+}
+
+BatteryMonitor::Reading BatteryMonitor::read(libopenrazer::Device *device, bool needSerial)
+{
+    Reading reading;
+    try {
+        if (needSerial)
+            reading.serial = device->getSerial();
+        reading.percent = device->getBatteryPercent();
+        reading.charging = device->isCharging();
+        if (device->hasFeature("low_battery_threshold")) {
+            reading.threshold = device->getLowBatteryThreshold();
+            reading.hasThreshold = true;
+        }
+        reading.ok = true;
+    } catch (const libopenrazer::DBusException &e) {
+        // Asking for the name would only fail the same way
+        qWarning("BatteryMonitor: Failed to read battery of %s: %s", qUtf8Printable(device->objectPath().path()), qUtf8Printable(e.message()));
+    }
+    return reading;
+}
@@ -0,0 +1,86 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BATTERYMONITOR_H
+#define BATTERYMONITOR_H
+
+#include "batteryhistory.h"
+
+#include <QHash>
+#include <QObject>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+class QTimer;
+
+/*
+ * Samples the battery of all wireless devices in the background.
+ *
+ * The poll interval adapts to the battery: a full battery that isn't
+ * changing is only checked every few minutes, while a battery close to the
+ * low battery threshold is checked often. Samples go into a BatteryHistory
+ * per device, which is what the UI reads from, so showing the battery never
+ * costs a D-Bus call.
+ */
+class BatteryMonitor : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatteryMonitor(DeviceCommandQueue *commandQueue, QObject *parent = nullptr);
+    ~BatteryMonitor() override;
+
+    /* Starts monitoring the device if it has a battery */
+    void addDevice(libopenrazer::Device *device);
+    /* Has to be called before the device gets deleted */
+    void removeDevice(libopenrazer::Device *device);
+    void clear();
+    /* Samples the device right away instead of waiting for its next poll,
+     * e.g. after the daemon came back */
+    void refresh(libopenrazer::Device *device);
+
+    bool isMonitored(libopenrazer::Device *device) const;
+    /* The history of the device, or nullptr if it's not monitored or not sampled yet */
+    const BatteryHistory *history(libopenrazer::Device *device) const;
+    BatteryEstimate estimate(libopenrazer::Device *device) const;
+    uchar lowBatteryThreshold(libopenrazer::Device *device) const;
+
+signals:
+    void sampleAdded(libopenrazer::Device *device);
+    /* Emitted once whenever the charge drops below the low battery threshold */
+    void lowBattery(libopenrazer::Device *device, double percent);
+
+private:
+    struct Reading {
+        bool ok = false;
+        QString serial;
+        double percent = 0.0;
+        bool charging = false;
+        bool hasThreshold = false;
+        uchar threshold = 0;
+    };
+
+    struct Entry {
+        libopenrazer::Device *device;
+        QString serial;
+        BatteryHistory *history = nullptr;
+        QTimer *timer = nullptr;
+        QObject *context = nullptr;
+        bool reading = false;
+        uchar threshold = defaultThreshold;
+        bool belowThreshold = false;
+        int stableSamples = 0;
+    };
+
+    static const uchar defaultThreshold = 10;
+
+    DeviceCommandQueue *commandQueue;
+    QHash<libopenrazer::Device *, Entry *> entries;
+
+    void sample(Entry *entry);
+    void sampleFinished(Entry *entry, const Reading &reading);
+    int nextInterval(Entry *entry, const BatterySample &sample) const;
+    static Reading read(libopenrazer::Device *device, bool needSerial);
+};
+
+#endif // BATTERYMONITOR_H
@@ -0,0 +1,527 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "commandline.h"
+
+#include "backgroundservices.h"
+#include "devicecommandqueue.h"
+#include "framestreamer.h"
+#include "profiles/profileapplier.h"
+#include "reactive/evdevreader.h"
+#include "reactive/keymap.h"
+#include "reactive/reactivelighting.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QSocketNotifier>
+#include <QTextStream>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <csignal>
+#include <memory>
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+static QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+static QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+CommandLine::CommandLine(QObject *parent)
+    : QObject(parent)
+{
+    manager = nullptr;
+    signalFd = -1;
+    commandQueue = new DeviceCommandQueue(this);
+}
+
+CommandLine::~CommandLine()
+{
+    // The queue deletes the devices
+    for (libopenrazer::Device *device : devices)
+        commandQueue->removeDevice(device);
+    delete manager;
+    if (signalFd != -1)
+        close(signalFd);
+}
+
+bool CommandLine::isCommand(int argc, char *argv[])
+{
+    if (argc < 2)
+        return false;
+    if (strcmp(argv[1], "list") == 0 || strcmp(argv[1], "apply") == 0 || strcmp(argv[1], "set") == 0)
+        return true;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--stream-frames") == 0 || strncmp(argv[i], "--stream-frames=", 16) == 0
+            || strcmp(argv[i], "--reactive") == 0 || strncmp(argv[i], "--reactive=", 11) == 0)
+            return true;
+    }
+    return false;
+}
+
+int CommandLine::exec(const QStringList &arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Changes the settings of Razer devices without opening a window."));
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", tr("One of list, apply or set."));
+
+    QCommandLineOption jsonOption("json", tr("list: Print the devices as JSON."));
+    QCommandLineOption profileOption("profile", tr("apply: The profile to apply."), tr("name"));
+    QCommandLineOption deviceOption("device", tr("set: The serial of the device to change."), tr("serial"));
+    QCommandLineOption brightnessOption("brightness", tr("set: The brightness of all LEDs, from 0 to 100."), tr("percent"));
+    QCommandLineOption dpiOption("dpi", tr("set: The DPI for both axes."), tr("dpi"));
+    QCommandLineOption streamFramesOption("stream-frames", tr("Show raw RGB frames read from stdin on the device with the given serial, rows x columns x 3 bytes each."), tr("serial"));
+    QCommandLineOption reactiveOption("reactive", tr("Light up the keys of the keyboard with the given serial when they're pressed, until interrupted."), tr("serial"));
+    QCommandLineOption inputOption("input", tr("stream-frames: Read the frames from this file or FIFO instead. reactive: Read key presses from this evdev node, can be given multiple times."), tr("path"));
+    QCommandLineOption colorOption("color", tr("reactive: The color of pressed keys, default 00ff00."), tr("rrggbb"));
+    QCommandLineOption fadeOption("fade", tr("reactive: How long keys take to fade out, default 500."), tr("ms"));
+    QCommandLineOption replayOption("replay", tr("reactive: Replay key presses from a log instead of reading them from the keyboard."), tr("file"));
+    QCommandLineOption recordOption("record", tr("reactive: Write the events read from the keyboard to a log for --replay."), tr("file"));
+    parser.addOptions({ jsonOption, profileOption, deviceOption, brightnessOption, dpiOption, streamFramesOption,
+                        reactiveOption, inputOption, colorOption, fadeOption, replayOption, recordOption });
+    parser.process(arguments);
+
+    QString command = parser.positionalArguments().value(0);
+
+    // Checked before talking to the daemon, mistakes should fail fast
+    int brightness = -1;
+    int dpi = -1;
+    if (command == "apply" && !parser.isSet(profileOption)) {
+        err() << tr("apply needs --profile.") << Qt::endl;
+        return 2;
+    }
+    if (command == "set") {
+        if (!parser.isSet(deviceOption)) {
+            err() << tr("set needs --device.") << Qt::endl;
+            return 2;
+        }
+        if (!parser.isSet(brightnessOption) && !parser.isSet(dpiOption)) {
+            err() << tr("set needs --brightness or --dpi.") << Qt::endl;
+            return 2;
+        }
+        bool ok = true;
+        if (parser.isSet(brightnessOption)) {
+            brightness = parser.value(brightnessOption).toInt(&ok);
+            if (!ok || brightness < 0 || brightness > 100) {
+                err() << tr("The brightness has to be a number from 0 to 100.") << Qt::endl;
+                return 2;
+            }
+        }
+        if (parser.isSet(dpiOption)) {
+            dpi = parser.value(dpiOption).toInt(&ok);
+            if (!ok || dpi <= 0 || dpi > 65535) {
+                err() << tr("The DPI has to be a positive number.") << Qt::endl;
+                return 2;
+            }
+        }
+    }
+
+    openrazer::RGB color = { 0, 255, 0 };
+    int fade = 500;
+    if (parser.isSet(reactiveOption)) {
+        QByteArray rgb = QByteArray::fromHex(parser.value(colorOption).toLatin1());
+        if (parser.isSet(colorOption) && (rgb.size() != 3 || parser.value(colorOption).size() != 6)) {
+            err() << tr("The color has to be given as rrggbb.") << Qt::endl;
+            return 2;
+        }
+        if (rgb.size() == 3)
+            color = { static_cast<uchar>(rgb.at(0)), static_cast<uchar>(rgb.at(1)), static_cast<uchar>(rgb.at(2)) };
+        bool ok = true;
+        if (parser.isSet(fadeOption))
+            fade = parser.value(fadeOption).toInt(&ok);
+        if (!ok || fade <= 0) {
+            err() << tr("The fade duration has to be a positive number.") << Qt::endl;
+            return 2;
+        }
+
+        // Has to happen before any thread gets started, they'd get the signals otherwise
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+        signalFd = signalfd(-1, &signals, SFD_CLOEXEC | SFD_NONBLOCK);
+        if (signalFd == -1) {
+            // Ctrl+C has to keep working, just without the cleanup
+            qWarning("Failed to create a signalfd: %s", strerror(errno));
+            pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+        }
+    }
+
+    QSettings settings;
+    manager = BackgroundServices::createManager(settings.value("backend").toString());
+    if (!manager->isDaemonRunning()) {
+        err() << tr("The daemon is not running.") << Qt::endl;
+        return 1;
+    }
+
+    try {
+        for (const QDBusObjectPath &devicePath : manager->getDevices()) {
+            libopenrazer::Device *device = manager->getDevice(devicePath);
+            if (device != nullptr)
+                devices.append(device);
+        }
+    } catch (const libopenrazer::DBusException &e) {
+        err() << tr("Failed to get the devices: %1").arg(e.message()) << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet(streamFramesOption))
+        return streamFrames(parser.value(streamFramesOption), parser.value(inputOption));
+    if (parser.isSet(reactiveOption))
+        return reactive(parser.value(reactiveOption), parser.values(inputOption), parser.value(replayOption), parser.value(recordOption), color, fade);
+    if (command == "list")
+        return list(parser.isSet(jsonOption));
+    if (command == "apply")
+        return apply(parser.value(profileOption));
+    if (command == "set")
+        return set(parser.value(deviceOption), brightness, dpi);
+    return 2;
+}
+
+int CommandLine::list(bool json)
+{
+    QVector<DeviceInfo> infos = readDeviceInfos();
+
+    if (json) {
+        QJsonArray array;
+        for (const DeviceInfo &info : qAsConst(infos)) {
+            array.append(QJsonObject {
+                    { "serial", info.serial },
+                    { "name", info.name },
+                    { "type", info.type },
+            });
+        }
+        out() << QJsonDocument(array).toJson(QJsonDocument::Compact) << Qt::endl;
+    } else {
+        for (const DeviceInfo &info : qAsConst(infos))
+            out() << info.serial << '\t' << info.name << Qt::endl;
+    }
+    return 0;
+}
+
+int CommandLine::apply(const QString &profileName)
+{
+    Profile profile = Profile::load(profileName);
+    if (profile.isNull()) {
+        err() << tr("Failed to load the profile \"%1\".").arg(profileName) << Qt::endl;
+        return 1;
+    }
+
+    int remaining = 1;
+    int exitCode = 0;
+    ProfileApplier applier(commandQueue);
+    connect(&applier, &ProfileApplier::finished, this, [&](const QString & /* profileName */, const QVector<ProfileApplyResult> &results) {
+        for (const ProfileApplyResult &result : results) {
+            for (const QString &error : result.errors) {
+                err() << result.deviceName << ": " << error << Qt::endl;
+                exitCode = 1;
+            }
+        }
+        remaining--;
+        loop.quit();
+    });
+    applier.apply(profile, devices);
+    wait(remaining);
+    return exitCode;
+}
+
+int CommandLine::set(const QString &serial, int brightness, int dpi)
+{
+    libopenrazer::Device *device = findDevice(serial);
+    if (device == nullptr) {
+        err() << tr("No device with the serial %1 found.").arg(serial) << Qt::endl;
+        return 1;
+    }
+
+    int remaining = 0;
+    int exitCode = 0;
+    auto write = [&](const QString &what, std::function<void()> command) {
+        remaining++;
+        commandQueue->write(device, this, command, [=, &remaining, &exitCode](bool success) {
+            if (!success) {
+                err() << tr("Failed to set %1.").arg(what) << Qt::endl;
+                exitCode = 1;
+            }
+            remaining--;
+            loop.quit();
+        });
+    };
+
+    if (brightness != -1) {
+        // The LEDs take 0-255 like the slider in the window
+        uchar value = static_cast<uchar>(qRound(brightness * 255 / 100.0));
+        bool hasBrightness = false;
+        for (libopenrazer::Led *led : device->getLeds()) {
+            if (!led->hasBrightness())
+                continue;
+            hasBrightness = true;
+            write(tr("brightness"), [=]() {
+                led->setBrightness(value);
+            });
+        }
+        if (!hasBrightness) {
+            err() << tr("The device doesn't support changing the brightness.") << Qt::endl;
+            exitCode = 1;
+        }
+    }
+
+    if (dpi != -1) {
+        if (device->hasFeature("dpi")) {
+            write(tr("DPI"), [=]() {
+                device->setDPI({ static_cast<ushort>(dpi), static_cast<ushort>(dpi) });
+            });
+        } else {
+            err() << tr("The device doesn't support changing the DPI.") << Qt::endl;
+            exitCode = 1;
+        }
+    }
+
+    wait(remaining);
+    return exitCode;
+}
+
+int CommandLine::streamFrames(const QString &serial, const QString &inputPath)
+{
+    libopenrazer::Device *device = findDevice(serial);
+    if (device == nullptr) {
+        err() << tr("No device with the serial %1 found.").arg(serial) << Qt::endl;
+        return 1;
+    }
+    if (!device->hasFeature("custom_frame")) {
+        err() << tr("The device doesn't support custom frames.") << Qt::endl;
+        return 1;
+    }
+
+    openrazer::MatrixDimensions dimensions = readMatrixDimensions(device);
+    if (dimensions.x == 0 || dimensions.y == 0)
+        return 1;
+
+    int fd = STDIN_FILENO;
+    if (!inputPath.isEmpty()) {
+        // Blocks until a writer opened the FIFO
+        fd = open(QFile::encodeName(inputPath).constData(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            err() << tr("Failed to open %1: %2").arg(inputPath, QString::fromLocal8Bit(strerror(errno))) << Qt::endl;
+            return 1;
+        }
+    }
+    err() << tr("Waiting for frames of %1 x %2 keys (%3 bytes)...").arg(dimensions.x).arg(dimensions.y).arg(dimensions.x * dimensions.y * 3) << Qt::endl;
+
+    FrameStreamer streamer(commandQueue, device, dimensions, fd);
+    int remaining = 1;
+    connect(&streamer, &FrameStreamer::finished, this, [&]() {
+        remaining--;
+        loop.quit();
+    });
+    wait(remaining);
+
+    if (fd != STDIN_FILENO)
+        close(fd);
+    err() << tr("%1 frames received, %2 sent, %3 dropped.").arg(streamer.receivedFrames()).arg(streamer.sentFrames()).arg(streamer.droppedFrames()) << Qt::endl;
+    return 0;
+}
+
+int CommandLine::reactive(const QString &serial, const QStringList &inputPaths, const QString &replayPath, const QString &recordPath, const openrazer::RGB &color, int fade)
+{
+    libopenrazer::Device *device = findDevice(serial);
+    if (device == nullptr) {
+        err() << tr("No device with the serial %1 found.").arg(serial) << Qt::endl;
+        return 1;
+    }
+    if (!device->hasFeature("custom_frame")) {
+        err() << tr("The device doesn't support custom frames.") << Qt::endl;
+        return 1;
+    }
+
+    openrazer::MatrixDimensions dimensions = readMatrixDimensions(device);
+    if (dimensions.x == 0 || dimensions.y == 0)
+        return 1;
+    KeyMap keyMap = KeyMap::forKeyboard(dimensions.x, dimensions.y, readKeyboardLayout(device));
+    if (keyMap.isEmpty()) {
+        err() << tr("No key layout known for a matrix of %1 x %2 keys.").arg(dimensions.x).arg(dimensions.y) << Qt::endl;
+        return 1;
+    }
+
+    EvdevReader reader;
+    if (!replayPath.isEmpty()) {
+        if (!reader.replay(replayPath))
+            return 1;
+    } else {
+        QStringList nodes = inputPaths.isEmpty() ? EvdevReader::razerKeyboardNodes() : inputPaths;
+        if (nodes.isEmpty()) {
+            err() << tr("No Razer keyboard found in /dev/input/by-id/, use --input to name the evdev node.") << Qt::endl;
+            return 1;
+        }
+        if (!reader.open(nodes)) {
+            err() << tr("Failed to read key presses, reading evdev nodes usually needs membership in the input group.") << Qt::endl;
+            return 1;
+        }
+    }
+    if (!recordPath.isEmpty() && !reader.record(recordPath))
+        return 1;
+
+    ReactiveLighting lighting(commandQueue, device, dimensions, keyMap);
+    lighting.setColor(color);
+    lighting.setFadeDuration(fade);
+    connect(&reader, &EvdevReader::keyPressed, &lighting, &ReactiveLighting::keyPressed);
+    lighting.start();
+
+    // Runs until interrupted, or until a replayed log is over and the keys
+    // went dark. An interrupt sends a dark frame before quitting.
+    int remaining = 1;
+    bool replayFinished = false;
+    bool interrupted = false;
+    auto stop = [&]() {
+        if (remaining > 0) {
+            remaining--;
+            loop.quit();
+        }
+    };
+    connect(&reader, &EvdevReader::finished, this, [&]() {
+        replayFinished = true;
+        if (!lighting.isActive())
+            stop();
+    });
+    connect(&lighting, &ReactiveLighting::idle, this, [&]() {
+        if (replayFinished || interrupted)
+            stop();
+    });
+    if (signalFd != -1) {
+        auto *signalNotifier = new QSocketNotifier(signalFd, QSocketNotifier::Read, &reader);
+        connect(signalNotifier, &QSocketNotifier::activated, this, [&]() {
+            signalfd_siginfo info;
+            while (read(signalFd, &info, sizeof(info)) > 0) {
+            }
+            // A second Ctrl+C doesn't wait for the dark frame
+            if (interrupted) {
+                stop();
+                return;
+            }
+            interrupted = true;
+            reader.disconnect(&lighting);
+            lighting.stop();
+        });
+    }
+    err() << tr("Lighting up pressed keys, stop with Ctrl+C.") << Qt::endl;
+    wait(remaining);
+
+    err() << tr("%1 frames sent, %2 key presses measured, %3 not on the matrix.").arg(lighting.sentFrames()).arg(lighting.latencySamples()).arg(lighting.unmappedKeys()) << Qt::endl;
+    if (lighting.latencySamples() > 0) {
+        err() << tr("Key press to light: %1 ms on average, %2 ms at most, %3 presses took longer than a frame.")
+                         .arg(lighting.averageLatency() / 1000.0, 0, 'f', 1)
+                         .arg(lighting.maxLatency() / 1000.0, 0, 'f', 1)
+                         .arg(lighting.lateSamples())
+              << Qt::endl;
+    }
+    return 0;
+}
+
+openrazer::MatrixDimensions CommandLine::readMatrixDimensions(libopenrazer::Device *device)
+{
+    int remaining = 1;
+    openrazer::MatrixDimensions dimensions = { 0, 0 };
+    commandQueue->read<openrazer::MatrixDimensions>(
+            device, this,
+            [=]() {
+                return device->getMatrixDimensions();
+            },
+            [&](const openrazer::MatrixDimensions &result) {
+                dimensions = result;
+                remaining--;
+                loop.quit();
+            },
+            [&](const QString &error) {
+                err() << tr("Failed to get the matrix dimensions: %1").arg(error) << Qt::endl;
+                remaining--;
+                loop.quit();
+            });
+    wait(remaining);
+    return dimensions;
+}
+
+QString CommandLine::readKeyboardLayout(libopenrazer::Device *device)
+{
+    int remaining = 1;
+    QString layout;
+    commandQueue->read<QString>(
+            device, this,
+            [=]() {
+                return device->getKeyboardLayout();
+            },
+            [&](const QString &result) {
+                layout = result;
+                remaining--;
+                loop.quit();
+            },
+            [&](const QString & /* error */) {
+                remaining--;
+                loop.quit();
+            });
+    wait(remaining);
+    return layout;
+}
+
+QVector<CommandLine::DeviceInfo> CommandLine::readDeviceInfos()
+{
+    QVector<DeviceInfo> infos(devices.size());
+    int remaining = devices.size();
+
+    for (int i = 0; i < devices.size(); i++) {
+        libopenrazer::Device *device = devices.at(i);
+        commandQueue->read<DeviceInfo>(
+                device, this,
+                [=]() {
+                    DeviceInfo info;
+                    info.serial = device->getSerial();
+                    info.name = device->getDeviceName();
+                    info.type = device->getDeviceType();
+                    return info;
+                },
+                [&, i](const DeviceInfo &info) {
+                    infos[i] = info;
+                    remaining--;
+                    loop.quit();
+                },
+                [&, device](const QString &error) {
+                    err() << tr("Failed to read %1: %2").arg(device->objectPath().path(), error) << Qt::endl;
+                    remaining--;
+                    loop.quit();
+                });
+    }
+
+    wait(remaining);
+    return infos;
+}
+
+void CommandLine::wait(const int &remaining)
+{
+    // The results are delivered through the event loop
+    while (remaining > 0)
+        loop.exec();
+}
+
+libopenrazer::Device *CommandLine::findDevice(const QString &serial)
+{
+    QVector<DeviceInfo> infos = readDeviceInfos();
+    for (int i = 0; i < infos.size(); i++) {
+        if (infos.at(i).serial == serial)
+            return devices.at(i);
+    }
+    return nullptr;
+}
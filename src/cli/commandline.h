@@ -0,0 +1,70 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COMMANDLINE_H
+#define COMMANDLINE_H
+
+#include <QEventLoop>
+#include <QObject>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+
+/*
+ * The subcommands of razergenie that run without a window, e.g. from login
+ * scripts or keybindings:
+ *
+ *   razergenie list [--json]
+ *   razergenie apply --profile <name>
+ *   razergenie set --device <serial> [--brightness <0-100>] [--dpi <dpi>]
+ *   razergenie --stream-frames <serial> [--input <fifo>]
+ *   razergenie --reactive <serial> [--input <evdev node>] [--replay <log>] [--record <log>]
+ *
+ * Only a QCoreApplication is needed, no widgets, images or translations get
+ * loaded. The devices are talked to through a DeviceCommandQueue, so they
+ * are handled in parallel and a hanging device times out.
+ */
+class CommandLine : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CommandLine(QObject *parent = nullptr);
+    ~CommandLine() override;
+
+    /* Returns true if the arguments select one of the subcommands */
+    static bool isCommand(int argc, char *argv[]);
+
+    /* Runs the subcommand and returns the exit code */
+    int exec(const QStringList &arguments);
+
+private:
+    struct DeviceInfo {
+        QString serial;
+        QString name;
+        QString type;
+    };
+
+    libopenrazer::Manager *manager;
+    DeviceCommandQueue *commandQueue;
+    QList<libopenrazer::Device *> devices;
+    QEventLoop loop;
+    /* SIGINT and SIGTERM while --reactive runs */
+    int signalFd;
+
+    int list(bool json);
+    int apply(const QString &profileName);
+    int set(const QString &serial, int brightness, int dpi);
+    int streamFrames(const QString &serial, const QString &inputPath);
+    int reactive(const QString &serial, const QStringList &inputPaths, const QString &replayPath, const QString &recordPath, const openrazer::RGB &color, int fade);
+
+    QVector<DeviceInfo> readDeviceInfos();
+    libopenrazer::Device *findDevice(const QString &serial);
+    /* Both are 0 if they couldn't be read */
+    openrazer::MatrixDimensions readMatrixDimensions(libopenrazer::Device *device);
+    /* Empty if the device doesn't report one */
+    QString readKeyboardLayout(libopenrazer::Device *device);
+    void wait(const int &remaining);
+};
+
+#endif // COMMANDLINE_H
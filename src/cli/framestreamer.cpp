@@ -0,0 +1,139 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "framestreamer.h"
+
+#include "devicecommandqueue.h"
+
+#include <QSocketNotifier>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+FrameStreamer::FrameStreamer(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, openrazer::MatrixDimensions dimensions, int fd, QObject *parent)
+    : QObject(parent)
+{
+    this->commandQueue = commandQueue;
+    this->device = device;
+    this->dimensions = dimensions;
+    this->fd = fd;
+
+    int frameSize = dimensions.x * dimensions.y * 3;
+    receiving.resize(frameSize);
+    ready.resize(frameSize);
+    receivedBytes = 0;
+    hasReady = false;
+    sending = false;
+    inputEnded = false;
+    received = 0;
+    sent = 0;
+    dropped = 0;
+
+    // Reads must never block, frames are picked up whenever they come in.
+    // stdin is shared with the shell, so its flags are restored afterwards.
+    fdFlags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, fdFlags | O_NONBLOCK);
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &FrameStreamer::readInput);
+}
+
+FrameStreamer::~FrameStreamer()
+{
+    if (fdFlags != -1)
+        fcntl(fd, F_SETFL, fdFlags);
+}
+
+int FrameStreamer::receivedFrames() const
+{
+    return received;
+}
+
+int FrameStreamer::sentFrames() const
+{
+    return sent;
+}
+
+int FrameStreamer::droppedFrames() const
+{
+    return dropped;
+}
+
+void FrameStreamer::readInput()
+{
+    while (true) {
+        ssize_t count = read(fd, receiving.data() + receivedBytes, receiving.size() - receivedBytes);
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            qWarning("FrameStreamer: Failed to read the input: %s", strerror(errno));
+            count = 0;
+        }
+        if (count == 0) {
+            // A partial frame at the end is ignored
+            inputEnded = true;
+            notifier->setEnabled(false);
+            break;
+        }
+
+        receivedBytes += count;
+        if (receivedBytes < receiving.size())
+            continue;
+
+        // Swap the buffers, a frame that wasn't sent yet is stale now
+        received++;
+        if (hasReady)
+            dropped++;
+        std::swap(receiving, ready);
+        hasReady = true;
+        receivedBytes = 0;
+    }
+
+    if (!sending)
+        sendReady();
+    checkFinished();
+}
+
+void FrameStreamer::sendReady()
+{
+    if (!hasReady)
+        return;
+
+    // Converted here, the buffer gets reused for the next frames right away
+    int rows = dimensions.x;
+    int columns = dimensions.y;
+    QVector<openrazer::RGB> colors(rows * columns);
+    const uchar *data = reinterpret_cast<const uchar *>(ready.constData());
+    for (int i = 0; i < colors.size(); i++)
+        colors[i] = openrazer::RGB { data[i * 3], data[i * 3 + 1], data[i * 3 + 2] };
+    hasReady = false;
+    sending = true;
+
+    libopenrazer::Device *device = this->device;
+    commandQueue->write(
+            device, this,
+            [=]() {
+                for (int row = 0; row < rows; row++)
+                    device->defineCustomFrame(row, 0, columns - 1, colors.mid(row * columns, columns));
+                device->displayCustomFrame();
+            },
+            [=](bool success) {
+                sending = false;
+                if (success)
+                    sent++;
+                else
+                    dropped++;
+                sendReady();
+                checkFinished();
+            });
+}
+
+void FrameStreamer::checkFinished()
+{
+    if (inputEnded && !sending && !hasReady)
+        emit finished();
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FRAMESTREAMER_H
+#define FRAMESTREAMER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+class QSocketNotifier;
+
+/*
+ * Reads raw frames from a file descriptor (stdin or a FIFO) and shows them
+ * on the custom frame of a device. A frame is rows x columns x 3 bytes of
+ * RGB, row by row.
+ *
+ * Frames are read into one buffer while the latest complete frame waits in
+ * the other one. A new frame is only sent once the device took the previous
+ * one, a frame that got replaced in the meantime is dropped. The device
+ * therefore gets frames as fast as it takes them, and the one it gets next
+ * is never older than one frame.
+ */
+class FrameStreamer : public QObject
+{
+    Q_OBJECT
+public:
+    FrameStreamer(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, openrazer::MatrixDimensions dimensions, int fd, QObject *parent = nullptr);
+    ~FrameStreamer() override;
+
+    int receivedFrames() const;
+    int sentFrames() const;
+    int droppedFrames() const;
+
+signals:
+    /* The input ended and the last frame was sent */
+    void finished();
+
+private:
+    DeviceCommandQueue *commandQueue;
+    libopenrazer::Device *device;
+    openrazer::MatrixDimensions dimensions;
+    int fd;
+    /* The flags of fd before it was made non-blocking */
+    int fdFlags;
+    QSocketNotifier *notifier;
+
+    /* Being filled from the input */
+    QByteArray receiving;
+    int receivedBytes;
+    /* The latest complete frame, hasReady is false once it got sent */
+    QByteArray ready;
+    bool hasReady;
+
+    bool sending;
+    bool inputEnded;
+    int received;
+    int sent;
+    int dropped;
+
+    void readInput();
+    void sendReady();
+    void checkFinished();
+};
+
+#endif // FRAMESTREAMER_H
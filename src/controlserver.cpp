@@ -0,0 +1,368 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "controlserver.h"
+
+#include "backgroundservices.h"
+#include "devicecommandqueue.h"
+#include "devicestate.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMutex>
+#include <QPointer>
+#include <QStandardPaths>
+
+/* Larger messages get the connection closed, a full keyboard frame is < 1 KiB */
+static const quint32 maxMessageSize = 16 * 1024 * 1024;
+
+enum Opcode {
+    SetEffect = 1,
+    SetBrightness = 2,
+    PushFrame = 3,
+    ApplyProfile = 4,
+};
+
+static const quint8 allLeds = 255;
+
+struct ControlServer::PendingFrame {
+    QMutex mutex;
+    /* Set once the command queue started sending the frame */
+    bool taken = false;
+    quint8 rows = 0;
+    quint8 columns = 0;
+    QVector<openrazer::RGB> colors;
+    DoneFunction done;
+};
+
+ControlServer::ControlServer(BackgroundServices *services, QObject *parent)
+    : QObject(parent)
+{
+    this->services = services;
+
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &ControlServer::newConnection);
+
+    QString path = socketPath();
+    if (!server->listen(path)) {
+        // A socket left behind by a crashed instance is taken over, a
+        // running instance keeps its own
+        QLocalSocket probe;
+        probe.connectToServer(path);
+        if (probe.waitForConnected(100)) {
+            qInfo("ControlServer: Another instance is listening on %s", qUtf8Printable(path));
+            return;
+        }
+        QLocalServer::removeServer(path);
+        if (!server->listen(path))
+            qWarning("ControlServer: Failed to listen on %s: %s", qUtf8Printable(path), qUtf8Printable(server->errorString()));
+    }
+
+    // Frames must not be sent to devices that are gone
+    connect(services, &BackgroundServices::deviceRemoved, this, [=](libopenrazer::Device *device) {
+        pendingFrames.remove(device);
+    });
+    connect(services, &BackgroundServices::deviceReplaced, this, [=](libopenrazer::Device *oldDevice) {
+        pendingFrames.remove(oldDevice);
+    });
+}
+
+ControlServer::~ControlServer()
+{
+    qDeleteAll(clients);
+}
+
+QString ControlServer::socketPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) + "/razergenie.sock";
+}
+
+void ControlServer::newConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection()) {
+        clients.insert(socket, new Client);
+        connect(socket, &QLocalSocket::readyRead, this, [=]() {
+            readMessages(socket);
+        });
+        connect(socket, &QLocalSocket::disconnected, this, [=]() {
+            delete clients.take(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ControlServer::readMessages(QLocalSocket *socket)
+{
+    Client *client = clients.value(socket);
+    if (client == nullptr)
+        return;
+
+    client->buffer.append(socket->readAll());
+
+    while (client->buffer.size() >= 4) {
+        QDataStream stream(client->buffer);
+        quint32 length;
+        stream >> length;
+        if (length > maxMessageSize) {
+            qWarning("ControlServer: Message of %u bytes is too large, closing the connection", length);
+            socket->disconnectFromServer();
+            return;
+        }
+        if (static_cast<quint32>(client->buffer.size()) < 4 + length)
+            return;
+
+        QByteArray payload = client->buffer.mid(4, length);
+        client->buffer.remove(0, 4 + length);
+        runBatch(socket, payload);
+    }
+}
+
+void ControlServer::runBatch(QLocalSocket *socket, const QByteArray &payload)
+{
+    quint32 batch = clients.value(socket)->nextBatch++;
+
+    QVector<Command> commands;
+    if (!parseBatch(payload, commands)) {
+        sendReply(socket, batch, { Malformed });
+        return;
+    }
+    if (commands.isEmpty()) {
+        sendReply(socket, batch, {});
+        return;
+    }
+
+    auto statuses = std::make_shared<QVector<Status>>(commands.size(), Ok);
+    auto remaining = std::make_shared<int>(commands.size());
+    QPointer<QLocalSocket> guard(socket);
+
+    for (int i = 0; i < commands.size(); i++) {
+        runCommand(socket, commands.at(i), [=](Status status) {
+            (*statuses)[i] = status;
+            if (--*remaining == 0 && guard != nullptr)
+                sendReply(guard, batch, *statuses);
+        });
+    }
+}
+
+void ControlServer::sendReply(QLocalSocket *socket, quint32 batch, const QVector<Status> &statuses)
+{
+    Client *client = clients.value(socket);
+    if (client == nullptr)
+        return;
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << static_cast<quint16>(statuses.size());
+    for (Status status : statuses)
+        stream << static_cast<quint8>(status);
+
+    QByteArray message;
+    QDataStream messageStream(&message, QIODevice::WriteOnly);
+    messageStream << static_cast<quint32>(payload.size());
+    message.append(payload);
+    client->finishedReplies.insert(batch, message);
+
+    while (client->finishedReplies.contains(client->nextReply))
+        socket->write(client->finishedReplies.take(client->nextReply++));
+}
+
+static bool readString(QDataStream &stream, QString &string)
+{
+    quint8 length;
+    stream >> length;
+    QByteArray data(length, Qt::Uninitialized);
+    if (stream.readRawData(data.data(), length) != length)
+        return false;
+    string = QString::fromUtf8(data);
+    return stream.status() == QDataStream::Ok;
+}
+
+static bool readColors(QDataStream &stream, int count, QVector<openrazer::RGB> &colors)
+{
+    QByteArray data(count * 3, Qt::Uninitialized);
+    if (stream.readRawData(data.data(), data.size()) != data.size())
+        return false;
+
+    colors.resize(count);
+    for (int i = 0; i < count; i++) {
+        colors[i] = openrazer::RGB { static_cast<uchar>(data.at(i * 3)),
+                                     static_cast<uchar>(data.at(i * 3 + 1)),
+                                     static_cast<uchar>(data.at(i * 3 + 2)) };
+    }
+    return true;
+}
+
+bool ControlServer::parseBatch(const QByteArray &payload, QVector<Command> &commands)
+{
+    QDataStream stream(payload);
+    quint16 count;
+    stream >> count;
+    if (stream.status() != QDataStream::Ok)
+        return false;
+
+    for (int i = 0; i < count; i++) {
+        Command command;
+        stream >> command.opcode;
+
+        switch (command.opcode) {
+        case SetEffect: {
+            quint8 colorCount;
+            if (!readString(stream, command.serial))
+                return false;
+            stream >> command.ledId >> command.effect >> colorCount;
+            // Off up to RippleRandom, anything else isn't an effect the daemon knows
+            if (command.effect > static_cast<quint8>(openrazer::Effect::RippleRandom))
+                return false;
+            if (stream.status() != QDataStream::Ok || !readColors(stream, colorCount, command.colors))
+                return false;
+            break;
+        }
+        case SetBrightness: {
+            if (!readString(stream, command.serial))
+                return false;
+            stream >> command.ledId >> command.value;
+            if (command.value > 100)
+                return false;
+            break;
+        }
+        case PushFrame: {
+            if (!readString(stream, command.serial))
+                return false;
+            stream >> command.rows >> command.columns;
+            if (stream.status() != QDataStream::Ok || command.rows == 0 || command.columns == 0
+                || !readColors(stream, command.rows * command.columns, command.colors))
+                return false;
+            break;
+        }
+        case ApplyProfile: {
+            if (!readString(stream, command.profileName))
+                return false;
+            break;
+        }
+        default:
+            return false;
+        }
+
+        if (stream.status() != QDataStream::Ok)
+            return false;
+        commands.append(command);
+    }
+
+    return stream.atEnd();
+}
+
+void ControlServer::runCommand(QLocalSocket *socket, const Command &command, DoneFunction done)
+{
+    if (command.opcode == ApplyProfile) {
+        done(services->applyProfile(command.profileName) ? Ok : Failed);
+        return;
+    }
+
+    libopenrazer::Device *device = findDevice(command.serial);
+    if (device == nullptr) {
+        done(UnknownDevice);
+        return;
+    }
+
+    if (command.opcode == PushFrame) {
+        pushFrame(device, command, done);
+        return;
+    }
+
+    QList<libopenrazer::Led *> leds;
+    for (libopenrazer::Led *led : device->getLeds()) {
+        if (command.ledId == allLeds || static_cast<quint8>(led->getLedId()) == command.ledId)
+            leds.append(led);
+    }
+    if (leds.isEmpty()) {
+        done(UnknownDevice);
+        return;
+    }
+
+    std::function<void()> write;
+    if (command.opcode == SetEffect) {
+        openrazer::Effect effect = static_cast<openrazer::Effect>(command.effect);
+        QVector<openrazer::RGB> colors = command.colors;
+        write = [=]() {
+            for (libopenrazer::Led *led : leds)
+                LedSettings::applyEffect(led, effect, colors);
+        };
+    } else {
+        // The LEDs take 0-255, the protocol a percentage
+        uchar brightness = static_cast<uchar>(qRound(command.value * 255 / 100.0));
+        write = [=]() {
+            for (libopenrazer::Led *led : leds) {
+                if (led->hasBrightness())
+                    led->setBrightness(brightness);
+            }
+        };
+    }
+
+    // Replies to clients that are gone aren't needed, the change is made anyway
+    services->getCommandQueue()->write(device, socket, write, [=](bool success) {
+        done(success ? Ok : Failed);
+    });
+}
+
+void ControlServer::pushFrame(libopenrazer::Device *device, const Command &command, DoneFunction done)
+{
+    // While a frame is still waiting in the queue of the device it just gets
+    // swapped for the new one, a client sending faster than the device
+    // takes them doesn't build up a backlog
+    std::shared_ptr<PendingFrame> frame = pendingFrames.value(device);
+    if (frame != nullptr) {
+        QMutexLocker locker(&frame->mutex);
+        if (!frame->taken) {
+            DoneFunction replaced = frame->done;
+            frame->rows = command.rows;
+            frame->columns = command.columns;
+            frame->colors = command.colors;
+            frame->done = done;
+            locker.unlock();
+            replaced(Replaced);
+            return;
+        }
+    }
+
+    frame = std::make_shared<PendingFrame>();
+    frame->rows = command.rows;
+    frame->columns = command.columns;
+    frame->colors = command.colors;
+    frame->done = done;
+    pendingFrames.insert(device, frame);
+
+    // Later frames of other clients can end up in this write, so it reports
+    // back as long as the server exists
+    services->getCommandQueue()->write(
+            device, this,
+            [=]() {
+                QMutexLocker locker(&frame->mutex);
+                frame->taken = true;
+                quint8 rows = frame->rows;
+                quint8 columns = frame->columns;
+                QVector<openrazer::RGB> colors = frame->colors;
+                locker.unlock();
+
+                for (int row = 0; row < rows; row++)
+                    device->defineCustomFrame(row, 0, columns - 1, colors.mid(row * columns, columns));
+                device->displayCustomFrame();
+            },
+            [=](bool success) {
+                if (pendingFrames.value(device) == frame)
+                    pendingFrames.remove(device);
+                frame->done(success ? Ok : Failed);
+            });
+}
+
+libopenrazer::Device *ControlServer::findDevice(const QString &serial) const
+{
+    for (libopenrazer::Device *device : services->getDevices()) {
+        if (services->getSerial(device) == serial)
+            return device;
+    }
+    return nullptr;
+}
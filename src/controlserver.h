@@ -0,0 +1,105 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef CONTROLSERVER_H
+#define CONTROLSERVER_H
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+#include <functional>
+#include <libopenrazer.h>
+#include <memory>
+
+class BackgroundServices;
+class QLocalServer;
+class QLocalSocket;
+
+/*
+ * A local socket other programs can change the lighting through while
+ * RazerGenie runs, e.g. game integrations sending many frames a second.
+ * The commands go through the same backend and command queues as the
+ * window, no process or D-Bus connection has to be set up per command.
+ *
+ * The socket is $XDG_RUNTIME_DIR/razergenie.sock. All integers are big
+ * endian, strings are a quint8 length followed by UTF-8.
+ *
+ * A message is a quint32 length and that many bytes of payload. The payload
+ * is a quint16 command count and the commands, each a quint8 opcode and its
+ * arguments:
+ *
+ *   1 set effect:     string serial, quint8 LED id, quint8 effect (the
+ *                     value of openrazer::Effect, 0 to 13),
+ *                     quint8 color count, 3 bytes RGB per color
+ *   2 set brightness: string serial, quint8 LED id (255 = all), quint8 percent
+ *   3 push frame:     string serial, quint8 rows, quint8 columns,
+ *                     3 bytes RGB per key, row by row
+ *   4 apply profile:  string name
+ *
+ * Once all commands of a message are done, the reply is sent: a message
+ * with a quint16 count and a quint8 status per command, see Status. Replies
+ * come in the order of the messages. A payload that can't be parsed gets a
+ * single Malformed status and none of its commands are run.
+ */
+class ControlServer : public QObject
+{
+    Q_OBJECT
+public:
+    enum Status {
+        Ok = 0,
+        Malformed = 1,
+        UnknownDevice = 2,
+        Failed = 3,
+        /* A newer frame for the device came in before this one was sent */
+        Replaced = 4,
+    };
+
+    explicit ControlServer(BackgroundServices *services, QObject *parent = nullptr);
+    ~ControlServer() override;
+
+    static QString socketPath();
+
+private:
+    struct Command {
+        quint8 opcode = 0;
+        QString serial;
+        quint8 ledId = 0;
+        quint8 effect = 0;
+        quint8 value = 0;
+        QVector<openrazer::RGB> colors;
+        quint8 rows = 0;
+        quint8 columns = 0;
+        QString profileName;
+    };
+
+    /* The latest frame of a device that's queued but not sent yet */
+    struct PendingFrame;
+
+    struct Client {
+        QByteArray buffer;
+        /* Replies have to go out in order, also when a later batch finishes first */
+        quint32 nextBatch = 0;
+        quint32 nextReply = 0;
+        QHash<quint32, QByteArray> finishedReplies;
+    };
+
+    typedef std::function<void(Status status)> DoneFunction;
+
+    BackgroundServices *services;
+    QLocalServer *server;
+    QHash<QLocalSocket *, Client *> clients;
+    QHash<libopenrazer::Device *, std::shared_ptr<PendingFrame>> pendingFrames;
+
+    void newConnection();
+    void readMessages(QLocalSocket *socket);
+    void runBatch(QLocalSocket *socket, const QByteArray &payload);
+    void sendReply(QLocalSocket *socket, quint32 batch, const QVector<Status> &statuses);
+
+    static bool parseBatch(const QByteArray &payload, QVector<Command> &commands);
+    void runCommand(QLocalSocket *socket, const Command &command, DoneFunction done);
+    void pushFrame(libopenrazer::Device *device, const Command &command, DoneFunction done);
+    libopenrazer::Device *findDevice(const QString &serial) const;
+};
+
+#endif // CONTROLSERVER_H
@@ -4,7 +4,9 @@
 
 #include "customeditor.h"
 
-#include "config.h"
+#include "devicecommandqueue.h"
+#include "devicewidget/pagestate.h"
+#include "matrixlayout.h"
 #include "util.h"
 
 #include <QEvent>
@@ -12,15 +14,18 @@
 #include <QPushButton>
 #include <QtWidgets>
 
-CustomEditor::CustomEditor(libopenrazer::Device *device, bool forceFallback, QWidget *parent)
+CustomEditor::CustomEditor(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, const PageState &state, bool forceFallback, QWidget *parent)
     : QDialog(parent)
 {
     setWindowTitle(tr("RazerGenie - Custom Editor"));
     this->device = device;
+    this->commandQueue = commandQueue;
 
     auto *vbox = new QVBoxLayout(this);
 
-    dimens = device->getMatrixDimensions();
+    // The layout was read together with the device page
+    dimens = state.matrixDimensions;
+    kbdLayout = state.keyboardLayout;
 
     // Initialize internal colors list
     for (int i = 0; i < dimens.x; i++) {
@@ -40,7 +45,7 @@ CustomEditor::CustomEditor(libopenrazer::Device *device, bool forceFallback, QWi
     // Add the main controls to the layout
     vbox->addLayout(buildMainControls());
 
-    QString type = device->getDeviceType();
+    QString type = state.deviceType;
 
     QLayout *deviceLayout = nullptr;
     // Build fallback layout if requested - ignore device type
@@ -58,7 +63,7 @@ CustomEditor::CustomEditor(libopenrazer::Device *device, bool forceFallback, QWi
 
     if (deviceLayout == nullptr) {
         qWarning("Unsupported custom layout for %s with type %s and dimensions %d x %d. Using fallback layout.",
-                 qUtf8Printable(device->getDeviceName()), qUtf8Printable(type), dimens.x, dimens.y);
+                 qUtf8Printable(state.deviceName), qUtf8Printable(type), dimens.x, dimens.y);
         deviceLayout = buildFallback();
     }
 
@@ -70,6 +75,11 @@ CustomEditor::CustomEditor(libopenrazer::Device *device, bool forceFallback, QWi
 
 CustomEditor::~CustomEditor() = default;
 
+libopenrazer::Device *CustomEditor::getDevice() const
+{
+    return device;
+}
+
 void CustomEditor::closeWindow()
 {
     setAttribute(Qt::WA_DeleteOnClose);
@@ -112,31 +122,18 @@ QLayout *CustomEditor::buildMainControls()
 QLayout *CustomEditor::buildKeyboard()
 {
     // Get the matching layout file name for the dimensions
-    QString layout;
-    if (dimens.x == 6 && dimens.y == 16) { // Razer Blade Stealth (Late 2017)
-        layout = "razerblade16";
-    } else if (dimens.x == 6 && dimens.y == 18) { // Tenkeyless Razer keyboad (e.g. BlackWidow V3 Tenkeyless)
-        layout = "razerdefault18";
-    } else if (dimens.x == 6 && dimens.y == 22) { // "Normal" Razer keyboad (e.g. BlackWidow Chroma)
-        layout = "razerdefault22";
-    } else if (dimens.x == 9 && dimens.y == 22) { // Razer Huntsman Elite
-        layout = "razerhunt22";
-    } else if (dimens.x == 6 && dimens.y == 25) { // Razer Blade Pro 2017
-        layout = "razerblade25";
-    } else {
+    QString layout = MatrixLayout::keyboardLayoutName(dimens);
+    if (layout.isEmpty())
         return nullptr;
-    }
 
     QJsonDocument keyboardKeysDoc = loadMatrixLayoutJson(layout);
     if (keyboardKeysDoc.isNull()) {
         return nullptr;
     }
 
-    QString kbdLayout = device->getKeyboardLayout();
-
     // Show a message when a completely unknown keyboard layout has been detected
     if (kbdLayout == "unknown") {
-        util::showInfo(tr("You are using a keyboard with a layout which is not known to the daemon. Please help us by visiting <a href='https://github.com/openrazer/openrazer/wiki/Keyboard-layouts'>https://github.com/openrazer/openrazer/wiki/Keyboard-layouts</a>. Using a fallback layout for now."));
+        util::showInfo(tr("You are using a keyboard with a layout which is not known to the daemon. Please help us by visiting <a href='https://github.com/openrazer/openrazer/wiki/Keyboard-layouts'>https://github.com/openrazer/openrazer/wiki/Keyboard-layouts</a>. Using a fallback layout for now."), "matrix_layout");
     }
 
     QJsonObject keyboardKeys = keyboardKeysDoc.object();
@@ -306,48 +303,27 @@ QLayout *CustomEditor::buildFallback()
  */
 QJsonDocument CustomEditor::loadMatrixLayoutJson(QString jsonname)
 {
-    QFile *file; // Pointer to file object to use
-    QFile file_devel("../../data/matrix_layouts/" + jsonname + ".json"); // File during developemnt
-
-#if defined(Q_OS_MACOS)
-    QString layoutDirectory = QApplication::applicationDirPath() + "/../Resources/matrix_layouts/";
-#else
-    QString layoutDirectory = QString(RAZERGENIE_DATADIR) + "/matrix_layouts/";
-#endif
-    QFile file_prod(layoutDirectory + jsonname + ".json");
-
-    // Try to open the dev file (higher priority)
-    if (file_devel.open(QIODevice::ReadOnly)) {
-        qInfo("RazerGenie: Using the development %s.json file.", qUtf8Printable(jsonname));
-        file = &file_devel;
-    } else {
-        // Try to open the production file
-        if (file_prod.open(QIODevice::ReadOnly)) {
-            qInfo("RazerGenie: Using the production %s.json file.", qUtf8Printable(jsonname));
-            file = &file_prod;
-        } else {
-            util::showInfo(tr("The file %1.json, used for the custom editor failed to load: %2").arg(jsonname, file_prod.errorString()));
-            return QJsonDocument();
-        }
-    }
-
-    // Read the file
-    QTextStream in(file);
-    QString data = in.readAll();
-    file->close();
-
-    // Convert it to a QJsonObject
-    return QJsonDocument::fromJson(data.toUtf8());
+    QString errorString;
+    QJsonDocument document = MatrixLayout::load(jsonname, &errorString);
+    if (document.isNull() && !errorString.isEmpty())
+        util::showInfo(tr("The file %1.json, used for the custom editor failed to load: %2").arg(jsonname, errorString), "matrix_layout");
+    return document;
 }
 
 void CustomEditor::updateKeyrow(int row)
 {
-    try {
-        device->defineCustomFrame(row, 0, dimens.y - 1, colors[row]);
-        device->displayCustomFrame();
-    } catch (const libopenrazer::DBusException &e) {
-        util::showError(tr("Error updating the lighting data."));
-    }
+    libopenrazer::Device *device = this->device;
+    int lastColumn = dimens.y - 1;
+    QVector<openrazer::RGB> rowColors = colors[row];
+    commandQueue->write(
+            device, this, [=]() {
+                device->defineCustomFrame(row, 0, lastColumn, rowColors);
+                device->displayCustomFrame();
+            },
+            [=](bool success) {
+                if (!success)
+                    util::showError(tr("Error updating the lighting data."), util::deviceCategory(device, "custom_frame"));
+            });
 }
 
 void CustomEditor::clearAll()
@@ -358,12 +334,15 @@ void CustomEditor::clearAll()
         blankColors << openrazer::RGB { 0, 0, 0 };
     }
 
-    // Send one request per row
-    for (int i = 0; i < dimens.x; i++) {
-        device->defineCustomFrame(i, 0, dimens.y - 1, blankColors);
-    }
-
-    device->displayCustomFrame();
+    // Send one request per row, all of them in a single queued command
+    libopenrazer::Device *device = this->device;
+    openrazer::MatrixDimensions dimens = this->dimens;
+    commandQueue->write(device, this, [=]() {
+        for (int i = 0; i < dimens.x; i++) {
+            device->defineCustomFrame(i, 0, dimens.y - 1, blankColors);
+        }
+        device->displayCustomFrame();
+    });
 
     // Reset view
     for (auto matrixPushButton : qAsConst(matrixPushButtons)) {
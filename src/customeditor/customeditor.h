@@ -11,6 +11,9 @@
 #include <QJsonObject>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+struct PageState;
+
 enum DrawStatus {
     set,
     clear
@@ -20,9 +23,11 @@ class CustomEditor : public QDialog
 {
     Q_OBJECT
 public:
-    CustomEditor(libopenrazer::Device *device, bool forceFallback = false, QWidget *parent = nullptr);
+    CustomEditor(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, const PageState &state, bool forceFallback = false, QWidget *parent = nullptr);
     ~CustomEditor() override;
 
+    libopenrazer::Device *getDevice() const;
+
 private:
     void closeWindow();
     QLayout *buildMainControls();
@@ -39,7 +44,9 @@ private:
 
     QVector<MatrixPushButton *> matrixPushButtons;
     libopenrazer::Device *device;
+    DeviceCommandQueue *commandQueue;
     openrazer::MatrixDimensions dimens;
+    QString kbdLayout;
 
     QVector<QVector<openrazer::RGB>> colors;
     QColor selectedColor;
@@ -0,0 +1,48 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "matrixlayout.h"
+
+#include "config.h"
+
+#include <QCoreApplication>
+#include <QFile>
+
+QString MatrixLayout::keyboardLayoutName(const openrazer::MatrixDimensions &dimensions)
+{
+    if (dimensions.x == 6 && dimensions.y == 16) // Razer Blade Stealth (Late 2017)
+        return "razerblade16";
+    if (dimensions.x == 6 && dimensions.y == 18) // Tenkeyless Razer keyboad (e.g. BlackWidow V3 Tenkeyless)
+        return "razerdefault18";
+    if (dimensions.x == 6 && dimensions.y == 22) // "Normal" Razer keyboad (e.g. BlackWidow Chroma)
+        return "razerdefault22";
+    if (dimensions.x == 9 && dimensions.y == 22) // Razer Huntsman Elite
+        return "razerhunt22";
+    if (dimensions.x == 6 && dimensions.y == 25) // Razer Blade Pro 2017
+        return "razerblade25";
+    return QString();
+}
+
+QJsonDocument MatrixLayout::load(const QString &name, QString *errorString)
+{
+    QFile file("../../data/matrix_layouts/" + name + ".json"); // File during development
+    if (file.open(QIODevice::ReadOnly)) {
+        qInfo("RazerGenie: Using the development %s.json file.", qUtf8Printable(name));
+        return QJsonDocument::fromJson(file.readAll());
+    }
+
+#if defined(Q_OS_MACOS)
+    QString layoutDirectory = QCoreApplication::applicationDirPath() + "/../Resources/matrix_layouts/";
+#else
+    QString layoutDirectory = QString(RAZERGENIE_DATADIR) + "/matrix_layouts/";
+#endif
+    file.setFileName(layoutDirectory + name + ".json");
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString != nullptr)
+            *errorString = file.errorString();
+        return QJsonDocument();
+    }
+    qInfo("RazerGenie: Using the production %s.json file.", qUtf8Printable(name));
+    return QJsonDocument::fromJson(file.readAll());
+}
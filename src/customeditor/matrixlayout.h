@@ -0,0 +1,24 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MATRIXLAYOUT_H
+#define MATRIXLAYOUT_H
+
+#include <QJsonDocument>
+#include <QString>
+#include <libopenrazer.h>
+
+/*
+ * The files in data/matrix_layouts/, describing which key sits at which
+ * position of the LED matrix.
+ */
+namespace MatrixLayout {
+/* The layout file of keyboards with these dimensions, empty if there's none */
+QString keyboardLayoutName(const openrazer::MatrixDimensions &dimensions);
+/* Loads <name>.json, the file next to the sources is preferred during
+ * development. Returns a null document and sets errorString on failure. */
+QJsonDocument load(const QString &name, QString *errorString = nullptr);
+}
+
+#endif // MATRIXLAYOUT_H
@@ -0,0 +1,319 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicecommandqueue.h"
+
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+/* How often a degraded device gets probed, in milliseconds */
+static const int probeInterval = 10 * 1000;
+
+DeviceCommandQueue::DeviceCommandQueue(QObject *parent)
+    : QObject(parent)
+{
+    // One thread per busy device, the threads mostly wait for the daemon
+    pool.setMaxThreadCount(16);
+}
+
+DeviceCommandQueue::~DeviceCommandQueue()
+{
+    // Commands that are still running use their devices, wait for all of
+    // them at once before deleting the devices that were removed meanwhile
+    pool.waitForDone();
+    for (libopenrazer::Device *device : qAsConst(removingDevices))
+        deleteDevice(device);
+    qDeleteAll(lanes);
+}
+
+void DeviceCommandQueue::write(libopenrazer::Device *device, QObject *context, std::function<void()> command,
+                               std::function<void(bool success)> finished)
+{
+    auto error = std::make_shared<QString>();
+    auto success = std::make_shared<bool>(false);
+
+    Task task;
+    task.context = context;
+    task.hasContext = context != nullptr;
+    task.skipWithoutContext = false;
+    task.timeout = writeTimeout();
+    task.run = [=]() -> Outcome {
+        try {
+            command();
+            *success = true;
+            return Succeeded;
+        } catch (const libopenrazer::DBusException &e) {
+            *error = e.message();
+            return outcomeOf(e);
+        }
+    };
+    task.deliver = [=]() {
+        if (!*success)
+            qWarning("DeviceCommandQueue: Write failed: %s", qUtf8Printable(*error));
+        if (finished)
+            finished(*success);
+    };
+    if (finished) {
+        task.drop = [=](const QString & /* error */) {
+            finished(false);
+        };
+    }
+    enqueue(device, task);
+}
+
+void DeviceCommandQueue::removeDevice(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.take(device);
+    if (lane == nullptr) {
+        deleteDevice(device);
+        return;
+    }
+
+    // Commands failed below must not bring the device back into the queue
+    removingDevices.insert(device);
+
+    if (lane->isRunning && !lane->timedOut && lane->running.drop && contextAlive(lane->running))
+        lane->running.drop(tr("The device was removed"));
+    for (const Task &task : qAsConst(lane->tasks)) {
+        if (task.drop && contextAlive(task))
+            task.drop(tr("The device was removed"));
+    }
+
+    delete lane->timeoutTimer;
+    delete lane->probeTimer;
+
+    if (lane->isRunning) {
+        // The running command still uses the device, nothing waits for it.
+        // The device goes once the command returns.
+        QFutureWatcher<Outcome> *watcher = lane->watcher;
+        watcher->disconnect(this);
+        connect(watcher, &QFutureWatcher<Outcome>::finished, this, [=]() {
+            watcher->deleteLater();
+            removingDevices.remove(device);
+            deleteDevice(device);
+        });
+    } else {
+        delete lane->watcher;
+        removingDevices.remove(device);
+        deleteDevice(device);
+    }
+    delete lane;
+}
+
+void DeviceCommandQueue::deleteDevice(libopenrazer::Device *device)
+{
+    emit deviceDeleted(device);
+    delete device;
+}
+
+bool DeviceCommandQueue::isBusy(libopenrazer::Device *device) const
+{
+    Lane *lane = lanes.value(device);
+    return lane != nullptr && (lane->isRunning || !lane->tasks.isEmpty());
+}
+
+bool DeviceCommandQueue::isDegraded(libopenrazer::Device *device) const
+{
+    Lane *lane = lanes.value(device);
+    return lane != nullptr && lane->degraded;
+}
+
+void DeviceCommandQueue::enqueue(libopenrazer::Device *device, const Task &task)
+{
+    // Same as the commands that were queued when the removal started
+    if (removingDevices.contains(device)) {
+        if (task.drop && contextAlive(task))
+            task.drop(tr("The device was removed"));
+        return;
+    }
+
+    Lane *lane = laneFor(device);
+
+    // Nothing gets sent to an unresponsive device except for the probe
+    if (lane->degraded) {
+        reject(task, tr("The device is not responding"));
+        return;
+    }
+
+    lane->tasks.enqueue(task);
+    if (!lane->isRunning)
+        startNext(device);
+}
+
+DeviceCommandQueue::Lane *DeviceCommandQueue::laneFor(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.value(device);
+    if (lane != nullptr)
+        return lane;
+    Q_ASSERT(!removingDevices.contains(device));
+
+    lane = new Lane;
+    lane->watcher = new QFutureWatcher<Outcome>(this);
+    connect(lane->watcher, &QFutureWatcher<Outcome>::finished, this, [=]() {
+        taskFinished(device);
+    });
+
+    lane->timeoutTimer = new QTimer(this);
+    lane->timeoutTimer->setSingleShot(true);
+    connect(lane->timeoutTimer, &QTimer::timeout, this, [=]() {
+        taskTimedOut(device);
+    });
+
+    lane->probeTimer = new QTimer(this);
+    lane->probeTimer->setInterval(probeInterval);
+    connect(lane->probeTimer, &QTimer::timeout, this, [=]() {
+        probe(device);
+    });
+
+    lanes.insert(device, lane);
+    return lane;
+}
+
+void DeviceCommandQueue::startNext(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.value(device);
+
+    while (!lane->tasks.isEmpty()) {
+        Task task = lane->tasks.dequeue();
+        if (task.skipWithoutContext && !contextAlive(task))
+            continue;
+
+        lane->running = task;
+        lane->isRunning = true;
+        lane->timedOut = false;
+        lane->timeoutTimer->start(task.timeout);
+        lane->watcher->setFuture(QtConcurrent::run(&pool, task.run));
+        return;
+    }
+}
+
+void DeviceCommandQueue::taskFinished(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.value(device);
+    if (lane == nullptr)
+        return;
+
+    Task task = lane->running;
+    bool timedOut = lane->timedOut;
+    Outcome outcome = lane->watcher->result();
+    lane->running = Task();
+    lane->isRunning = false;
+    lane->timedOut = false;
+    lane->timeoutTimer->stop();
+
+    // Any answer in time shows the device is alive, errors included
+    if (!timedOut && outcome != NoReply) {
+        lane->timeouts = 0;
+        if (lane->degraded) {
+            qInfo("DeviceCommandQueue: %s is responding again", qUtf8Printable(device->objectPath().path()));
+            lane->degraded = false;
+            lane->probeTimer->stop();
+            emit degradedChanged(device, false);
+        }
+    } else if (!timedOut) {
+        // The D-Bus call itself timed out before our timer did
+        countTimeout(device, lane);
+    }
+
+    // Start the next command first, delivering might queue new ones
+    startNext(device);
+
+    if (!timedOut && contextAlive(task))
+        task.deliver();
+}
+
+void DeviceCommandQueue::taskTimedOut(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.value(device);
+    if (lane == nullptr || !lane->isRunning || lane->timedOut)
+        return;
+
+    // The call keeps running on its thread and the lane stays busy until it
+    // returns, only its caller doesn't wait for it anymore
+    lane->timedOut = true;
+    qWarning("DeviceCommandQueue: %s didn't answer within %d ms", qUtf8Printable(device->objectPath().path()), lane->running.timeout);
+    reject(lane->running, tr("The device didn't answer in time"));
+
+    countTimeout(device, lane);
+}
+
+void DeviceCommandQueue::countTimeout(libopenrazer::Device *device, Lane *lane)
+{
+    lane->timeouts++;
+    if (lane->degraded || lane->timeouts < qMax(1, settings.value("degradedAfterTimeouts", 2).toInt()))
+        return;
+
+    qWarning("DeviceCommandQueue: %s is not responding, pausing its commands", qUtf8Printable(device->objectPath().path()));
+    lane->degraded = true;
+    failQueued(lane, tr("The device is not responding"));
+    lane->probeTimer->start();
+    emit degradedChanged(device, true);
+}
+
+void DeviceCommandQueue::probe(libopenrazer::Device *device)
+{
+    Lane *lane = lanes.value(device);
+    if (lane == nullptr || !lane->degraded || lane->isRunning)
+        return;
+
+    // One cheap call, its outcome is handled in taskFinished()
+    Task task;
+    task.timeout = readTimeout();
+    task.run = [=]() -> Outcome {
+        try {
+            device->getDeviceName();
+            return Succeeded;
+        } catch (const libopenrazer::DBusException &e) {
+            return outcomeOf(e);
+        }
+    };
+    task.deliver = []() {};
+    lane->tasks.enqueue(task);
+    startNext(device);
+}
+
+void DeviceCommandQueue::failQueued(Lane *lane, const QString &error)
+{
+    // Failing a command can queue new ones, those are handled by enqueue()
+    QQueue<Task> tasks;
+    tasks.swap(lane->tasks);
+    for (const Task &task : qAsConst(tasks))
+        reject(task, error);
+}
+
+void DeviceCommandQueue::reject(const Task &task, const QString &error)
+{
+    if (!task.drop)
+        return;
+
+    // Always report asynchronously, callers don't expect an answer while queueing
+    QPointer<QObject> context = task.context;
+    bool hasContext = task.hasContext;
+    FailedFunction drop = task.drop;
+    QTimer::singleShot(0, this, [=]() {
+        if (!hasContext || !context.isNull())
+            drop(error);
+    });
+}
+
+int DeviceCommandQueue::readTimeout()
+{
+    return qMax(100, settings.value("readTimeout", 10000).toInt());
+}
+
+int DeviceCommandQueue::writeTimeout()
+{
+    return qMax(100, settings.value("writeTimeout", 3000).toInt());
+}
+
+DeviceCommandQueue::Outcome DeviceCommandQueue::outcomeOf(const libopenrazer::DBusException &e)
+{
+    return e.name() == "org.freedesktop.DBus.Error.NoReply" ? NoReply : Failed;
+}
+
+bool DeviceCommandQueue::contextAlive(const Task &task)
+{
+    return !task.hasContext || !task.context.isNull();
+}
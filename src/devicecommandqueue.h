@@ -0,0 +1,173 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICECOMMANDQUEUE_H
+#define DEVICECOMMANDQUEUE_H
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QQueue>
+#include <QSet>
+#include <QSettings>
+#include <QThreadPool>
+#include <functional>
+#include <libopenrazer.h>
+#include <memory>
+
+template<typename T>
+class QFutureWatcher;
+class QTimer;
+
+/*
+ * Runs the calls to the backend off the UI thread.
+ *
+ * Every device has its own FIFO queue: commands for one device run one
+ * after the other in the order they were queued, while commands for
+ * different devices run in parallel on a dedicated thread pool. A device
+ * that takes long to answer therefore only holds up its own commands.
+ *
+ * Results are delivered on the UI thread. Read results are dropped if their
+ * context object was destroyed in the meantime, writes are sent anyway.
+ *
+ * A command that doesn't finish within its timeout (writeTimeout and
+ * readTimeout in the settings) is reported as failed right away. The call
+ * itself can't be cancelled though: libopenrazer doesn't give access to its
+ * D-Bus interfaces, so their timeout can't be lowered. The device's later
+ * commands wait until the call returns or D-Bus gives up on it (25 seconds
+ * by default). After degradedAfterTimeouts timeouts in a row the device is
+ * marked degraded: its commands are rejected without being sent and a
+ * cheap probe call is made every few seconds until the device answers
+ * again.
+ *
+ * Only hasFeature(), getLeds(), getLedId() and objectPath() may still be
+ * called directly, libopenrazer answers them without talking to the daemon.
+ */
+class DeviceCommandQueue : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DeviceCommandQueue(QObject *parent = nullptr);
+    ~DeviceCommandQueue() override;
+
+    typedef std::function<void(const QString &error)> FailedFunction;
+
+    /* Queue a command returning a value. finished or failed is called with
+     * the outcome, unless context is gone by then. */
+    template<typename T>
+    void read(libopenrazer::Device *device, QObject *context, std::function<T()> command,
+              std::function<void(const T &)> finished, FailedFunction failed = nullptr);
+
+    /* Queue a command changing the device. finished is called with whether
+     * it succeeded, if context still exists. */
+    void write(libopenrazer::Device *device, QObject *context, std::function<void()> command,
+               std::function<void(bool success)> finished = nullptr);
+
+    /* Drops the commands of the device and takes it over. The device is
+     * deleted right away, or once its running command returns. */
+    void removeDevice(libopenrazer::Device *device);
+
+    /* Returns true while commands of the device are queued or running */
+    bool isBusy(libopenrazer::Device *device) const;
+    /* Returns true while the device is considered unresponsive */
+    bool isDegraded(libopenrazer::Device *device) const;
+
+signals:
+    void degradedChanged(libopenrazer::Device *device, bool degraded);
+    /* Emitted right before a removed device gets deleted */
+    void deviceDeleted(libopenrazer::Device *device);
+
+private:
+    enum Outcome {
+        Succeeded,
+        Failed,
+        NoReply,
+    };
+
+    struct Task {
+        QPointer<QObject> context;
+        bool hasContext = false;
+        /* Reads don't need to run anymore once their context is gone */
+        bool skipWithoutContext = false;
+        int timeout = 0;
+        std::function<Outcome()> run;
+        std::function<void()> deliver;
+        FailedFunction drop;
+    };
+
+    struct Lane {
+        QQueue<Task> tasks;
+        QFutureWatcher<Outcome> *watcher = nullptr;
+        QTimer *timeoutTimer = nullptr;
+        QTimer *probeTimer = nullptr;
+        Task running;
+        bool isRunning = false;
+        /* The caller of the running command was already told it failed */
+        bool timedOut = false;
+        int timeouts = 0;
+        bool degraded = false;
+    };
+
+    QSettings settings;
+    QThreadPool pool;
+    QHash<libopenrazer::Device *, Lane *> lanes;
+    /* Removed devices that aren't deleted yet, new commands for them are
+     * dropped right away */
+    QSet<libopenrazer::Device *> removingDevices;
+
+    void deleteDevice(libopenrazer::Device *device);
+    void enqueue(libopenrazer::Device *device, const Task &task);
+    Lane *laneFor(libopenrazer::Device *device);
+    void startNext(libopenrazer::Device *device);
+    void taskFinished(libopenrazer::Device *device);
+    void taskTimedOut(libopenrazer::Device *device);
+    void countTimeout(libopenrazer::Device *device, Lane *lane);
+    void probe(libopenrazer::Device *device);
+    void failQueued(Lane *lane, const QString &error);
+    void reject(const Task &task, const QString &error);
+    int readTimeout();
+    int writeTimeout();
+    static Outcome outcomeOf(const libopenrazer::DBusException &e);
+    static bool contextAlive(const Task &task);
+};
+
+template<typename T>
+void DeviceCommandQueue::read(libopenrazer::Device *device, QObject *context, std::function<T()> command,
+                              std::function<void(const T &)> finished, FailedFunction failed)
+{
+    // Filled in on the worker thread, read on the UI thread once the task is done
+    auto result = std::make_shared<T>();
+    auto error = std::make_shared<QString>();
+    auto success = std::make_shared<bool>(false);
+
+    Task task;
+    task.context = context;
+    task.hasContext = context != nullptr;
+    task.skipWithoutContext = true;
+    task.timeout = readTimeout();
+    task.run = [=]() -> Outcome {
+        try {
+            *result = command();
+            *success = true;
+            return Succeeded;
+        } catch (const libopenrazer::DBusException &e) {
+            *error = e.message();
+            return outcomeOf(e);
+        }
+    };
+    task.deliver = [=]() {
+        if (*success) {
+            if (finished)
+                finished(*result);
+        } else {
+            qWarning("DeviceCommandQueue: Read failed: %s", qUtf8Printable(*error));
+            if (failed)
+                failed(*error);
+        }
+    };
+    task.drop = failed;
+    enqueue(device, task);
+}
+
+#endif // DEVICECOMMANDQUEUE_H
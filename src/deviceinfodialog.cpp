@@ -4,12 +4,14 @@
 
 #include "deviceinfodialog.h"
 
+#include "devicecommandqueue.h"
+
 #include <QFormLayout>
 #include <QLabel>
 #include <QScrollArea>
 #include <QVBoxLayout>
 
-DeviceInfoDialog::DeviceInfoDialog(libopenrazer::Device *device, QWidget *parent)
+DeviceInfoDialog::DeviceInfoDialog(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, QWidget *parent)
     : QDialog(parent)
 {
     setWindowTitle(tr("RazerGenie - Device info"));
@@ -47,29 +49,33 @@ DeviceInfoDialog::DeviceInfoDialog(libopenrazer::Device *device, QWidget *parent
     aboutSeparator->setFrameShadow(QFrame::Sunken);
     formLayout->addRow(aboutSeparator);
 
-    /* Serial number */
-    QString serial = "error";
-    try {
-        serial = device->getSerial();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get serial");
-    }
+    /* Serial number, filled in once the device answered */
     QLabel *serialLabel = new QLabel(this);
-    serialLabel->setText(serial);
+    serialLabel->setText(tr("Loading..."));
     serialLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
     formLayout->addRow(tr("Serial number:"), serialLabel);
 
+    commandQueue->read<QString>(
+            device, this, [=]() { return device->getSerial(); },
+            [=](const QString &serial) { serialLabel->setText(serial); },
+            [=](const QString & /* error */) {
+                qWarning("Failed to get serial");
+                serialLabel->setText("error");
+            });
+
     /* Firmware version */
-    QString firmwareVersion = "error";
-    try {
-        firmwareVersion = device->getFirmwareVersion();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get firmware version");
-    }
     QLabel *firmwareVersionLabel = new QLabel(this);
-    firmwareVersionLabel->setText(firmwareVersion);
+    firmwareVersionLabel->setText(tr("Loading..."));
     firmwareVersionLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
     formLayout->addRow(tr("Firmware version:"), firmwareVersionLabel);
+
+    commandQueue->read<QString>(
+            device, this, [=]() { return device->getFirmwareVersion(); },
+            [=](const QString &firmwareVersion) { firmwareVersionLabel->setText(firmwareVersion); },
+            [=](const QString & /* error */) {
+                qWarning("Failed to get firmware version");
+                firmwareVersionLabel->setText("error");
+            });
 }
 
 DeviceInfoDialog::~DeviceInfoDialog() = default;
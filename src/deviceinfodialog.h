@@ -8,11 +8,13 @@
 #include <QDialog>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+
 class DeviceInfoDialog : public QDialog
 {
     Q_OBJECT
 public:
-    DeviceInfoDialog(libopenrazer::Device *device, QWidget *parent = nullptr);
+    DeviceInfoDialog(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, QWidget *parent = nullptr);
     ~DeviceInfoDialog() override;
 };
 
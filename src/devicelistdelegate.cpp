@@ -0,0 +1,72 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicelistdelegate.h"
+
+#include "devicelistmodel.h"
+
+#include <QApplication>
+#include <QPainter>
+
+/* Height of the area the device image gets painted in */
+static const int imageHeight = 75;
+static const int rowHeight = 120;
+static const int margin = 2;
+
+DeviceListDelegate::DeviceListDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+DeviceListDelegate::~DeviceListDelegate() = default;
+
+void DeviceListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem opt = option;
+    initStyleOption(&opt, index);
+
+    // Let the style paint the background and selection, the content is painted below
+    QStyle *style = opt.widget != nullptr ? opt.widget->style() : QApplication::style();
+    opt.text.clear();
+    opt.icon = QIcon();
+    opt.features &= ~QStyleOptionViewItem::HasDecoration;
+    style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+    QRect rect = option.rect.adjusted(margin, margin, -margin, -margin);
+    QRect imageRect(rect.left(), rect.top(), rect.width(), imageHeight);
+    QRect textRect(rect.left(), imageRect.bottom() + 1 + margin, rect.width(), rect.bottom() - imageRect.bottom() - margin);
+
+    painter->save();
+
+    bool selected = option.state & QStyle::State_Selected;
+    painter->setPen(option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+
+    /* Image */
+    QPixmap image = qvariant_cast<QPixmap>(index.data(Qt::DecorationRole));
+    if (!image.isNull()) {
+        QSize size = image.size() / image.devicePixelRatio();
+        painter->drawPixmap(QStyle::alignedRect(Qt::LeftToRight, Qt::AlignCenter, size, imageRect), image);
+    } else {
+        QString text;
+        switch (index.data(DeviceListModel::ImageStateRole).toInt()) {
+        case DeviceListModel::ImageDownloading:
+            text = tr("Downloading image...");
+            break;
+        case DeviceListModel::ImageMissing:
+            text = tr("No image");
+            break;
+        }
+        painter->drawText(imageRect, Qt::AlignCenter | Qt::TextWordWrap, text);
+    }
+
+    /* Name */
+    painter->drawText(textRect, Qt::AlignHCenter | Qt::AlignTop | Qt::TextWordWrap, index.data(Qt::DisplayRole).toString());
+
+    painter->restore();
+}
+
+QSize DeviceListDelegate::sizeHint(const QStyleOptionViewItem & /* option */, const QModelIndex & /* index */) const
+{
+    return QSize(/* any small width */ 1, rowHeight);
+}
@@ -0,0 +1,26 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICELISTDELEGATE_H
+#define DEVICELISTDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+/*
+ * Paints a device of the DeviceListModel: the image with the device name
+ * below it. Nothing but the painting is done per row, so long lists don't
+ * cost any widgets.
+ */
+class DeviceListDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit DeviceListDelegate(QObject *parent = nullptr);
+    ~DeviceListDelegate() override;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
+
+#endif // DEVICELISTDELEGATE_H
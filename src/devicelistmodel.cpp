@@ -0,0 +1,212 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicelistmodel.h"
+
+#include "backgroundservices.h"
+#include "razerimagedownloader.h"
+#include "thumbnailcache.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QIcon>
+#include <QtConcurrent/QtConcurrentRun>
+
+/* Size the device images are shown at */
+static const QSize imageSize(150, 75);
+
+DeviceListModel::DeviceListModel(BackgroundServices *services, QObject *parent)
+    : QAbstractListModel(parent)
+{
+    this->services = services;
+    downloader = services->getImageDownloader();
+
+    connect(services, &BackgroundServices::deviceInfoRead, this, &DeviceListModel::deviceInfoRead);
+
+    connect(downloader, &RazerImageDownloader::imageChanged, this, [=](const QUrl &url, const QString &filename) {
+        for (const Item &item : qAsConst(items)) {
+            if (item.imageUrl == url)
+                loadImage(item.device, filename);
+        }
+    });
+}
+
+DeviceListModel::~DeviceListModel() = default;
+
+int DeviceListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return items.size();
+}
+
+QVariant DeviceListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= items.size())
+        return QVariant();
+
+    const Item &item = items.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return item.name;
+    case Qt::DecorationRole:
+        return item.image;
+    case Qt::ToolTipRole:
+        return item.toolTip;
+    case DeviceRole:
+        return QVariant::fromValue(static_cast<void *>(item.device));
+    case ImageStateRole:
+        return item.imageState;
+    }
+    return QVariant();
+}
+
+void DeviceListModel::addDevice(libopenrazer::Device *device)
+{
+    Item item;
+    item.device = device;
+    item.name = services->getDeviceName(device);
+    item.imageUrl = QUrl(services->getDeviceImageUrl(device));
+    item.imageState = ImageLoading;
+
+    beginInsertRows(QModelIndex(), items.size(), items.size());
+    items.append(item);
+    endInsertRows();
+
+    // Otherwise the image gets fetched once the URL is known
+    if (services->hasDeviceInfo(device))
+        fetchImage(device, item.imageUrl);
+}
+
+void DeviceListModel::replaceDevice(libopenrazer::Device *oldDevice, libopenrazer::Device *newDevice)
+{
+    int row = rowOf(oldDevice);
+    if (row == -1)
+        return;
+
+    Item &item = items[row];
+    item.device = newDevice;
+
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { DeviceRole });
+
+    // The name and image of the old device stay until the new one's are read
+    if (services->hasDeviceInfo(newDevice))
+        deviceInfoRead(newDevice);
+}
+
+void DeviceListModel::deviceInfoRead(libopenrazer::Device *device)
+{
+    int row = rowOf(device);
+    if (row == -1)
+        return;
+
+    Item &item = items[row];
+    if (!services->getDeviceName(device).isEmpty())
+        item.name = services->getDeviceName(device);
+
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { Qt::DisplayRole });
+
+    // Keep the image unless the device has a different one. Images still
+    // being loaded are requested again, the pending results of a replaced
+    // device are delivered to the old one.
+    QUrl imageUrl(services->getDeviceImageUrl(device));
+    if (!imageUrl.isEmpty() && imageUrl != item.imageUrl)
+        item.imageUrl = imageUrl;
+    else if (item.imageState != ImageLoading && item.imageState != ImageDownloading)
+        return;
+    fetchImage(device, item.imageUrl);
+}
+
+void DeviceListModel::fetchImage(libopenrazer::Device *device, const QUrl &imageUrl)
+{
+    if (imageUrl.isEmpty()) {
+        qWarning() << "Device image for" << services->getDeviceName(device) << "is missing.";
+        setImageState(device, ImageMissing);
+        return;
+    }
+
+    if (RazerImageDownloader::isCached(imageUrl)) {
+        loadImage(device, RazerImageDownloader::getFilePath(imageUrl));
+        downloader->revalidate(imageUrl);
+        return;
+    }
+
+    setImageState(device, ImageDownloading);
+    ImageDownload *download = downloader->download(imageUrl);
+    connect(download, &ImageDownload::downloadFinished, this, [=](const QString &filename) {
+        loadImage(device, filename);
+    });
+    connect(download, &ImageDownload::downloadErrored, this, [=](const QString &reason, const QString &longReason) {
+        qDebug() << "DeviceListModel: Image download failed:" << reason << longReason;
+        setImageState(device, ImageFailed, QIcon::fromTheme("folder-pictures-symbolic").pixmap(40), longReason);
+    });
+}
+
+void DeviceListModel::removeDevice(libopenrazer::Device *device)
+{
+    int row = rowOf(device);
+    if (row == -1)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    items.remove(row);
+    endRemoveRows();
+}
+
+libopenrazer::Device *DeviceListModel::device(const QModelIndex &index) const
+{
+    return static_cast<libopenrazer::Device *>(index.data(DeviceRole).value<void *>());
+}
+
+QModelIndex DeviceListModel::indexOf(libopenrazer::Device *device) const
+{
+    int row = rowOf(device);
+    if (row == -1)
+        return QModelIndex();
+    return index(row);
+}
+
+int DeviceListModel::rowOf(libopenrazer::Device *device) const
+{
+    for (int i = 0; i < items.size(); i++) {
+        if (items.at(i).device == device)
+            return i;
+    }
+    return -1;
+}
+
+void DeviceListModel::loadImage(libopenrazer::Device *device, const QString &filename)
+{
+    // Decoding and scaling happens on a worker thread. The device might be
+    // gone once that's done, so it's looked up again afterwards.
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [=]() {
+        QImage image = watcher->result();
+        watcher->deleteLater();
+        if (image.isNull()) {
+            setImageState(device, ImageFailed, QIcon::fromTheme("folder-pictures-symbolic").pixmap(40), tr("The device image couldn't be read."));
+        } else {
+            setImageState(device, ImageLoaded, QPixmap::fromImage(image));
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&ThumbnailCache::load, filename, imageSize, qApp->devicePixelRatio()));
+}
+
+void DeviceListModel::setImageState(libopenrazer::Device *device, ImageState state, const QPixmap &image, const QString &toolTip)
+{
+    int row = rowOf(device);
+    if (row == -1)
+        return;
+
+    Item &item = items[row];
+    item.imageState = state;
+    item.image = image;
+    item.toolTip = toolTip;
+
+    QModelIndex changed = index(row);
+    emit dataChanged(changed, changed, { Qt::DecorationRole, Qt::ToolTipRole, ImageStateRole });
+}
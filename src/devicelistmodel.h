@@ -0,0 +1,76 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICELISTMODEL_H
+#define DEVICELISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QPixmap>
+#include <QUrl>
+#include <QVector>
+#include <libopenrazer.h>
+
+class BackgroundServices;
+class RazerImageDownloader;
+
+/*
+ * The devices shown in the sidebar, with their name and image.
+ *
+ * Name and image URL come from the background services once they have been
+ * read. Images are fetched through the image downloader and decoded into
+ * thumbnails on a worker thread, rows get updated once that's done.
+ */
+class DeviceListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        DeviceRole = Qt::UserRole,
+        ImageStateRole,
+    };
+
+    enum ImageState {
+        ImageLoading,
+        ImageDownloading,
+        ImageLoaded,
+        ImageMissing,
+        ImageFailed,
+    };
+    Q_ENUM(ImageState)
+
+    explicit DeviceListModel(BackgroundServices *services, QObject *parent = nullptr);
+    ~DeviceListModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void addDevice(libopenrazer::Device *device);
+    void removeDevice(libopenrazer::Device *device);
+    /* Moves the row of oldDevice over to newDevice, e.g. after a backend switch */
+    void replaceDevice(libopenrazer::Device *oldDevice, libopenrazer::Device *newDevice);
+    libopenrazer::Device *device(const QModelIndex &index) const;
+    QModelIndex indexOf(libopenrazer::Device *device) const;
+
+private:
+    struct Item {
+        libopenrazer::Device *device;
+        QString name;
+        QUrl imageUrl;
+        ImageState imageState;
+        QPixmap image;
+        QString toolTip;
+    };
+
+    BackgroundServices *services;
+    RazerImageDownloader *downloader;
+    QVector<Item> items;
+
+    int rowOf(libopenrazer::Device *device) const;
+    void deviceInfoRead(libopenrazer::Device *device);
+    void fetchImage(libopenrazer::Device *device, const QUrl &imageUrl);
+    void loadImage(libopenrazer::Device *device, const QString &filename);
+    void setImageState(libopenrazer::Device *device, ImageState state, const QPixmap &image = QPixmap(), const QString &toolTip = QString());
+};
+
+#endif // DEVICELISTMODEL_H
@@ -0,0 +1,347 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicestate.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QMetaEnum>
+#include <QMutex>
+
+/* The direction last set per LED, applyEffect() runs on worker threads */
+static QMutex directionsMutex;
+static QHash<libopenrazer::Led *, bool> directions;
+
+LedSettings LedSettings::read(libopenrazer::Led *led)
+{
+    LedSettings settings;
+
+    try {
+        settings.effect = led->getCurrentEffect();
+        settings.colors = led->getCurrentColors();
+        settings.hasEffect = true;
+        QMutexLocker locker(&directionsMutex);
+        settings.direction = directions.value(led, true);
+    } catch (const libopenrazer::DBusException &e) {
+        qWarning("Failed to get current effect");
+    }
+
+    if (led->hasBrightness()) {
+        try {
+            settings.brightness = led->getBrightness();
+            settings.hasBrightness = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get brightness");
+        }
+    }
+
+    return settings;
+}
+
+void LedSettings::applyEffect(libopenrazer::Led *led, openrazer::Effect effect, const QVector<openrazer::RGB> &colors, bool direction)
+{
+    openrazer::RGB color1 = colors.value(0, { 0, 255, 0 });
+    openrazer::RGB color2 = colors.value(1, { 0, 255, 0 });
+
+    switch (effect) {
+    case openrazer::Effect::Off: {
+        led->setOff();
+        break;
+    }
+    case openrazer::Effect::On: {
+        led->setOn();
+        break;
+    }
+    case openrazer::Effect::Static: {
+        led->setStatic(color1);
+        break;
+    }
+    case openrazer::Effect::Breathing: {
+        led->setBreathing(color1);
+        break;
+    }
+    case openrazer::Effect::BreathingDual: {
+        led->setBreathingDual(color1, color2);
+        break;
+    }
+    case openrazer::Effect::BreathingRandom: {
+        led->setBreathingRandom();
+        break;
+    }
+    case openrazer::Effect::BreathingMono: {
+        led->setBreathingMono();
+        break;
+    }
+    case openrazer::Effect::Blinking: {
+        led->setBlinking(color1);
+        break;
+    }
+    case openrazer::Effect::Spectrum: {
+        led->setSpectrum();
+        break;
+    }
+    case openrazer::Effect::Wave: {
+        led->setWave(direction ? openrazer::WaveDirection::RIGHT_TO_LEFT : openrazer::WaveDirection::LEFT_TO_RIGHT);
+        QMutexLocker locker(&directionsMutex);
+        directions.insert(led, direction);
+        break;
+    }
+    case openrazer::Effect::Wheel: {
+        led->setWheel(direction ? openrazer::WheelDirection::CLOCKWISE : openrazer::WheelDirection::COUNTER_CLOCKWISE);
+        QMutexLocker locker(&directionsMutex);
+        directions.insert(led, direction);
+        break;
+    }
+    case openrazer::Effect::Reactive: {
+        led->setReactive(color1, openrazer::ReactiveSpeed::_500MS); // TODO Configure speed?
+        break;
+    }
+    case openrazer::Effect::Ripple: {
+        led->setRipple(color1);
+        break;
+    }
+    case openrazer::Effect::RippleRandom: {
+        led->setRippleRandom();
+        break;
+    }
+    default:
+        // Mostly called from worker threads, so don't throw here
+        qWarning("Effect not handled: %s", qUtf8Printable(QVariant::fromValue(effect).toString()));
+    }
+}
+
+void LedSettings::forgetDevice(libopenrazer::Device *device)
+{
+    QMutexLocker locker(&directionsMutex);
+    for (libopenrazer::Led *led : device->getLeds()) {
+        directions.remove(led);
+    }
+}
+
+DeviceState DeviceState::read(libopenrazer::Device *device)
+{
+    DeviceState state = readDeviceSettings(device);
+
+    for (libopenrazer::Led *led : device->getLeds()) {
+        state.leds.insert(led->getLedId(), LedSettings::read(led));
+    }
+
+    return state;
+}
+
+DeviceState DeviceState::readDeviceSettings(libopenrazer::Device *device)
+{
+    DeviceState state;
+
+    if (device->hasFeature("dpi")) {
+        if (device->hasFeature("dpi_stages")) {
+            try {
+                QPair<uchar, QVector<openrazer::DPI>> stagesPair = device->getDPIStages();
+                state.activeStage = stagesPair.first;
+                state.dpiStages = stagesPair.second;
+                state.hasDpiStages = true;
+            } catch (const libopenrazer::DBusException &e) {
+                qWarning("Failed to get dpi stages");
+            }
+        }
+        try {
+            state.dpi = device->getDPI();
+            state.hasDpi = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get dpi");
+        }
+    }
+
+    if (device->hasFeature("poll_rate")) {
+        try {
+            state.pollRate = device->getPollRate();
+            state.hasPollRate = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get poll rate");
+        }
+    }
+
+    if (device->hasFeature("idle_time")) {
+        try {
+            state.idleTime = device->getIdleTime();
+            state.hasIdleTime = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get idle time");
+        }
+    }
+
+    if (device->hasFeature("low_battery_threshold")) {
+        try {
+            state.lowBatteryThreshold = device->getLowBatteryThreshold();
+            state.hasLowBatteryThreshold = true;
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get low battery threshold");
+        }
+    }
+
+    return state;
+}
+
+static QJsonArray dpiToJson(const openrazer::DPI &dpi)
+{
+    return QJsonArray { dpi.dpi_x, dpi.dpi_y };
+}
+
+static openrazer::DPI dpiFromJson(const QJsonValue &value)
+{
+    QJsonArray array = value.toArray();
+    return { static_cast<ushort>(array.at(0).toInt()), static_cast<ushort>(array.at(1).toInt()) };
+}
+
+QJsonObject DeviceState::toJson() const
+{
+    QMetaEnum ledIdEnum = QMetaEnum::fromType<openrazer::LedId>();
+    QMetaEnum effectEnum = QMetaEnum::fromType<openrazer::Effect>();
+
+    QJsonObject object;
+
+    QJsonObject ledsObject;
+    QMapIterator<openrazer::LedId, LedSettings> i(leds);
+    while (i.hasNext()) {
+        i.next();
+        const LedSettings &settings = i.value();
+        QJsonObject ledObject;
+        if (settings.hasEffect) {
+            ledObject.insert("effect", effectEnum.valueToKey(static_cast<int>(settings.effect)));
+            QJsonArray colorsArray;
+            for (const openrazer::RGB &color : settings.colors) {
+                colorsArray.append(QJsonArray { color.r, color.g, color.b });
+            }
+            ledObject.insert("colors", colorsArray);
+            if (settings.effect == openrazer::Effect::Wave || settings.effect == openrazer::Effect::Wheel)
+                ledObject.insert("direction", settings.direction);
+        }
+        if (settings.hasBrightness)
+            ledObject.insert("brightness", settings.brightness);
+        ledsObject.insert(ledIdEnum.valueToKey(static_cast<int>(i.key())), ledObject);
+    }
+    object.insert("leds", ledsObject);
+
+    if (hasDpi)
+        object.insert("dpi", dpiToJson(dpi));
+    if (hasDpiStages) {
+        QJsonArray stagesArray;
+        for (const openrazer::DPI &stage : dpiStages) {
+            stagesArray.append(dpiToJson(stage));
+        }
+        object.insert("activeStage", activeStage);
+        object.insert("dpiStages", stagesArray);
+    }
+    if (hasPollRate)
+        object.insert("pollRate", pollRate);
+    if (hasIdleTime)
+        object.insert("idleTime", idleTime);
+    if (hasLowBatteryThreshold)
+        object.insert("lowBatteryThreshold", lowBatteryThreshold);
+
+    return object;
+}
+
+DeviceState DeviceState::fromJson(const QJsonObject &object)
+{
+    QMetaEnum ledIdEnum = QMetaEnum::fromType<openrazer::LedId>();
+    QMetaEnum effectEnum = QMetaEnum::fromType<openrazer::Effect>();
+
+    DeviceState state;
+
+    QJsonObject ledsObject = object.value("leds").toObject();
+    for (auto it = ledsObject.constBegin(); it != ledsObject.constEnd(); ++it) {
+        bool ok;
+        int ledId = ledIdEnum.keyToValue(qUtf8Printable(it.key()), &ok);
+        if (!ok) {
+            qWarning("Unknown LED %s in device state", qUtf8Printable(it.key()));
+            continue;
+        }
+
+        QJsonObject ledObject = it.value().toObject();
+        LedSettings settings;
+        if (ledObject.contains("effect")) {
+            int effect = effectEnum.keyToValue(qUtf8Printable(ledObject.value("effect").toString()), &ok);
+            if (ok) {
+                settings.hasEffect = true;
+                settings.effect = static_cast<openrazer::Effect>(effect);
+                for (const QJsonValue &color : ledObject.value("colors").toArray()) {
+                    QJsonArray rgb = color.toArray();
+                    settings.colors.append({ static_cast<uchar>(rgb.at(0).toInt()),
+                                             static_cast<uchar>(rgb.at(1).toInt()),
+                                             static_cast<uchar>(rgb.at(2).toInt()) });
+                }
+                settings.direction = ledObject.value("direction").toBool(true);
+            }
+        }
+        if (ledObject.contains("brightness")) {
+            settings.hasBrightness = true;
+            settings.brightness = ledObject.value("brightness").toInt();
+        }
+        state.leds.insert(static_cast<openrazer::LedId>(ledId), settings);
+    }
+
+    if (object.contains("dpi")) {
+        state.hasDpi = true;
+        state.dpi = dpiFromJson(object.value("dpi"));
+    }
+    if (object.contains("dpiStages")) {
+        state.hasDpiStages = true;
+        state.activeStage = object.value("activeStage").toInt(1);
+        for (const QJsonValue &stage : object.value("dpiStages").toArray()) {
+            state.dpiStages.append(dpiFromJson(stage));
+        }
+    }
+    if (object.contains("pollRate")) {
+        state.hasPollRate = true;
+        state.pollRate = object.value("pollRate").toInt();
+    }
+    if (object.contains("idleTime")) {
+        state.hasIdleTime = true;
+        state.idleTime = object.value("idleTime").toInt();
+    }
+    if (object.contains("lowBatteryThreshold")) {
+        state.hasLowBatteryThreshold = true;
+        state.lowBatteryThreshold = object.value("lowBatteryThreshold").toInt();
+    }
+
+    return state;
+}
+
+bool colorsEqual(const QVector<openrazer::RGB> &a, const QVector<openrazer::RGB> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); i++) {
+        if (a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b)
+            return false;
+    }
+    return true;
+}
+
+bool effectEqual(const LedSettings &a, const LedSettings &b)
+{
+    if (a.effect != b.effect || !colorsEqual(a.colors, b.colors))
+        return false;
+    // Only these two have a direction
+    if (a.effect == openrazer::Effect::Wave || a.effect == openrazer::Effect::Wheel)
+        return a.direction == b.direction;
+    return true;
+}
+
+bool dpiEqual(const openrazer::DPI &a, const openrazer::DPI &b)
+{
+    return a.dpi_x == b.dpi_x && a.dpi_y == b.dpi_y;
+}
+
+bool dpiStagesEqual(const QVector<openrazer::DPI> &a, const QVector<openrazer::DPI> &b)
+{
+    if (a.size() != b.size())
+        return false;
+    for (int i = 0; i < a.size(); i++) {
+        if (!dpiEqual(a[i], b[i]))
+            return false;
+    }
+    return true;
+}
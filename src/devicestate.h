@@ -0,0 +1,70 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICESTATE_H
+#define DEVICESTATE_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QVector>
+#include <libopenrazer.h>
+
+/*
+ * The settings of a single LED that RazerGenie can change.
+ */
+struct LedSettings {
+    bool hasEffect = false;
+    openrazer::Effect effect = openrazer::Effect::Static;
+    QVector<openrazer::RGB> colors;
+    /* Right-to-left for waves and clockwise for wheels. The backends can't
+     * report it, read() returns the one last set through applyEffect(). */
+    bool direction = true;
+    bool hasBrightness = false;
+    uchar brightness = 0;
+
+    static LedSettings read(libopenrazer::Led *led);
+
+    /* Set the effect on the LED, see direction */
+    static void applyEffect(libopenrazer::Led *led, openrazer::Effect effect, const QVector<openrazer::RGB> &colors, bool direction = true);
+    /* Drop the directions remembered for the LEDs of the device, has to be
+     * called before it gets deleted */
+    static void forgetDevice(libopenrazer::Device *device);
+};
+
+/*
+ * The settings of a device that RazerGenie can change. Values that the
+ * device doesn't support or that failed to be read have their has* member
+ * set to false.
+ */
+struct DeviceState {
+    QMap<openrazer::LedId, LedSettings> leds;
+
+    bool hasDpi = false;
+    openrazer::DPI dpi = { 0, 0 };
+    bool hasDpiStages = false;
+    uchar activeStage = 0;
+    QVector<openrazer::DPI> dpiStages;
+    bool hasPollRate = false;
+    ushort pollRate = 0;
+    bool hasIdleTime = false;
+    ushort idleTime = 0;
+    bool hasLowBatteryThreshold = false;
+    uchar lowBatteryThreshold = 0;
+
+    /* Read the device level settings and the settings of all LEDs */
+    static DeviceState read(libopenrazer::Device *device);
+    /* Read only the device level settings, leaving leds empty */
+    static DeviceState readDeviceSettings(libopenrazer::Device *device);
+
+    QJsonObject toJson() const;
+    static DeviceState fromJson(const QJsonObject &object);
+};
+
+bool colorsEqual(const QVector<openrazer::RGB> &a, const QVector<openrazer::RGB> &b);
+/* Whether the LED has to be written to go from one effect to the other */
+bool effectEqual(const LedSettings &a, const LedSettings &b);
+bool dpiEqual(const openrazer::DPI &a, const openrazer::DPI &b);
+bool dpiStagesEqual(const QVector<openrazer::DPI> &a, const QVector<openrazer::DPI> &b);
+
+#endif // DEVICESTATE_H
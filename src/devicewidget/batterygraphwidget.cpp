@@ -0,0 +1,100 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "batterygraphwidget.h"
+
+#include "battery/batteryhistory.h"
+
+#include <QDateTime>
+#include <QPainter>
+#include <QPainterPath>
+
+/* Samples further apart than this weren't taken while RazerGenie was running */
+static const quint32 maxSampleGap = 30 * 60;
+
+BatteryGraphWidget::BatteryGraphWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    history = nullptr;
+    span = 24 * 3600;
+    setMinimumHeight(120);
+}
+
+BatteryGraphWidget::~BatteryGraphWidget() = default;
+
+void BatteryGraphWidget::setHistory(const BatteryHistory *history)
+{
+    this->history = history;
+    update();
+}
+
+void BatteryGraphWidget::setSpan(int seconds)
+{
+    span = seconds;
+    update();
+}
+
+QSize BatteryGraphWidget::sizeHint() const
+{
+    return QSize(400, 150);
+}
+
+void BatteryGraphWidget::paintEvent(QPaintEvent * /* event */)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    QFontMetrics metrics = fontMetrics();
+    int labelWidth = metrics.horizontalAdvance("100%") + 6;
+    QRect plot = rect().adjusted(labelWidth, metrics.height() / 2, -1, -metrics.height() - 4);
+    if (plot.width() <= 0 || plot.height() <= 0)
+        return;
+
+    /* Axes */
+    QColor gridColor = palette().color(QPalette::WindowText);
+    gridColor.setAlpha(60);
+    painter.setPen(gridColor);
+    for (int percent : { 0, 50, 100 }) {
+        int y = plot.bottom() - plot.height() * percent / 100;
+        painter.drawLine(plot.left(), y, plot.right(), y);
+    }
+
+    painter.setPen(palette().color(QPalette::WindowText));
+    for (int percent : { 0, 50, 100 }) {
+        int y = plot.bottom() - plot.height() * percent / 100;
+        QRect labelRect(0, y - metrics.height() / 2, labelWidth - 6, metrics.height());
+        painter.drawText(labelRect, Qt::AlignRight | Qt::AlignVCenter, QString("%1%").arg(percent));
+    }
+    QRect timeRect(plot.left(), plot.bottom() + 4, plot.width(), metrics.height());
+    painter.drawText(timeRect, Qt::AlignLeft, tr("%n hour(s) ago", nullptr, span / 3600));
+    painter.drawText(timeRect, Qt::AlignRight, tr("Now"));
+
+    if (history == nullptr || history->count() == 0)
+        return;
+
+    /* Samples */
+    qint64 now = QDateTime::currentSecsSinceEpoch();
+    qint64 start = now - span;
+
+    QPainterPath path;
+    bool connected = false;
+    quint32 previousTime = 0;
+    for (int i = 0; i < history->count(); i++) {
+        BatterySample sample = history->at(i);
+        if (sample.time < start)
+            continue;
+
+        QPointF point(plot.left() + plot.width() * double(sample.time - start) / span,
+                      plot.bottom() - plot.height() * sample.percent() / 100.0);
+        if (connected && sample.time - previousTime <= maxSampleGap)
+            path.lineTo(point);
+        else
+            path.moveTo(point);
+        connected = true;
+        previousTime = sample.time;
+    }
+
+    painter.setPen(QPen(palette().color(QPalette::Highlight), 2));
+    painter.drawPath(path);
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef BATTERYGRAPHWIDGET_H
+#define BATTERYGRAPHWIDGET_H
+
+#include <QWidget>
+
+class BatteryHistory;
+
+/*
+ * Plots the charge of the recent battery samples.
+ */
+class BatteryGraphWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit BatteryGraphWidget(QWidget *parent = nullptr);
+    ~BatteryGraphWidget() override;
+
+    void setHistory(const BatteryHistory *history);
+    /* Time span shown, in seconds */
+    void setSpan(int seconds);
+
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    const BatteryHistory *history;
+    int span;
+};
+
+#endif // BATTERYGRAPHWIDGET_H
@@ -0,0 +1,189 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "devicestatewatcher.h"
+
+#include "devicecommandqueue.h"
+
+#include <QDBusArgument>
+#include <QDBusConnection>
+#include <QWidget>
+
+DeviceStateWatcher::DeviceStateWatcher(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, QWidget *page)
+    : QObject(page)
+{
+    this->device = device;
+    this->commandQueue = commandQueue;
+    this->page = page;
+
+    hasLastState = false;
+    backendHasSignals = false;
+    readRunning = false;
+    readQueued = false;
+    queuedDeviceSettings = false;
+    generation = 0;
+
+    // We don't know which bus the backend is on, the match rule is cheap either way
+    QString path = device->objectPath().path();
+    QDBusConnection::sessionBus().connect(QString(), path, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                                          this, SLOT(propertiesChanged(QString, QVariantMap, QStringList)));
+    QDBusConnection::systemBus().connect(QString(), path, "org.freedesktop.DBus.Properties", "PropertiesChanged",
+                                         this, SLOT(propertiesChanged(QString, QVariantMap, QStringList)));
+
+    pollTimer.setInterval(2000);
+    connect(&pollTimer, &QTimer::timeout, this, &DeviceStateWatcher::poll);
+    pollTimer.start();
+}
+
+DeviceStateWatcher::~DeviceStateWatcher() = default;
+
+void DeviceStateWatcher::discardPendingRead()
+{
+    generation++;
+}
+
+void DeviceStateWatcher::refresh()
+{
+    startRead();
+}
+
+void DeviceStateWatcher::propertiesChanged(const QString & /* interface */, const QVariantMap &changedProperties, const QStringList &invalidatedProperties)
+{
+    // The backend tells us about changes of the device settings, the LEDs
+    // have objects of their own and still need to be polled
+    if (!backendHasSignals) {
+        qDebug("DeviceStateWatcher: Backend sends change signals, polling only the LEDs");
+        backendHasSignals = true;
+        if (device->getLeds().isEmpty())
+            pollTimer.stop();
+    }
+
+    // Without a known state there's nothing to apply the changes to, and
+    // invalidated or unknown properties only say that something changed
+    DeviceState state = lastState;
+    if (!hasLastState || !invalidatedProperties.isEmpty() || !applyProperties(changedProperties, state)) {
+        startRead();
+        return;
+    }
+
+    // A read that's running now might not include the changes yet
+    if (readRunning) {
+        discardPendingRead();
+        readQueued = true;
+    }
+    applyState(state);
+}
+
+bool DeviceStateWatcher::applyProperties(const QVariantMap &properties, DeviceState &state)
+{
+    for (auto it = properties.constBegin(); it != properties.constEnd(); ++it) {
+        const QVariant &value = it.value();
+        if (it.key() == "DPI" && value.canConvert<QDBusArgument>()) {
+            // (qq), x and y
+            const QDBusArgument argument = value.value<QDBusArgument>();
+            argument.beginStructure();
+            argument >> state.dpi.dpi_x >> state.dpi.dpi_y;
+            argument.endStructure();
+            state.hasDpi = true;
+        } else if (it.key() == "PollRate") {
+            state.pollRate = static_cast<ushort>(value.toUInt());
+            state.hasPollRate = true;
+        } else if (it.key() == "IdleTime") {
+            state.idleTime = static_cast<ushort>(value.toUInt());
+            state.hasIdleTime = true;
+        } else if (it.key() == "LowBatteryThreshold") {
+            state.lowBatteryThreshold = static_cast<uchar>(value.toUInt());
+            state.hasLowBatteryThreshold = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeviceStateWatcher::poll()
+{
+    if (readRunning || !page->isVisible())
+        return;
+
+    startRead(!backendHasSignals);
+}
+
+void DeviceStateWatcher::startRead(bool deviceSettings)
+{
+    if (readRunning) {
+        // Make sure we catch the latest change once the current read is done
+        readQueued = true;
+        queuedDeviceSettings |= deviceSettings;
+        return;
+    }
+
+    readRunning = true;
+    readQueued = false;
+    queuedDeviceSettings = false;
+    int readGeneration = generation;
+
+    libopenrazer::Device *device = this->device;
+    commandQueue->read<DeviceState>(
+            device, this, [=]() {
+                if (deviceSettings)
+                    return DeviceState::read(device);
+                DeviceState state;
+                for (libopenrazer::Led *led : device->getLeds()) {
+                    state.leds.insert(led->getLedId(), LedSettings::read(led));
+                }
+                return state;
+            },
+            [=](const DeviceState &state) {
+                readRunning = false;
+                if (readGeneration == generation) {
+                    if (deviceSettings) {
+                        applyState(state);
+                    } else {
+                        // Only the LEDs were read, the rest is still known
+                        DeviceState merged = lastState;
+                        merged.leds = state.leds;
+                        applyState(merged);
+                    }
+                }
+                if (readQueued)
+                    startRead(queuedDeviceSettings);
+            },
+            [=](const QString & /* error */) {
+                readRunning = false;
+                if (readQueued)
+                    startRead(queuedDeviceSettings);
+            });
+}
+
+void DeviceStateWatcher::applyState(const DeviceState &state)
+{
+    bool first = !hasLastState;
+
+    for (libopenrazer::Led *led : device->getLeds()) {
+        if (!state.leds.contains(led->getLedId()))
+            continue;
+        LedSettings settings = state.leds.value(led->getLedId());
+        LedSettings last = lastState.leds.value(led->getLedId());
+
+        if (settings.hasEffect && (first || !last.hasEffect || settings.effect != last.effect || !colorsEqual(settings.colors, last.colors)))
+            emit ledEffectChanged(led, settings.effect, settings.colors);
+        if (settings.hasBrightness && (first || !last.hasBrightness || settings.brightness != last.brightness))
+            emit ledBrightnessChanged(led, settings.brightness);
+    }
+
+    if (state.hasDpiStages && (first || !lastState.hasDpiStages || state.activeStage != lastState.activeStage || !dpiStagesEqual(state.dpiStages, lastState.dpiStages)))
+        emit dpiStagesChanged(state.activeStage, state.dpiStages);
+    if (state.hasDpi && (first || !lastState.hasDpi || !dpiEqual(state.dpi, lastState.dpi)))
+        emit dpiChanged(state.dpi);
+    if (state.hasPollRate && (first || !lastState.hasPollRate || state.pollRate != lastState.pollRate))
+        emit pollRateChanged(state.pollRate);
+    if (state.hasIdleTime && (first || !lastState.hasIdleTime || state.idleTime != lastState.idleTime))
+        emit idleTimeChanged(state.idleTime);
+    if (state.hasLowBatteryThreshold && (first || !lastState.hasLowBatteryThreshold || state.lowBatteryThreshold != lastState.lowBatteryThreshold))
+        emit lowBatteryThresholdChanged(state.lowBatteryThreshold);
+
+    lastState = state;
+    hasLastState = true;
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DEVICESTATEWATCHER_H
+#define DEVICESTATEWATCHER_H
+
+#include "devicestate.h"
+
+#include <QObject>
+#include <QTimer>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+
+/*
+ * Notices changes made to a device outside of RazerGenie (e.g. by
+ * openrazer-cli, another GUI or a game) and reports them incrementally.
+ *
+ * The watcher listens for org.freedesktop.DBus.Properties.PropertiesChanged
+ * on the device object. The values in the signal are applied directly, only
+ * properties the watcher doesn't know lead to reading all settings. While
+ * the page is visible, a poll compares the current settings with the last
+ * known ones. Once the device sent such a signal, the poll only reads the
+ * effect and brightness of the LEDs: they are separate objects that
+ * libopenrazer doesn't give the path of, so their signals can't be watched.
+ * Only settings that differ from the last known state are emitted.
+ */
+class DeviceStateWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    DeviceStateWatcher(libopenrazer::Device *device, DeviceCommandQueue *commandQueue, QWidget *page);
+    ~DeviceStateWatcher() override;
+
+    /* Drop the result of a read that is currently running, e.g. because a
+     * write was started that the result might not include yet */
+    void discardPendingRead();
+    /* Read the settings now, whether the page is visible or not */
+    void refresh();
+
+signals:
+    void ledEffectChanged(libopenrazer::Led *led, openrazer::Effect effect, const QVector<openrazer::RGB> &colors);
+    void ledBrightnessChanged(libopenrazer::Led *led, uchar brightness);
+    void dpiChanged(openrazer::DPI dpi);
+    void dpiStagesChanged(uchar activeStage, const QVector<openrazer::DPI> &dpiStages);
+    void pollRateChanged(ushort pollRate);
+    void idleTimeChanged(ushort idleTime);
+    void lowBatteryThresholdChanged(uchar threshold);
+
+private slots:
+    void propertiesChanged(const QString &interface, const QVariantMap &changedProperties, const QStringList &invalidatedProperties);
+    void poll();
+
+private:
+    libopenrazer::Device *device;
+    DeviceCommandQueue *commandQueue;
+    QWidget *page;
+    QTimer pollTimer;
+
+    DeviceState lastState;
+    bool hasLastState;
+    bool backendHasSignals;
+    bool readRunning;
+    bool readQueued;
+    /* Whether the queued read has to include the device settings */
+    bool queuedDeviceSettings;
+    int generation;
+
+    /* Read the LEDs, and the device settings as well if deviceSettings */
+    void startRead(bool deviceSettings = true);
+    /* Returns false if one of the properties isn't known */
+    static bool applyProperties(const QVariantMap &properties, DeviceState &state);
+    void applyState(const DeviceState &state);
+};
+
+#endif // DEVICESTATEWATCHER_H
@@ -4,18 +4,23 @@
 
 #include "devicewidget.h"
 
+#include "devicecommandqueue.h"
 #include "deviceinfodialog.h"
+#include "devicestatewatcher.h"
 #include "lightingwidget.h"
+#include "pagestate.h"
 #include "performancewidget.h"
 #include "powerwidget.h"
 
 #include <QLabel>
 #include <QPushButton>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QTabWidget>
+#include <QTimer>
 #include <QVBoxLayout>
 
-DeviceWidget::DeviceWidget(libopenrazer::Device *device)
+DeviceWidget::DeviceWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, BatteryMonitor *batteryMonitor)
     : QWidget()
 {
     auto *verticalLayout = new QVBoxLayout(this);
@@ -25,7 +30,7 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
     /* Header items */
     auto *headerHBox = new QHBoxLayout();
 
-    QLabel *header = new QLabel(device->getDeviceName(), this);
+    QLabel *header = new QLabel(state.deviceName, this);
     header->setFont(titleFont);
     headerHBox->addWidget(header);
 
@@ -36,7 +41,7 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
     QIcon infoIcon = QIcon::fromTheme("help-about-symbolic");
     infoButton->setIcon(infoIcon);
     connect(infoButton, &QPushButton::pressed, this, [=]() {
-        auto *info = new DeviceInfoDialog(device, this);
+        auto *info = new DeviceInfoDialog(device, commandQueue, this);
         info->setWindowModality(Qt::WindowModal);
         info->setAttribute(Qt::WA_DeleteOnClose);
         info->show();
@@ -45,12 +50,21 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
 
     verticalLayout->addLayout(headerHBox);
 
+    /* Shown while the device doesn't answer, see DeviceCommandQueue */
+    QLabel *degradedLabel = new QLabel(tr("The device is not responding. Changes are paused until it answers again."), this);
+    degradedLabel->setWordWrap(true);
+    degradedLabel->hide();
+    verticalLayout->addWidget(degradedLabel);
+
+    /* Keeps the pages up to date with changes made outside of RazerGenie */
+    stateWatcher = new DeviceStateWatcher(device, commandQueue, this);
+
     /* Tabs */
-    QTabWidget *tabWidget = new QTabWidget(this);
+    tabWidget = new QTabWidget(this);
 
     /* Lighting tab */
     if (LightingWidget::isAvailable(device)) {
-        auto widget = new LightingWidget(device);
+        auto widget = new LightingWidget(device, state, commandQueue, stateWatcher);
 
         auto scrollArea = new QScrollArea;
         scrollArea->setWidgetResizable(true);
@@ -61,7 +75,7 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
 
     /* Performance tab */
     if (PerformanceWidget::isAvailable(device)) {
-        auto widget = new PerformanceWidget(device);
+        auto widget = new PerformanceWidget(device, state, commandQueue, stateWatcher);
 
         auto scrollArea = new QScrollArea;
         scrollArea->setWidgetResizable(true);
@@ -72,7 +86,7 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
 
     /* Power tab */
     if (PowerWidget::isAvailable(device)) {
-        auto widget = new PowerWidget(device);
+        auto widget = new PowerWidget(device, state, commandQueue, stateWatcher, batteryMonitor);
 
         auto scrollArea = new QScrollArea;
         scrollArea->setWidgetResizable(true);
@@ -82,6 +96,59 @@ DeviceWidget::DeviceWidget(libopenrazer::Device *device)
     }
 
     verticalLayout->addWidget(tabWidget);
+
+    auto setDegraded = [=](bool degraded) {
+        degradedLabel->setVisible(degraded);
+        tabWidget->setEnabled(!degraded);
+    };
+    setDegraded(commandQueue->isDegraded(device));
+    connect(commandQueue, &DeviceCommandQueue::degradedChanged, this, [=](libopenrazer::Device *changedDevice, bool degraded) {
+        if (changedDevice != device)
+            return;
+        setDegraded(degraded);
+        // Changes made before it stopped answering might not have arrived
+        if (!degraded)
+            stateWatcher->refresh();
+    });
 }
 
 DeviceWidget::~DeviceWidget() = default;
+
+DeviceWidget::ViewState DeviceWidget::saveViewState() const
+{
+    ViewState state;
+    state.currentTab = tabWidget->currentIndex();
+    for (int i = 0; i < tabWidget->count(); i++) {
+        auto *scrollArea = qobject_cast<QScrollArea *>(tabWidget->widget(i));
+        state.scrollPositions.append(scrollArea != nullptr ? scrollArea->verticalScrollBar()->value() : 0);
+    }
+    return state;
+}
+
+void DeviceWidget::restoreViewState(const ViewState &state)
+{
+    tabWidget->setCurrentIndex(state.currentTab);
+    for (int i = 0; i < tabWidget->count() && i < state.scrollPositions.size(); i++) {
+        auto *scrollArea = qobject_cast<QScrollArea *>(tabWidget->widget(i));
+        if (scrollArea == nullptr)
+            continue;
+        // The scroll range is only known once the page is laid out
+        int position = state.scrollPositions.at(i);
+        auto restoreScroll = [=]() {
+            QTimer::singleShot(0, scrollArea, [=]() {
+                scrollArea->verticalScrollBar()->setValue(position);
+            });
+        };
+        // The lighting tab only gets its LEDs once their state was read
+        auto *lightingWidget = qobject_cast<LightingWidget *>(scrollArea->widget());
+        if (lightingWidget != nullptr && !lightingWidget->isLoaded())
+            connect(lightingWidget, &LightingWidget::loaded, scrollArea, restoreScroll);
+        else
+            restoreScroll();
+    }
+}
+
+void DeviceWidget::refreshState()
+{
+    stateWatcher->refresh();
+}
@@ -6,15 +6,39 @@
 #define DEVICEWIDGET_H
 
 #include <QDBusObjectPath>
+#include <QVector>
 #include <QWidget>
 #include <libopenrazer.h>
 
+class BatteryMonitor;
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+class QTabWidget;
+struct PageState;
+
 class DeviceWidget : public QWidget
 {
     Q_OBJECT
 public:
-    DeviceWidget(libopenrazer::Device *device);
+    /* What's needed to show a rebuilt page the way it was left */
+    struct ViewState {
+        int currentTab = 0;
+        /* Vertical scroll position of every tab */
+        QVector<int> scrollPositions;
+    };
+
+    /* state has to be read from the device beforehand, see PageState::read() */
+    DeviceWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, BatteryMonitor *batteryMonitor);
     ~DeviceWidget() override;
+
+    ViewState saveViewState() const;
+    void restoreViewState(const ViewState &state);
+    /* Reads the settings of the device again, e.g. after the daemon restarted */
+    void refreshState();
+
+private:
+    QTabWidget *tabWidget;
+    DeviceStateWatcher *stateWatcher;
 };
 
 #endif // DEVICEWIDGET_H
@@ -4,16 +4,22 @@
 
 #include "dpicomboboxwidget.h"
 
+#include "devicecommandqueue.h"
+#include "devicestatewatcher.h"
+#include "pagestate.h"
 #include "util.h"
 
 #include <QComboBox>
 #include <QLabel>
+#include <QSignalBlocker>
 #include <QVBoxLayout>
 
-DpiComboBoxWidget::DpiComboBoxWidget(QWidget *parent, libopenrazer::Device *device)
+DpiComboBoxWidget::DpiComboBoxWidget(QWidget *parent, libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher)
     : QWidget(parent)
 {
     this->device = device;
+    this->commandQueue = commandQueue;
+    this->stateWatcher = stateWatcher;
 
     QVBoxLayout *verticalLayout = new QVBoxLayout(this);
 
@@ -25,31 +31,35 @@ DpiComboBoxWidget::DpiComboBoxWidget(QWidget *parent, libopenrazer::Device *devi
     verticalLayout->addWidget(dpiHeader);
 
     QComboBox *dpiComboBox = new QComboBox;
-    QVector<ushort> allowedDPI = device->getAllowedDPI();
-    for (ushort dpi : allowedDPI) {
+    for (ushort dpi : state.allowedDpi) {
         dpiComboBox->addItem(QString("%1 DPI").arg(dpi), dpi);
     }
 
-    openrazer::DPI currDPI = { 0, 0 };
-    try {
-        currDPI = device->getDPI();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get dpi");
-    }
-
-    dpiComboBox->setCurrentText(QString("%1 DPI").arg(currDPI.dpi_x));
+    dpiComboBox->setCurrentText(QString("%1 DPI").arg(state.settings.dpi.dpi_x));
     verticalLayout->addWidget(dpiComboBox);
 
     connect(dpiComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &DpiComboBoxWidget::dpiChanged);
+
+    connect(stateWatcher, &DeviceStateWatcher::dpiChanged, this, [=](openrazer::DPI dpi) {
+        QSignalBlocker blocker(dpiComboBox);
+        dpiComboBox->setCurrentText(QString("%1 DPI").arg(dpi.dpi_x));
+    });
 }
 
 void DpiComboBoxWidget::dpiChanged(int /* index */)
 {
     auto *sender = qobject_cast<QComboBox *>(QObject::sender());
-    try {
-        device->setDPI({ sender->currentData().value<ushort>(), 0 });
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to set DPI");
-        util::showError(tr("Failed to set DPI"));
-    }
+    ushort dpi = sender->currentData().value<ushort>();
+    libopenrazer::Device *device = this->device;
+    // A state read in the meantime might not include the new value yet
+    stateWatcher->discardPendingRead();
+    commandQueue->write(
+            device, this, [=]() { device->setDPI({ dpi, 0 }); },
+            [=](bool success) {
+                stateWatcher->discardPendingRead();
+                if (!success) {
+                    qWarning("Failed to set DPI");
+                    util::showError(tr("Failed to set DPI"), util::deviceCategory(device, "dpi"));
+                }
+            });
 }
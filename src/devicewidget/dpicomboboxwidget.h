@@ -8,17 +8,23 @@
 #include <QWidget>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+struct PageState;
+
 class DpiComboBoxWidget : public QWidget
 {
     Q_OBJECT
 public:
-    DpiComboBoxWidget(QWidget *parent, libopenrazer::Device *device);
+    DpiComboBoxWidget(QWidget *parent, libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher);
 
 public slots:
     void dpiChanged(int /* value */);
 
 private:
     libopenrazer::Device *device;
+    DeviceCommandQueue *commandQueue;
+    DeviceStateWatcher *stateWatcher;
 };
 
 #endif // DPICOMBOBOXWIDGET_H
@@ -4,6 +4,9 @@
 
 #include "dpisliderwidget.h"
 
+#include "devicestatewatcher.h"
+#include "pagestate.h"
+#include "propertywriter.h"
 #include "util.h"
 
 #include <QCheckBox>
@@ -14,11 +17,28 @@
 #include <QSlider>
 #include <QSpinBox>
 
-DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
+static QPoint dpiToPoint(openrazer::DPI dpi)
+{
+    return QPoint(dpi.dpi_x, dpi.dpi_y);
+}
+
+static openrazer::DPI pointToDpi(QPoint point)
+{
+    return { static_cast<ushort>(point.x()), static_cast<ushort>(point.y()) };
+}
+
+DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher)
     : QWidget(parent)
 {
     this->device = device;
 
+    writer = new PropertyWriter(commandQueue, device, this);
+    connect(writer, &PropertyWriter::writeFailed, this, [=]() {
+        qWarning("Failed to set DPI");
+        util::showError(tr("Failed to set DPI"), util::deviceCategory(device, "dpi"));
+    });
+    connect(writer, &PropertyWriter::busyChanged, stateWatcher, &DeviceStateWatcher::discardPendingRead);
+
     // The widget seems to get big spacing in some cases without this size policy
     setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed));
 
@@ -72,22 +92,14 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
     // DPI stages
     const int minimumDpi = 100;
 
-    int maximumDpi = 0;
-    try {
-        maximumDpi = device->maxDPI();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get max dpi");
-    }
+    int maximumDpi = state.maxDpi;
 
     if (device->hasFeature("dpi_stages")) {
-        QPair<uchar, QVector<openrazer::DPI>> stagesPair = { 1, {} };
-        try {
-            stagesPair = device->getDPIStages();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get dpi stages");
+        activeStage = 1;
+        if (state.settings.hasDpiStages) {
+            activeStage = state.settings.activeStage;
+            dpiStages = state.settings.dpiStages;
         }
-        activeStage = stagesPair.first;
-        dpiStages = stagesPair.second;
 
         // Assume user wants DPI synced if all values are currently equal
         bool isSynced = true;
@@ -114,7 +126,7 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
                     widget->informStageActive(activeStage);
                 }
 
-                device->setDPIStages(activeStage, dpiStages);
+                writer->setValue("dpi_stages", stagesValue());
             });
 
             connect(stageWidget, &DpiStageWidget::dpiChanged, this, [=](int stageNumber, openrazer::DPI dpi) {
@@ -122,7 +134,7 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
 
                 /* Apply to device */
                 if (singleStage) {
-                    device->setDPI(dpi);
+                    writer->setValue("dpi", dpiToPoint(dpi));
                 } else {
                     /* If the currently active stage was disabled, we need to
                      * find a new one to enable */
@@ -133,7 +145,7 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
                         }
                     }
 
-                    device->setDPIStages(activeStage, dpiStages);
+                    writer->setValue("dpi_stages", stagesValue());
                 }
             });
 
@@ -143,13 +155,52 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
         }
 
         handleStageUpdates();
+
+        writer->addProperty(
+                "dpi_stages", stagesValue(),
+                [device](const QVariant &value) {
+                    /* Only the enabled stages get sent to the device */
+                    QVariantList list = value.toList();
+                    QVector<openrazer::DPI> stages;
+                    for (int i = 1; i < list.size(); i++) {
+                        openrazer::DPI dpi = pointToDpi(list[i].toPoint());
+                        if (dpi.dpi_x != 0 && dpi.dpi_y != 0)
+                            stages.append(dpi);
+                    }
+                    device->setDPIStages(list[0].toInt(), stages);
+                },
+                [=](const QVariant &value) {
+                    QVariantList list = value.toList();
+                    for (int i = 1; i < list.size() && i <= dpiStageWidgets.size(); i++) {
+                        dpiStageWidgets[i - 1]->setDpi(pointToDpi(list[i].toPoint()));
+                    }
+                    handleStageUpdates();
+
+                    activeStage = list[0].toInt();
+                    for (DpiStageWidget *widget : dpiStageWidgets) {
+                        widget->informStageActive(activeStage);
+                    }
+                });
+        writer->addProperty(
+                "dpi", QVariant(),
+                [device](const QVariant &value) {
+                    device->setDPI(pointToDpi(value.toPoint()));
+                },
+                [=](const QVariant &value) {
+                    if (value.isValid())
+                        dpiStageWidgets[0]->setDpi(pointToDpi(value.toPoint()));
+                });
+
+        connect(stateWatcher, &DeviceStateWatcher::dpiStagesChanged, this, &DpiSliderWidget::updateDpiStages);
+        connect(stateWatcher, &DeviceStateWatcher::dpiChanged, this, [=](openrazer::DPI dpi) {
+            /* The plain DPI is only what the user controls in single stage mode */
+            if (!singleStage || writer->isBusy("dpi"))
+                return;
+            dpiStageWidgets[0]->setDpi(dpi);
+            writer->setAcknowledgedValue("dpi", dpiToPoint(dpi));
+        });
     } else {
-        openrazer::DPI currentDpi = { 0, 0 };
-        try {
-            currentDpi = device->getDPI();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get dpi");
-        }
+        openrazer::DPI currentDpi = state.settings.dpi;
 
         // Assume user wants DPI synced if both values are currently equal
         bool isSynced = currentDpi.dpi_x == currentDpi.dpi_y;
@@ -159,7 +210,23 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
         stageWidget->setSingleStage(true);
         stageWidget->setSyncDpi(isSynced);
         connect(stageWidget, &DpiStageWidget::dpiChanged, this, [=](int /*stageNumber*/, openrazer::DPI dpi) {
-            device->setDPI(dpi);
+            writer->setValue("dpi", dpiToPoint(dpi));
+        });
+
+        writer->addProperty(
+                "dpi", dpiToPoint(currentDpi),
+                [device](const QVariant &value) {
+                    device->setDPI(pointToDpi(value.toPoint()));
+                },
+                [=](const QVariant &value) {
+                    stageWidget->setDpi(pointToDpi(value.toPoint()));
+                });
+
+        connect(stateWatcher, &DeviceStateWatcher::dpiChanged, this, [=](openrazer::DPI dpi) {
+            if (writer->isBusy("dpi"))
+                return;
+            stageWidget->setDpi(dpi);
+            writer->setAcknowledgedValue("dpi", dpiToPoint(dpi));
         });
 
         verticalLayout->addWidget(stageWidget);
@@ -168,6 +235,43 @@ DpiSliderWidget::DpiSliderWidget(QWidget *parent, libopenrazer::Device *device)
     }
 }
 
+void DpiSliderWidget::updateDpiStages(uchar activeStage, const QVector<openrazer::DPI> &dpiStages)
+{
+    if (singleStage || writer->isBusy("dpi_stages"))
+        return;
+
+    /* Keep the widgets as they are if only disabled stages would move around */
+    if (activeStage == this->activeStage && dpiStagesEqual(dpiStages, this->dpiStages))
+        return;
+
+    for (int i = 0; i < dpiStageWidgets.size(); i++) {
+        openrazer::DPI dpi = { 0, 0 };
+        if (i < dpiStages.size())
+            dpi = dpiStages[i];
+        dpiStageWidgets[i]->setDpi(dpi);
+    }
+    handleStageUpdates();
+
+    this->activeStage = activeStage;
+    for (DpiStageWidget *widget : qAsConst(dpiStageWidgets)) {
+        widget->informStageActive(activeStage);
+    }
+
+    writer->setAcknowledgedValue("dpi_stages", stagesValue());
+}
+
+/* Snapshot of the active stage followed by the DPI of every stage widget,
+ * including disabled ones so a failed write can be restored exactly */
+QVariant DpiSliderWidget::stagesValue()
+{
+    QVariantList list;
+    list.append(activeStage);
+    for (DpiStageWidget *stageWidget : qAsConst(dpiStageWidgets)) {
+        list.append(dpiToPoint(stageWidget->getDpi()));
+    }
+    return list;
+}
+
 void DpiSliderWidget::handleStageUpdates()
 {
     /* Re-number the stages to account for disabled stages, re-init dpiStages
@@ -13,11 +13,16 @@
 #include <QWidget>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+class PropertyWriter;
+struct PageState;
+
 class DpiSliderWidget : public QWidget
 {
     Q_OBJECT
 public:
-    DpiSliderWidget(QWidget *parent, libopenrazer::Device *device);
+    DpiSliderWidget(QWidget *parent, libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher);
 
 private:
     libopenrazer::Device *device;
@@ -29,7 +34,11 @@ private:
 
     QVector<DpiStageWidget *> dpiStageWidgets;
 
+    PropertyWriter *writer;
+
     void handleStageUpdates();
+    QVariant stagesValue();
+    void updateDpiStages(uchar activeStage, const QVector<openrazer::DPI> &dpiStages);
 };
 
 #endif // DPISLIDERWIDGET_H
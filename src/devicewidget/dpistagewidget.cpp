@@ -5,6 +5,7 @@
 #include "dpistagewidget.h"
 
 #include <QHBoxLayout>
+#include <QSignalBlocker>
 #include <QVBoxLayout>
 
 DpiStageWidget::DpiStageWidget(int initialStageNumber, int minimumDpi, int maximumDpi, openrazer::DPI currentDpi, bool activeStage, QWidget *parent)
@@ -194,6 +195,23 @@ openrazer::DPI DpiStageWidget::getDpi()
     return dpi;
 }
 
+void DpiStageWidget::setDpi(openrazer::DPI dpi)
+{
+    QSignalBlocker xBlocker(dpiXSlider);
+    QSignalBlocker yBlocker(dpiYSlider);
+
+    bool enabled = dpi.dpi_x != 0 && dpi.dpi_y != 0;
+    if (enabled) {
+        dpiXSlider->setValue(dpi.dpi_x / 100);
+        dpiYSlider->setValue(dpi.dpi_y / 100);
+        dpiXSpinBox->setValue(dpi.dpi_x);
+        dpiYSpinBox->setValue(dpi.dpi_y);
+    }
+
+    enableCheckBox->setChecked(enabled);
+    updateEnabled(enabled);
+}
+
 void DpiStageWidget::emitDpiChanged()
 {
     openrazer::DPI dpi = getDpi();
@@ -34,6 +34,9 @@ public:
     /* Return the currently selected DPI - if the stage is disabled then pass
      * the DPI {0,0} */
     openrazer::DPI getDpi();
+    /* Show the passed DPI without emitting dpiChanged - the DPI {0,0}
+     * disables the stage */
+    void setDpi(openrazer::DPI dpi);
 
 signals:
     /* The DPI of this stage have changed - if the stage is disabled then
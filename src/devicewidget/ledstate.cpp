@@ -0,0 +1,43 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ledstate.h"
+
+QVector<LedState> LedState::fetchAll(const QList<libopenrazer::Led *> &leds)
+{
+    QVector<LedState> states(leds.size());
+
+    for (int i = 0; i < leds.size(); i++) {
+        libopenrazer::Led *led = leds[i];
+        LedState &state = states[i];
+
+        try {
+            state.currentEffect = led->getCurrentEffect();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get current effect");
+        }
+        try {
+            state.currentColors = led->getCurrentColors();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get current colors");
+        }
+        for (const libopenrazer::Capability &ledFx : libopenrazer::ledFxList) {
+            try {
+                if (led->hasFx(ledFx.getIdentifier()))
+                    state.supportedFx.append(ledFx);
+            } catch (const libopenrazer::DBusException &e) {
+                qWarning("Failed to check for effect %s", qUtf8Printable(ledFx.getIdentifier()));
+            }
+        }
+        try {
+            state.hasBrightness = led->hasBrightness();
+            if (state.hasBrightness)
+                state.brightness = led->getBrightness();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get brightness");
+        }
+    }
+
+    return states;
+}
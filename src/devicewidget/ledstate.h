@@ -0,0 +1,26 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LEDSTATE_H
+#define LEDSTATE_H
+
+#include <QVector>
+#include <libopenrazer.h>
+
+/*
+ * Everything the lighting UI needs to know about an LED when it is built.
+ */
+struct LedState {
+    openrazer::Effect currentEffect = openrazer::Effect::Static;
+    QVector<openrazer::RGB> currentColors;
+    QVector<libopenrazer::Capability> supportedFx;
+    bool hasBrightness = false;
+    uchar brightness = 100;
+
+    /* Read the state of all passed LEDs. Talks to the daemon, so this is
+     * meant to run as a single read of the device in DeviceCommandQueue. */
+    static QVector<LedState> fetchAll(const QList<libopenrazer::Led *> &leds);
+};
+
+#endif // LEDSTATE_H
@@ -4,6 +4,9 @@
 
 #include "ledwidget.h"
 
+#include "devicestate.h"
+#include "devicestatewatcher.h"
+#include "propertywriter.h"
 #include "util.h"
 
 #include <QApplication>
@@ -13,13 +16,42 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QRadioButton>
+#include <QSignalBlocker>
+#include <QSlider>
 #include <stdexcept>
 
-LedWidget::LedWidget(QWidget *parent, libopenrazer::Led *led)
+/* Scrolling through the effects or picking colors only sends where the
+ * user stopped, in ms */
+static const int effectWriteInterval = 150;
+
+LedWidget::LedWidget(QWidget *parent, libopenrazer::Device *device, libopenrazer::Led *led, const LedState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher)
     : QWidget(parent)
 {
     this->mLed = led;
 
+    // LED writes share the queue of their device
+    writer = new PropertyWriter(commandQueue, device, this);
+    connect(writer, &PropertyWriter::writeFailed, this, [=](const QString &name) {
+        if (name == "brightness") {
+            qWarning("Failed to change brightness");
+            util::showError(tr("Failed to change brightness"), util::deviceCategory(device, "brightness"));
+        } else if (name == "effect") {
+            qWarning("Failed to change effect");
+            util::showError(tr("Failed to change effect"), util::deviceCategory(device, "effect"));
+        }
+    });
+
+    // Changes made by the user win over a device state read in the meantime
+    connect(writer, &PropertyWriter::busyChanged, stateWatcher, &DeviceStateWatcher::discardPendingRead);
+    connect(stateWatcher, &DeviceStateWatcher::ledEffectChanged, this, [=](libopenrazer::Led *changedLed, openrazer::Effect effect, const QVector<openrazer::RGB> &colors) {
+        if (changedLed == mLed)
+            updateEffect(effect, colors);
+    });
+    connect(stateWatcher, &DeviceStateWatcher::ledBrightnessChanged, this, [=](libopenrazer::Led *changedLed, uchar brightness) {
+        if (changedLed == mLed)
+            updateBrightness(brightness);
+    });
+
     auto *verticalLayout = new QVBoxLayout(this);
 
     // Set appropriate text
@@ -37,27 +69,15 @@ LedWidget::LedWidget(QWidget *parent, libopenrazer::Led *led)
 
     // TODO Sync effects in comboboxes & colorStuff when the sync checkbox is active
 
-    openrazer::Effect currentEffect = openrazer::Effect::Static;
-    try {
-        currentEffect = led->getCurrentEffect();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get current effect");
-    }
-    QVector<openrazer::RGB> currentColors;
-    try {
-        currentColors = led->getCurrentColors();
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to get current colors");
-    }
+    openrazer::Effect currentEffect = state.currentEffect;
+    QVector<openrazer::RGB> currentColors = state.currentColors;
 
     // Add items from capabilities
-    for (auto ledFx : libopenrazer::ledFxList) {
-        if (led->hasFx(ledFx.getIdentifier())) {
-            comboBox->addItem(qApp->translate("libopenrazer", ledFx.getDisplayString()), QVariant::fromValue(ledFx));
-            // Set selection to current effect
-            if (ledFx.getIdentifier() == currentEffect) {
-                comboBox->setCurrentIndex(comboBox->count() - 1);
-            }
+    for (auto ledFx : state.supportedFx) {
+        comboBox->addItem(qApp->translate("libopenrazer", ledFx.getDisplayString()), QVariant::fromValue(ledFx));
+        // Set selection to current effect
+        if (ledFx.getIdentifier() == currentEffect) {
+            comboBox->setCurrentIndex(comboBox->count() - 1);
         }
     }
 
@@ -115,6 +135,30 @@ LedWidget::LedWidget(QWidget *parent, libopenrazer::Led *led)
                     applyEffect();
             });
         }
+
+        /* Shown while an effect change is on its way to the device */
+        auto *applyingLabel = new QLabel(tr("Applying..."), this);
+        applyingLabel->setEnabled(false);
+        QSizePolicy applyingSizePolicy = applyingLabel->sizePolicy();
+        applyingSizePolicy.setRetainSizeWhenHidden(true);
+        applyingLabel->setSizePolicy(applyingSizePolicy);
+        applyingLabel->hide();
+        lightingHBox->addWidget(applyingLabel);
+
+        connect(writer, &PropertyWriter::busyChanged, this, [=](const QString &name, bool busy) {
+            if (name == "effect")
+                applyingLabel->setVisible(busy);
+        });
+
+        writer->addProperty(
+                "effect", effectValue(currentEffect),
+                [led](const QVariant &value) {
+                    writeEffect(led, value);
+                },
+                [=](const QVariant &value) {
+                    restoreEffect(value);
+                },
+                effectWriteInterval);
     } else {
         // Otherwise delete comboBox again
         delete comboBox;
@@ -122,34 +166,33 @@ LedWidget::LedWidget(QWidget *parent, libopenrazer::Led *led)
     }
 
     /* Brightness slider */
-    if (led->hasBrightness()) {
+    if (state.hasBrightness) {
         auto *brightnessLabel = new QLabel(tr("Brightness"));
 
-        auto *brightnessSlider = new QSlider(Qt::Horizontal, this);
+        brightnessSlider = new QSlider(Qt::Horizontal, this);
         brightnessSlider->setMaximum(255);
 
-        auto *brightnessSliderValue = new QLabel;
+        brightnessSliderValue = new QLabel;
 
-        uchar brightness;
-        try {
-            brightness = led->getBrightness();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get brightness");
-            brightness = 100;
-        }
+        uchar brightness = state.brightness;
 
         brightnessSlider->setValue(brightness);
         brightnessSliderValue->setText(QString("%1%").arg(brightness * 100 / 255));
 
+        writer->addProperty(
+                "brightness", brightness,
+                [led](const QVariant &value) {
+                    led->setBrightness(value.toInt());
+                },
+                [=](const QVariant &value) {
+                    QSignalBlocker blocker(brightnessSlider);
+                    brightnessSlider->setValue(value.toInt());
+                    brightnessSliderValue->setText(QString("%1%").arg(value.toInt() * 100 / 255));
+                });
+
         connect(brightnessSlider, &QSlider::valueChanged, this, [=](int value) {
             brightnessSliderValue->setText(QString("%1%").arg(value * 100 / 255));
-
-            try {
-                mLed->setBrightness(value);
-            } catch (const libopenrazer::DBusException &e) {
-                qWarning("Failed to change brightness");
-                util::showError(tr("Failed to change brightness"));
-            }
+            writer->setValue("brightness", value);
         });
 
         verticalLayout->addWidget(brightnessLabel);
@@ -205,6 +248,20 @@ void LedWidget::fxComboboxChanged(int index)
     if (!isCustomEffect)
         sender->removeItem(sender->findText("Custom Effect"));
 
+    updateEffectControls(capability);
+
+    /* Actually go apply the effect in all cases, except for Custom Effect
+     * because there we handle this in the CustomEditor class */
+    if (!isCustomEffect) {
+        applyEffectStandardLoc(capability.getIdentifier());
+    } else {
+        // The custom editor takes over, so we don't know the device state anymore
+        writer->setAcknowledgedValue("effect", QVariant());
+    }
+}
+
+void LedWidget::updateEffectControls(const libopenrazer::Capability &capability)
+{
     // Show/hide the color buttons
     if (capability.getNumColors() == 0) { // hide all
         for (int i = 1; i <= 3; i++)
@@ -226,11 +283,6 @@ void LedWidget::fxComboboxChanged(int index)
         findChild<QRadioButton *>("radiobutton1")->show();
         findChild<QRadioButton *>("radiobutton2")->show();
     }
-
-    /* Actually go apply the effect in all cases, except for Custom Effect
-     * because there we handle this in the CustomEditor class */
-    if (!isCustomEffect)
-        applyEffectStandardLoc(capability.getIdentifier());
 }
 
 openrazer::RGB LedWidget::getColorForButton(int num)
@@ -254,78 +306,120 @@ openrazer::WheelDirection LedWidget::getWheelDirection()
 
 void LedWidget::applyEffectStandardLoc(openrazer::Effect effect)
 {
-    try {
-        switch (effect) {
-        case openrazer::Effect::Off: {
-            mLed->setOff();
-            break;
-        }
-        case openrazer::Effect::On: {
-            mLed->setOn();
-            break;
-        }
-        case openrazer::Effect::Static: {
-            openrazer::RGB c = getColorForButton(1);
-            mLed->setStatic(c);
-            break;
-        }
-        case openrazer::Effect::Breathing: {
-            openrazer::RGB c = getColorForButton(1);
-            mLed->setBreathing(c);
-            break;
-        }
-        case openrazer::Effect::BreathingDual: {
-            openrazer::RGB c1 = getColorForButton(1);
-            openrazer::RGB c2 = getColorForButton(2);
-            mLed->setBreathingDual(c1, c2);
-            break;
-        }
-        case openrazer::Effect::BreathingRandom: {
-            mLed->setBreathingRandom();
-            break;
-        }
-        case openrazer::Effect::BreathingMono: {
-            mLed->setBreathingMono();
-            break;
-        }
-        case openrazer::Effect::Blinking: {
-            openrazer::RGB c = getColorForButton(1);
-            mLed->setBlinking(c);
-            break;
-        }
-        case openrazer::Effect::Spectrum: {
-            mLed->setSpectrum();
-            break;
-        }
-        case openrazer::Effect::Wave: {
-            mLed->setWave(getWaveDirection());
-            break;
-        }
-        case openrazer::Effect::Wheel: {
-            mLed->setWheel(getWheelDirection());
-            break;
-        }
-        case openrazer::Effect::Reactive: {
-            openrazer::RGB c = getColorForButton(1);
-            mLed->setReactive(c, openrazer::ReactiveSpeed::_500MS); // TODO Configure speed?
-            break;
-        }
-        case openrazer::Effect::Ripple: {
-            openrazer::RGB c = getColorForButton(1);
-            mLed->setRipple(c);
+    /* Replaces any effect that hasn't been sent to the device yet, so only
+     * the last selection gets applied */
+    writer->setValue("effect", effectValue(effect));
+}
+
+/*
+ * Snapshot of everything needed to apply an effect, so the write can happen
+ * without touching any widgets.
+ */
+QVariant LedWidget::effectValue(openrazer::Effect effect)
+{
+    QVariantList colors;
+    for (int i = 1; i <= 3; i++) {
+        QPalette pal = findChild<QPushButton *>("colorbutton" + QString::number(i))->palette();
+        colors.append(pal.color(QPalette::Button));
+    }
+
+    QVariantMap value;
+    value.insert("effect", static_cast<int>(effect));
+    value.insert("colors", colors);
+    value.insert("direction", findChild<QRadioButton *>("radiobutton1")->isChecked());
+    return value;
+}
+
+void LedWidget::restoreEffect(const QVariant &value)
+{
+    if (!value.isValid())
+        return;
+
+    QVariantMap map = value.toMap();
+    auto effect = static_cast<openrazer::Effect>(map.value("effect").toInt());
+
+    auto *combobox = findChild<QComboBox *>("combobox");
+    for (int i = 0; i < combobox->count(); i++) {
+        libopenrazer::Capability capability = combobox->itemData(i).value<libopenrazer::Capability>();
+        if (capability.getIdentifier() == effect && combobox->itemText(i) != "Custom Effect") {
+            QSignalBlocker blocker(combobox);
+            combobox->setCurrentIndex(i);
+            updateEffectControls(capability);
             break;
         }
-        case openrazer::Effect::RippleRandom: {
-            mLed->setRippleRandom();
+    }
+
+    QVariantList colors = map.value("colors").toList();
+    for (int i = 1; i <= colors.size(); i++) {
+        auto *colorButton = findChild<QPushButton *>("colorbutton" + QString::number(i));
+        QPalette pal = colorButton->palette();
+        pal.setColor(QPalette::Button, colors[i - 1].value<QColor>());
+        colorButton->setPalette(pal);
+    }
+
+    bool direction = map.value("direction").toBool();
+    auto *radio = findChild<QRadioButton *>(direction ? "radiobutton1" : "radiobutton2");
+    QSignalBlocker blocker(radio);
+    radio->setChecked(true);
+}
+
+void LedWidget::updateEffect(openrazer::Effect effect, const QVector<openrazer::RGB> &colors)
+{
+    // Don't overwrite a change the user has just made
+    if (writer->isBusy("effect"))
+        return;
+
+    auto *combobox = findChild<QComboBox *>("combobox");
+    if (combobox == nullptr)
+        return;
+
+    for (int i = 0; i < combobox->count(); i++) {
+        libopenrazer::Capability capability = combobox->itemData(i).value<libopenrazer::Capability>();
+        if (capability.getIdentifier() == effect && combobox->itemText(i) != "Custom Effect") {
+            QSignalBlocker blocker(combobox);
+            combobox->setCurrentIndex(i);
+            combobox->removeItem(combobox->findText("Custom Effect"));
+            updateEffectControls(capability);
             break;
         }
-        default:
-            throw new std::invalid_argument("Effect not handled: " + QVariant::fromValue(effect).toString().toStdString());
-        }
-    } catch (const libopenrazer::DBusException &e) {
-        qWarning("Failed to change effect");
-        util::showError(tr("Failed to change effect"));
     }
+
+    for (int i = 1; i <= 3 && i <= colors.size(); i++) {
+        openrazer::RGB color = colors.at(i - 1);
+        auto *colorButton = findChild<QPushButton *>("colorbutton" + QString::number(i));
+        QPalette pal = colorButton->palette();
+        pal.setColor(QPalette::Button, { color.r, color.g, color.b });
+        colorButton->setPalette(pal);
+    }
+
+    writer->setAcknowledgedValue("effect", effectValue(effect));
+}
+
+void LedWidget::updateBrightness(uchar brightness)
+{
+    if (brightnessSlider == nullptr || writer->isBusy("brightness"))
+        return;
+
+    QSignalBlocker blocker(brightnessSlider);
+    brightnessSlider->setValue(brightness);
+    brightnessSliderValue->setText(QString("%1%").arg(brightness * 100 / 255));
+
+    writer->setAcknowledgedValue("brightness", brightness);
+}
+
+void LedWidget::writeEffect(libopenrazer::Led *led, const QVariant &value)
+{
+    QVariantMap map = value.toMap();
+    auto effect = static_cast<openrazer::Effect>(map.value("effect").toInt());
+
+    QVector<openrazer::RGB> colors;
+    for (const QVariant &colorVariant : map.value("colors").toList()) {
+        QColor color = colorVariant.value<QColor>();
+        colors.append(QCOLOR_TO_RGB(color));
+    }
+
+    // Mirrors getWaveDirection() and getWheelDirection()
+    LedSettings::applyEffect(led, effect, colors, map.value("direction").toBool());
 }
 
 void LedWidget::applyEffect()
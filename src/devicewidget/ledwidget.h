@@ -5,14 +5,22 @@
 #ifndef LEDWIDGET_H
 #define LEDWIDGET_H
 
+#include "ledstate.h"
+
 #include <QWidget>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+class PropertyWriter;
+class QLabel;
+class QSlider;
+
 class LedWidget : public QWidget
 {
     Q_OBJECT
 public:
-    LedWidget(QWidget *parent, libopenrazer::Led *led);
+    LedWidget(QWidget *parent, libopenrazer::Device *device, libopenrazer::Led *led, const LedState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher);
     libopenrazer::Led *mLed;
     libopenrazer::Led *led();
 
@@ -27,6 +35,20 @@ public:
 
     void applyEffect();
     void applyEffectStandardLoc(openrazer::Effect identifier);
+
+    /* Show a state that was changed outside of RazerGenie */
+    void updateEffect(openrazer::Effect effect, const QVector<openrazer::RGB> &colors);
+    void updateBrightness(uchar brightness);
+
+private:
+    PropertyWriter *writer;
+    QSlider *brightnessSlider = nullptr;
+    QLabel *brightnessSliderValue = nullptr;
+
+    void updateEffectControls(const libopenrazer::Capability &capability);
+    QVariant effectValue(openrazer::Effect effect);
+    void restoreEffect(const QVariant &value);
+    static void writeEffect(libopenrazer::Led *led, const QVariant &value);
 };
 
 #endif // LEDWIDGET_H
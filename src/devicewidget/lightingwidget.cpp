@@ -6,6 +6,7 @@
 
 #include "clickeventfilter.h"
 #include "customeditor/customeditor.h"
+#include "devicecommandqueue.h"
 #include "ledwidget.h"
 
 #include <QComboBox>
@@ -13,10 +14,13 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 
-LightingWidget::LightingWidget(libopenrazer::Device *device)
+LightingWidget::LightingWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher)
     : QWidget()
 {
     this->device = device;
+    this->commandQueue = commandQueue;
+    pageState = state;
+    ledsLoaded = device->getLeds().isEmpty();
 
     auto *verticalLayout = new QVBoxLayout(this);
 
@@ -26,9 +30,26 @@ LightingWidget::LightingWidget(libopenrazer::Device *device)
     lightingHeader->setFont(headerFont);
     verticalLayout->addWidget(lightingHeader);
 
-    /* Create LedWidget for all LEDs */
-    for (libopenrazer::Led *led : device->getLeds()) {
-        verticalLayout->addWidget(new LedWidget(this, led));
+    /* Create LedWidget for all LEDs once their state has been read */
+    auto *ledLayout = new QVBoxLayout();
+    verticalLayout->addLayout(ledLayout);
+    if (!device->getLeds().isEmpty()) {
+        QLabel *ledPlaceholder = new QLabel(tr("Reading the lighting state..."), this);
+        ledLayout->addWidget(ledPlaceholder);
+        commandQueue->read<QVector<LedState>>(
+                device, this, [=]() { return LedState::fetchAll(device->getLeds()); },
+                [=](const QVector<LedState> &states) {
+                    delete ledPlaceholder;
+                    QList<libopenrazer::Led *> leds = device->getLeds();
+                    for (int i = 0; i < leds.size() && i < states.size(); i++) {
+                        ledLayout->addWidget(new LedWidget(this, device, leds[i], states[i], commandQueue, stateWatcher));
+                    }
+                    ledsLoaded = true;
+                    emit loaded();
+                },
+                [=](const QString & /* error */) {
+                    ledPlaceholder->setText(tr("Failed to read the lighting state."));
+                });
     }
 
     /* Custom lighting */
@@ -60,6 +81,11 @@ bool LightingWidget::isAvailable(libopenrazer::Device *device)
     return !device->getLeds().isEmpty() || device->hasFeature("custom_frame");
 }
 
+bool LightingWidget::isLoaded() const
+{
+    return ledsLoaded;
+}
+
 void LightingWidget::openCustomEditor(bool forceFallback)
 {
     /* Set combobox(es) to "Custom Effect" */
@@ -70,7 +96,7 @@ void LightingWidget::openCustomEditor(bool forceFallback)
         combobox->setCurrentText("Custom Effect");
     }
 
-    auto *cust = new CustomEditor(device, forceFallback);
+    auto *cust = new CustomEditor(device, commandQueue, pageState, forceFallback);
     cust->setAttribute(Qt::WA_DeleteOnClose);
     cust->show();
 }
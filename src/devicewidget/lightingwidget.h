@@ -5,20 +5,35 @@
 #ifndef LIGHTINGWIDGET_H
 #define LIGHTINGWIDGET_H
 
+#include "pagestate.h"
+
 #include <QWidget>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+
 class LightingWidget : public QWidget
 {
     Q_OBJECT
 public:
-    LightingWidget(libopenrazer::Device *device);
+    LightingWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher);
     ~LightingWidget() override;
 
     static bool isAvailable(libopenrazer::Device *device);
+    /* False until the LEDs have been added, see loaded() */
+    bool isLoaded() const;
+
+signals:
+    /* The LEDs were added once their state was read */
+    void loaded();
 
 private:
     libopenrazer::Device *device;
+    DeviceCommandQueue *commandQueue;
+    /* Kept for the custom editor */
+    PageState pageState;
+    bool ledsLoaded;
 
     void openCustomEditor(bool forceFallback);
 };
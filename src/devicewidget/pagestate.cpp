@@ -0,0 +1,46 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "pagestate.h"
+
+PageState PageState::read(libopenrazer::Device *device)
+{
+    PageState state;
+
+    // Without a name there's nothing to show, let this one fail the read
+    state.deviceName = device->getDeviceName();
+    state.settings = DeviceState::readDeviceSettings(device);
+
+    if (device->hasFeature("poll_rate")) {
+        try {
+            state.supportedPollRates = device->getSupportedPollRates();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get supported poll rates");
+        }
+    }
+
+    if (device->hasFeature("dpi")) {
+        try {
+            if (device->hasFeature("restricted_dpi"))
+                state.allowedDpi = device->getAllowedDPI();
+            else
+                state.maxDpi = device->maxDPI();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get the DPI range");
+        }
+    }
+
+    if (device->hasFeature("custom_frame")) {
+        try {
+            state.matrixDimensions = device->getMatrixDimensions();
+            state.deviceType = device->getDeviceType();
+            if (state.deviceType == "keyboard")
+                state.keyboardLayout = device->getKeyboardLayout();
+        } catch (const libopenrazer::DBusException &e) {
+            qWarning("Failed to get the custom frame layout");
+        }
+    }
+
+    return state;
+}
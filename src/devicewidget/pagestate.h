@@ -0,0 +1,37 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PAGESTATE_H
+#define PAGESTATE_H
+
+#include "devicestate.h"
+
+#include <QString>
+#include <QVector>
+#include <libopenrazer.h>
+
+/*
+ * Everything a device page shows when it is built. It is read in one go
+ * through the command queue, so building the page doesn't wait for the
+ * daemon.
+ */
+struct PageState {
+    QString deviceName;
+    /* Only the device level settings, the lighting widget reads the LEDs
+     * itself, see LedState */
+    DeviceState settings;
+    QVector<ushort> supportedPollRates;
+    QVector<ushort> allowedDpi;
+    int maxDpi = 0;
+
+    /* What the custom editor needs, only read for devices with custom frames */
+    openrazer::MatrixDimensions matrixDimensions = { 0, 0 };
+    QString deviceType;
+    QString keyboardLayout;
+
+    /* Blocks, call it through the command queue */
+    static PageState read(libopenrazer::Device *device);
+};
+
+#endif // PAGESTATE_H
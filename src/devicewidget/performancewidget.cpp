@@ -4,15 +4,19 @@
 
 #include "performancewidget.h"
 
+#include "devicecommandqueue.h"
+#include "devicestatewatcher.h"
 #include "dpicomboboxwidget.h"
 #include "dpisliderwidget.h"
+#include "pagestate.h"
 #include "util.h"
 
 #include <QComboBox>
 #include <QLabel>
+#include <QSignalBlocker>
 #include <QVBoxLayout>
 
-PerformanceWidget::PerformanceWidget(libopenrazer::Device *device)
+PerformanceWidget::PerformanceWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher)
     : QWidget()
 {
     this->device = device;
@@ -24,9 +28,9 @@ PerformanceWidget::PerformanceWidget(libopenrazer::Device *device)
     /* DPI sliders */
     if (device->hasFeature("dpi")) {
         if (device->hasFeature("restricted_dpi")) {
-            verticalLayout->addWidget(new DpiComboBoxWidget(this, device));
+            verticalLayout->addWidget(new DpiComboBoxWidget(this, device, state, commandQueue, stateWatcher));
         } else {
-            verticalLayout->addWidget(new DpiSliderWidget(this, device));
+            verticalLayout->addWidget(new DpiSliderWidget(this, device, state, commandQueue, stateWatcher));
         }
     }
 
@@ -36,34 +40,31 @@ PerformanceWidget::PerformanceWidget(libopenrazer::Device *device)
         pollRateHeader->setFont(headerFont);
         verticalLayout->addWidget(pollRateHeader);
 
-        ushort pollRate = 0;
-        try {
-            pollRate = device->getPollRate();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get poll rate");
-        }
-
-        QVector<ushort> supportedPollRates;
-        try {
-            supportedPollRates = device->getSupportedPollRates();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get supported poll rates");
-        }
-
         auto *pollComboBox = new QComboBox;
-        for (ushort poll : supportedPollRates) {
+        for (ushort poll : state.supportedPollRates) {
             pollComboBox->addItem(QString::number(poll) + " Hz", poll);
         }
-        pollComboBox->setCurrentText(QString::number(pollRate) + " Hz");
+        pollComboBox->setCurrentText(QString::number(state.settings.pollRate) + " Hz");
         verticalLayout->addWidget(pollComboBox);
 
         connect(pollComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int) {
-            try {
-                device->setPollRate(pollComboBox->currentData().value<ushort>());
-            } catch (const libopenrazer::DBusException &e) {
-                qWarning("Failed to set polling rate");
-                util::showError(tr("Failed to set polling rate"));
-            }
+            ushort pollRate = pollComboBox->currentData().value<ushort>();
+            // A state read in the meantime might not include the new value yet
+            stateWatcher->discardPendingRead();
+            commandQueue->write(
+                    device, this, [=]() { device->setPollRate(pollRate); },
+                    [=](bool success) {
+                        stateWatcher->discardPendingRead();
+                        if (!success) {
+                            qWarning("Failed to set polling rate");
+                            util::showError(tr("Failed to set polling rate"), util::deviceCategory(device, "poll_rate"));
+                        }
+                    });
+        });
+
+        connect(stateWatcher, &DeviceStateWatcher::pollRateChanged, this, [=](ushort pollRate) {
+            QSignalBlocker blocker(pollComboBox);
+            pollComboBox->setCurrentText(QString::number(pollRate) + " Hz");
         });
     }
 
@@ -8,11 +8,15 @@
 #include <QWidget>
 #include <libopenrazer.h>
 
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+struct PageState;
+
 class PerformanceWidget : public QWidget
 {
     Q_OBJECT
 public:
-    PerformanceWidget(libopenrazer::Device *device);
+    PerformanceWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher);
     ~PerformanceWidget() override;
 
     static bool isAvailable(libopenrazer::Device *device);
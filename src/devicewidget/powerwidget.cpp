@@ -4,18 +4,36 @@
 
 #include "powerwidget.h"
 
+#include "battery/batterymonitor.h"
+#include "batterygraphwidget.h"
+#include "devicestatewatcher.h"
+#include "pagestate.h"
+#include "propertywriter.h"
 #include "util.h"
 
 #include <QLabel>
 #include <QProgressBar>
+#include <QSignalBlocker>
 #include <QSlider>
 #include <QVBoxLayout>
 
-PowerWidget::PowerWidget(libopenrazer::Device *device)
+PowerWidget::PowerWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher, BatteryMonitor *batteryMonitor)
     : QWidget()
 {
     this->device = device;
 
+    writer = new PropertyWriter(commandQueue, device, this);
+    connect(writer, &PropertyWriter::writeFailed, this, [=](const QString &name) {
+        if (name == "idle_time") {
+            qWarning("Failed to set idle time");
+            util::showError(tr("Failed to set idle time"), util::deviceCategory(device, "idle_time"));
+        } else if (name == "low_battery_threshold") {
+            qWarning("Failed to set low battery threshold");
+            util::showError(tr("Failed to set low battery threshold"), util::deviceCategory(device, "low_battery_threshold"));
+        }
+    });
+    connect(writer, &PropertyWriter::busyChanged, stateWatcher, &DeviceStateWatcher::discardPendingRead);
+
     auto *verticalLayout = new QVBoxLayout(this);
 
     QFont headerFont("Arial", 15, QFont::Bold);
@@ -27,19 +45,7 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
         QLabel *batterHeader = new QLabel(tr("Battery"), this);
         batterHeader->setFont(headerFont);
 
-        bool charging = false;
-        try {
-            charging = device->isCharging();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get charging status");
-        }
-
         QLabel *chargingLabel = new QLabel(this);
-        if (charging) {
-            chargingLabel->setText(tr("Charging"));
-        } else {
-            chargingLabel->setText(tr("Not Charging"));
-        }
 
         batteryHeaderHBox->addWidget(batterHeader);
         batteryHeaderHBox->addItem(new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum));
@@ -47,17 +53,49 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
 
         verticalLayout->addLayout(batteryHeaderHBox);
 
-        double percent = 0.0;
-        try {
-            percent = device->getBatteryPercent();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get battery charge percentage");
-        }
-
         auto *progressBar = new QProgressBar;
-        progressBar->setValue(percent);
-
         verticalLayout->addWidget(progressBar);
+
+        QLabel *estimateLabel = new QLabel(this);
+        verticalLayout->addWidget(estimateLabel);
+
+        auto *graph = new BatteryGraphWidget(this);
+        verticalLayout->addWidget(graph);
+
+        // Everything shown here comes from the samples of the battery monitor
+        auto updateBattery = [=]() {
+            const BatteryHistory *history = batteryMonitor->history(device);
+            graph->setHistory(history);
+            if (history == nullptr || history->count() == 0) {
+                chargingLabel->setText(QString());
+                progressBar->setValue(0);
+                estimateLabel->setText(tr("Reading battery status..."));
+                return;
+            }
+
+            BatterySample sample = history->last();
+            chargingLabel->setText(sample.charging ? tr("Charging") : tr("Not Charging"));
+            progressBar->setValue(qRound(sample.percent()));
+
+            BatteryEstimate estimate = history->estimate();
+            if (sample.charging) {
+                estimateLabel->setText(QString());
+            } else if (estimate.valid) {
+                qint64 minutes = estimate.secondsRemaining / 60;
+                estimateLabel->setText(tr("About %1 h %2 min remaining (%3% per hour)")
+                                               .arg(minutes / 60)
+                                               .arg(minutes % 60, 2, 10, QChar('0'))
+                                               .arg(estimate.dischargeRate, 0, 'f', 1));
+            } else {
+                estimateLabel->setText(tr("Estimating time remaining..."));
+            }
+        };
+        updateBattery();
+
+        connect(batteryMonitor, &BatteryMonitor::sampleAdded, this, [=](libopenrazer::Device *sampledDevice) {
+            if (sampledDevice == device)
+                updateBattery();
+        });
     }
 
     /* Idle time / Sleep mode after */
@@ -66,12 +104,7 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
         idleTimeHeader->setFont(headerFont);
         verticalLayout->addWidget(idleTimeHeader);
 
-        ushort idleTimeSec = 0;
-        try {
-            idleTimeSec = device->getIdleTime();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get idle time");
-        }
+        ushort idleTimeSec = state.settings.idleTime;
 
         auto *idleTimeHBox = new QHBoxLayout();
 
@@ -86,15 +119,29 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
         auto *idleTimeLabel = new QLabel(this);
         idleTimeLabel->setText(tr("%1 minutes").arg(idleTimeSec / 60));
 
+        writer->addProperty(
+                "idle_time", idleTimeSec / 60,
+                [device](const QVariant &value) {
+                    device->setIdleTime(value.toInt() * 60);
+                },
+                [=](const QVariant &value) {
+                    QSignalBlocker blocker(idleTimeSlider);
+                    idleTimeSlider->setValue(value.toInt());
+                    idleTimeLabel->setText(tr("%1 minutes").arg(value.toInt()));
+                });
+
         connect(idleTimeSlider, &QSlider::valueChanged, this, [=](int idleTimeMin) {
             idleTimeLabel->setText(tr("%1 minutes").arg(idleTimeMin));
+            writer->setValue("idle_time", idleTimeMin);
+        });
 
-            try {
-                device->setIdleTime(idleTimeMin * 60);
-            } catch (const libopenrazer::DBusException &e) {
-                qWarning("Failed to set idle time");
-                util::showError(tr("Failed to set idle time"));
-            }
+        connect(stateWatcher, &DeviceStateWatcher::idleTimeChanged, this, [=](ushort idleTime) {
+            if (writer->isBusy("idle_time"))
+                return;
+            QSignalBlocker blocker(idleTimeSlider);
+            idleTimeSlider->setValue(idleTime / 60);
+            idleTimeLabel->setText(tr("%1 minutes").arg(idleTime / 60));
+            writer->setAcknowledgedValue("idle_time", idleTime / 60);
         });
 
         idleTimeHBox->addWidget(idleTimeSlider);
@@ -108,12 +155,7 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
         lowBatteryThresholdHeader->setFont(headerFont);
         verticalLayout->addWidget(lowBatteryThresholdHeader);
 
-        ushort threshold = 0;
-        try {
-            threshold = device->getLowBatteryThreshold();
-        } catch (const libopenrazer::DBusException &e) {
-            qWarning("Failed to get low battery threshold");
-        }
+        ushort threshold = state.settings.lowBatteryThreshold;
 
         auto *lowBatteryThresholdHBox = new QHBoxLayout();
 
@@ -125,15 +167,29 @@ PowerWidget::PowerWidget(libopenrazer::Device *device)
         auto *lowBatteryThresholdLabel = new QLabel(this);
         lowBatteryThresholdLabel->setText(QString("%1%").arg(threshold));
 
+        writer->addProperty(
+                "low_battery_threshold", threshold,
+                [device](const QVariant &value) {
+                    device->setLowBatteryThreshold(value.toInt());
+                },
+                [=](const QVariant &value) {
+                    QSignalBlocker blocker(lowBatteryThresholdSlider);
+                    lowBatteryThresholdSlider->setValue(value.toInt());
+                    lowBatteryThresholdLabel->setText(QString("%1%").arg(value.toInt()));
+                });
+
         connect(lowBatteryThresholdSlider, &QSlider::valueChanged, this, [=](int threshold) {
             lowBatteryThresholdLabel->setText(QString("%1%").arg(threshold));
+            writer->setValue("low_battery_threshold", threshold);
+        });
 
-            try {
-                device->setLowBatteryThreshold(threshold);
-            } catch (const libopenrazer::DBusException &e) {
-                qWarning("Failed to set low battery threshold");
-                util::showError(tr("Failed to set low battery threshold"));
-            }
+        connect(stateWatcher, &DeviceStateWatcher::lowBatteryThresholdChanged, this, [=](uchar threshold) {
+            if (writer->isBusy("low_battery_threshold"))
+                return;
+            QSignalBlocker blocker(lowBatteryThresholdSlider);
+            lowBatteryThresholdSlider->setValue(threshold);
+            lowBatteryThresholdLabel->setText(QString("%1%").arg(threshold));
+            writer->setAcknowledgedValue("low_battery_threshold", threshold);
         });
 
         lowBatteryThresholdHBox->addWidget(lowBatteryThresholdSlider);
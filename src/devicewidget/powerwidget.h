@@ -8,17 +8,24 @@
 #include <QWidget>
 #include <libopenrazer.h>
 
+class BatteryMonitor;
+class DeviceCommandQueue;
+class DeviceStateWatcher;
+class PropertyWriter;
+struct PageState;
+
 class PowerWidget : public QWidget
 {
     Q_OBJECT
 public:
-    PowerWidget(libopenrazer::Device *device);
+    PowerWidget(libopenrazer::Device *device, const PageState &state, DeviceCommandQueue *commandQueue, DeviceStateWatcher *stateWatcher, BatteryMonitor *batteryMonitor);
     ~PowerWidget() override;
 
     static bool isAvailable(libopenrazer::Device *device);
 
 private:
     libopenrazer::Device *device;
+    PropertyWriter *writer;
 };
 
 #endif // POWERWIDGET_H
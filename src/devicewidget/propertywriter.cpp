@@ -0,0 +1,128 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "propertywriter.h"
+
+#include "devicecommandqueue.h"
+
+#include <QTimer>
+
+PropertyWriter::PropertyWriter(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, QObject *parent)
+    : QObject(parent)
+{
+    this->commandQueue = commandQueue;
+    this->device = device;
+}
+
+PropertyWriter::~PropertyWriter()
+{
+    qDeleteAll(properties);
+}
+
+void PropertyWriter::addProperty(const QString &name, const QVariant &acknowledgedValue, WriteFunction write, RestoreFunction restore, int interval)
+{
+    auto *property = new Property;
+    property->write = write;
+    property->restore = restore;
+    property->acknowledged = acknowledgedValue;
+
+    if (interval > 0) {
+        property->timer = new QTimer(this);
+        property->timer->setSingleShot(true);
+        property->timer->setInterval(interval);
+        connect(property->timer, &QTimer::timeout, this, [=]() {
+            // A write that is still running picks up the pending value once it's done
+            if (property->hasPending && !property->inFlight)
+                dispatch(name);
+        });
+    }
+
+    Property *old = properties.value(name);
+    if (old != nullptr)
+        delete old->timer;
+    delete old;
+    properties.insert(name, property);
+}
+
+void PropertyWriter::setValue(const QString &name, const QVariant &value)
+{
+    Property *property = properties.value(name);
+    if (property == nullptr) {
+        qWarning("PropertyWriter: Unknown property %s", qUtf8Printable(name));
+        return;
+    }
+
+    bool wasBusy = property->hasPending || property->inFlight;
+
+    property->pending = value;
+    property->hasPending = true;
+
+    if (!wasBusy)
+        emit busyChanged(name, true);
+
+    // A write that is still running picks up the pending value once it's done
+    if (property->timer != nullptr)
+        property->timer->start();
+    else if (!property->inFlight)
+        dispatch(name);
+}
+
+void PropertyWriter::setAcknowledgedValue(const QString &name, const QVariant &value)
+{
+    Property *property = properties.value(name);
+    if (property == nullptr)
+        return;
+    property->acknowledged = value;
+}
+
+bool PropertyWriter::isBusy(const QString &name) const
+{
+    Property *property = properties.value(name);
+    if (property == nullptr)
+        return false;
+    return property->hasPending || property->inFlight;
+}
+
+void PropertyWriter::dispatch(const QString &name)
+{
+    Property *property = properties.value(name);
+
+    QVariant value = property->pending;
+    property->hasPending = false;
+
+    // Nothing to do if the device already has this value
+    if (value == property->acknowledged) {
+        emit busyChanged(name, false);
+        return;
+    }
+
+    property->inFlight = true;
+
+    WriteFunction write = property->write;
+    commandQueue->write(device, this, [=]() { write(value); }, [=](bool success) {
+        if (!success)
+            qWarning("PropertyWriter: Failed to write %s", qUtf8Printable(name));
+        writeFinished(name, value, success);
+    });
+}
+
+void PropertyWriter::writeFinished(const QString &name, const QVariant &value, bool success)
+{
+    Property *property = properties.value(name);
+    property->inFlight = false;
+
+    if (success) {
+        property->acknowledged = value;
+    } else {
+        // Only jump back if the user hasn't moved on to another value already
+        if (!property->hasPending)
+            property->restore(property->acknowledged);
+        emit writeFailed(name);
+    }
+
+    if (property->hasPending && (property->timer == nullptr || !property->timer->isActive()))
+        dispatch(name);
+    else if (!property->hasPending)
+        emit busyChanged(name, false);
+}
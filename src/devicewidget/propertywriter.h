@@ -0,0 +1,77 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROPERTYWRITER_H
+#define PROPERTYWRITER_H
+
+#include <QHash>
+#include <QObject>
+#include <QVariant>
+#include <functional>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+class QTimer;
+
+/*
+ * Writes device properties that are driven by sliders and similar controls.
+ *
+ * A value is sent right away when nothing is being written for the
+ * property. While a write is in flight, new values replace each other and
+ * only the latest one is sent once the write is done, so at most one write
+ * per property is in flight at any time and the device follows a dragged
+ * slider as fast as it can answer. Properties registered with an interval
+ * are sent on the trailing edge instead: only once no new value came in for
+ * that long, for values where intermediate ones aren't worth a write of
+ * their own. Writes go through the command queue of
+ * the device so the UI never waits for the daemon. When a write fails, the
+ * restore function is called with the last value that was acknowledged by
+ * the device.
+ */
+class PropertyWriter : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<void(const QVariant &)> WriteFunction;
+    typedef std::function<void(const QVariant &)> RestoreFunction;
+
+    PropertyWriter(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, QObject *parent = nullptr);
+    ~PropertyWriter() override;
+
+    /* Register a property with its current value on the device. With an
+     * interval in ms, values are only sent once the changes paused that long. */
+    void addProperty(const QString &name, const QVariant &acknowledgedValue, WriteFunction write, RestoreFunction restore, int interval = 0);
+    /* Send a new value for the property, or replace the one waiting for the
+     * running write */
+    void setValue(const QString &name, const QVariant &value);
+    /* Update the value known to be on the device, e.g. after it was changed
+     * elsewhere. An invalid QVariant marks the value as unknown. */
+    void setAcknowledgedValue(const QString &name, const QVariant &value);
+    /* Returns true while a value for the property is queued or being written */
+    bool isBusy(const QString &name) const;
+
+signals:
+    void writeFailed(const QString &name);
+    void busyChanged(const QString &name, bool busy);
+
+private:
+    struct Property {
+        WriteFunction write;
+        RestoreFunction restore;
+        QVariant acknowledged;
+        QVariant pending;
+        bool hasPending = false;
+        bool inFlight = false;
+        QTimer *timer = nullptr;
+    };
+
+    DeviceCommandQueue *commandQueue;
+    libopenrazer::Device *device;
+    QHash<QString, Property *> properties;
+
+    void dispatch(const QString &name);
+    void writeFinished(const QString &name, const QVariant &value, bool success);
+};
+
+#endif // PROPERTYWRITER_H
@@ -2,27 +2,52 @@
 //
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include "backgroundservices.h"
+#include "cli/commandline.h"
 #include "config.h"
+#include "memoryreport.h"
 #include "razergenie.h"
+#include "trayicon.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDebug>
 #include <QTranslator>
 
+static void setApplicationInfo()
+{
+    QCoreApplication::setApplicationName("RazerGenie");
+    QCoreApplication::setApplicationVersion(RAZERGENIE_VERSION);
+    QCoreApplication::setOrganizationName("razergenie"); // for QSettings
+}
+
 int main(int argc, char *argv[])
 {
+    // The subcommands don't need any of the GUI, keep them quick to start
+    if (CommandLine::isCommand(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        setApplicationInfo();
+        CommandLine commandLine;
+        return commandLine.exec(app.arguments());
+    }
+
     QApplication app(argc, argv);
-    QApplication::setApplicationName("RazerGenie");
-    QApplication::setApplicationVersion(RAZERGENIE_VERSION);
-    QApplication::setOrganizationName("razergenie"); // for QSettings
+    setApplicationInfo();
     QApplication::setDesktopFileName("xyz.z3ntu.razergenie");
 
     QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "Run \"razergenie list --help\" for the commands that work without a window."));
     parser.addHelpOption();
     parser.addVersionOption();
 
+    QCommandLineOption backgroundOption("background", QCoreApplication::translate("main", "Start in the system tray, the window gets opened from the tray icon."));
+    parser.addOption(backgroundOption);
+
+    QCommandLineOption memoryReportOption("memory-report", QCoreApplication::translate("main", "Print what the device pages, custom editors and the device list cost in memory when the window gets closed. Ctrl+Shift+M shows it at any time."));
+    parser.addOption(memoryReportOption);
+
     parser.process(app);
+    MemoryReport::setPrintOnCloseEnabled(parser.isSet(memoryReportOption));
 
     QTranslator translator;
 #if defined(Q_OS_MACOS)
@@ -39,7 +64,16 @@ int main(int argc, char *argv[])
     qDebug() << "libopenrazer translations loaded:" << ret;
     app.installTranslator(&libopenrazerTranslator);
 
-    RazerGenie w;
+    BackgroundServices services;
+
+    if (parser.isSet(backgroundOption)) {
+        // Only the services and the tray icon exist until the window is opened
+        QApplication::setQuitOnLastWindowClosed(false);
+        TrayIcon trayIcon(&services);
+        return app.exec();
+    }
+
+    RazerGenie w(&services);
     w.show();
 
     return app.exec();
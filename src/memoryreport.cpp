@@ -0,0 +1,130 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "memoryreport.h"
+
+#include <QAbstractButton>
+#include <QFile>
+#include <QIcon>
+#include <QImage>
+#include <QLabel>
+#include <QLayout>
+#include <QPixmap>
+#include <QWidget>
+
+static bool printOnClose = false;
+
+void ObjectStats::addTree(const QObject *root)
+{
+    objects++;
+
+    if (root->isWidgetType()) {
+        auto *widget = static_cast<const QWidget *>(root);
+        widgets++;
+        if (widget->testAttribute(Qt::WA_SetPalette))
+            palettes++;
+
+        if (auto *label = qobject_cast<const QLabel *>(widget)) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+            QPixmap pixmap = label->pixmap(Qt::ReturnByValue);
+#else
+            QPixmap pixmap = label->pixmap() != nullptr ? *label->pixmap() : QPixmap();
+#endif
+            if (!pixmap.isNull())
+                addPixmap(pixmap);
+        } else if (auto *button = qobject_cast<const QAbstractButton *>(widget)) {
+            if (!button->icon().isNull())
+                addIcon(button->icon(), button->iconSize());
+        }
+    } else if (qobject_cast<const QLayout *>(root) != nullptr) {
+        layouts++;
+    }
+
+    for (const QObject *child : root->children())
+        addTree(child);
+}
+
+void ObjectStats::addPixmap(const QPixmap &pixmap)
+{
+    pixmaps++;
+    pixmapBytes += qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+void ObjectStats::addIcon(const QIcon &icon, const QSize &size)
+{
+    // Assumes 32 bit pixels, that's what the icon engines render into
+    QSize actualSize = icon.actualSize(size);
+    pixmaps++;
+    pixmapBytes += qint64(actualSize.width()) * actualSize.height() * 4;
+}
+
+void ObjectStats::addImage(const QImage &image)
+{
+    imageBytes += image.sizeInBytes();
+}
+
+void MemoryReport::addRow(const QString &name, const ObjectStats &stats)
+{
+    rows.append(qMakePair(name, stats));
+}
+
+QString MemoryReport::toString() const
+{
+    int nameWidth = 4;
+    for (const auto &row : rows)
+        nameWidth = qMax(nameWidth, row.first.size());
+
+    QString text;
+    text += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                    .arg("Part", -nameWidth)
+                    .arg("Objects", 8)
+                    .arg("Widgets", 8)
+                    .arg("Layouts", 8)
+                    .arg("Palettes", 9)
+                    .arg("Pixmaps", 8)
+                    .arg("Pixmap KiB", 11)
+                    .arg("Image KiB", 10);
+    for (const auto &row : rows) {
+        const ObjectStats &stats = row.second;
+        text += QString("%1 %2 %3 %4 %5 %6 %7 %8\n")
+                        .arg(row.first, -nameWidth)
+                        .arg(stats.objects, 8)
+                        .arg(stats.widgets, 8)
+                        .arg(stats.layouts, 8)
+                        .arg(stats.palettes, 9)
+                        .arg(stats.pixmaps, 8)
+                        .arg(stats.pixmapBytes / 1024, 11)
+                        .arg(stats.imageBytes / 1024, 10);
+    }
+
+    qint64 rss = residentSetSize();
+    if (rss >= 0)
+        text += QString("\nResident memory of the process: %1 KiB\n").arg(rss);
+    return text;
+}
+
+qint64 MemoryReport::residentSetSize()
+{
+    QFile file("/proc/self/status");
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return -1;
+
+    // The line looks like "VmRSS:      123456 kB"
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').value(0).toLongLong();
+    }
+    return -1;
+}
+
+bool MemoryReport::isPrintOnCloseEnabled()
+{
+    return printOnClose;
+}
+
+void MemoryReport::setPrintOnCloseEnabled(bool enabled)
+{
+    printOnClose = enabled;
+}
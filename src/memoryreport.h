@@ -0,0 +1,61 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+class QIcon;
+class QImage;
+class QObject;
+class QPixmap;
+class QSize;
+
+/*
+ * What a part of the window costs: the objects in its QObject tree and an
+ * estimate of the pixel data it keeps around.
+ */
+struct ObjectStats {
+    int objects = 0;
+    int widgets = 0;
+    int layouts = 0;
+    /* Widgets with a palette of their own instead of the inherited one */
+    int palettes = 0;
+    int pixmaps = 0;
+    qint64 pixmapBytes = 0;
+    qint64 imageBytes = 0;
+
+    /* Counts root and everything below it */
+    void addTree(const QObject *root);
+    void addPixmap(const QPixmap &pixmap);
+    /* Icons are rendered into pixmaps at the size they're shown at */
+    void addIcon(const QIcon &icon, const QSize &size);
+    void addImage(const QImage &image);
+};
+
+/*
+ * A table of the memory used by the device pages, custom editors and the
+ * device list, together with the resident memory of the process.
+ */
+class MemoryReport
+{
+public:
+    void addRow(const QString &name, const ObjectStats &stats);
+    QString toString() const;
+
+    /* In KiB, -1 if /proc/self/status can't be read */
+    static qint64 residentSetSize();
+
+    /* Set by --memory-report, the window prints the report when it's closed */
+    static bool isPrintOnCloseEnabled();
+    static void setPrintOnCloseEnabled(bool enabled);
+
+private:
+    QList<QPair<QString, ObjectStats>> rows;
+};
+
+#endif // MEMORYREPORT_H
@@ -0,0 +1,94 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notificationbar.h"
+
+#include "notificationcenter.h"
+
+#include <QFrame>
+#include <QHBoxLayout>
+#include <QIcon>
+#include <QLabel>
+#include <QToolButton>
+
+NotificationBar::NotificationBar(QWidget *parent)
+    : QWidget(parent)
+{
+    layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    NotificationCenter *center = NotificationCenter::instance();
+    connect(center, &NotificationCenter::notificationAdded, this, &NotificationBar::addBanner);
+    connect(center, &NotificationCenter::notificationChanged, this, &NotificationBar::updateBanner);
+    connect(center, &NotificationCenter::notificationRemoved, this, &NotificationBar::removeBanner);
+    center->addView(this);
+
+    for (const NotificationCenter::Notification &notification : center->notifications())
+        addBanner(notification.id);
+
+    setVisible(!banners.isEmpty());
+}
+
+NotificationBar::~NotificationBar()
+{
+    NotificationCenter::instance()->removeView(this);
+}
+
+void NotificationBar::addBanner(int id)
+{
+    NotificationCenter::Notification notification = NotificationCenter::instance()->notification(id);
+
+    Banner banner;
+    banner.frame = new QFrame(this);
+    banner.frame->setFrameShape(QFrame::StyledPanel);
+    auto *bannerLayout = new QHBoxLayout(banner.frame);
+
+    auto *iconLabel = new QLabel(banner.frame);
+    QString iconName = notification.severity == NotificationCenter::Error ? "dialog-error-symbolic" : "dialog-information-symbolic";
+    iconLabel->setPixmap(QIcon::fromTheme(iconName).pixmap(16));
+    bannerLayout->addWidget(iconLabel);
+
+    banner.textLabel = new QLabel(banner.frame);
+    banner.textLabel->setWordWrap(true);
+    banner.textLabel->setOpenExternalLinks(true);
+    bannerLayout->addWidget(banner.textLabel, 1);
+
+    auto *dismissButton = new QToolButton(banner.frame);
+    dismissButton->setIcon(QIcon::fromTheme("window-close-symbolic"));
+    dismissButton->setAutoRaise(true);
+    dismissButton->setToolTip(tr("Dismiss"));
+    connect(dismissButton, &QToolButton::clicked, this, [=]() {
+        NotificationCenter::instance()->dismiss(id);
+    });
+    bannerLayout->addWidget(dismissButton);
+
+    layout->addWidget(banner.frame);
+    banners.insert(id, banner);
+    updateBanner(id);
+    show();
+}
+
+void NotificationBar::updateBanner(int id)
+{
+    if (!banners.contains(id))
+        return;
+
+    NotificationCenter::Notification notification = NotificationCenter::instance()->notification(id);
+    QString text = notification.text;
+    if (notification.count > 1)
+        text = tr("%1 (%2 times)").arg(text).arg(notification.count);
+    if (!notification.more.isEmpty())
+        text = tr("%1 (+%2 more)").arg(text).arg(notification.more.size());
+    banners.value(id).textLabel->setText(text);
+    banners.value(id).textLabel->setToolTip(notification.more.join("\n"));
+}
+
+void NotificationBar::removeBanner(int id)
+{
+    if (!banners.contains(id))
+        return;
+
+    delete banners.take(id).frame;
+    setVisible(!banners.isEmpty());
+}
@@ -0,0 +1,41 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NOTIFICATIONBAR_H
+#define NOTIFICATIONBAR_H
+
+#include <QHash>
+#include <QWidget>
+
+class QFrame;
+class QLabel;
+class QVBoxLayout;
+
+/*
+ * Shows the notifications of the NotificationCenter as banners stacked at
+ * the top of the window. Each banner can be dismissed and disappears on its
+ * own after a while.
+ */
+class NotificationBar : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit NotificationBar(QWidget *parent = nullptr);
+    ~NotificationBar() override;
+
+private:
+    struct Banner {
+        QFrame *frame;
+        QLabel *textLabel;
+    };
+
+    QVBoxLayout *layout;
+    QHash<int, Banner> banners;
+
+    void addBanner(int id);
+    void updateBanner(int id);
+    void removeBanner(int id);
+};
+
+#endif // NOTIFICATIONBAR_H
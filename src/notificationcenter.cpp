@@ -0,0 +1,153 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "notificationcenter.h"
+
+#include "util.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+#include <QWidget>
+
+/* Minimum time between two new notifications of a category, in milliseconds */
+static const int rateLimitInterval = 5 * 1000;
+/* How long notifications stay without being dismissed, in milliseconds */
+static const int infoLifetime = 10 * 1000;
+static const int errorLifetime = 30 * 1000;
+
+NotificationCenter::NotificationCenter(QObject *parent)
+    : QObject(parent)
+{
+    nextId = 1;
+}
+
+NotificationCenter::~NotificationCenter()
+{
+    qDeleteAll(entries);
+}
+
+NotificationCenter *NotificationCenter::instance()
+{
+    static NotificationCenter *center = nullptr;
+    if (center == nullptr)
+        center = new NotificationCenter(QCoreApplication::instance());
+    return center;
+}
+
+void NotificationCenter::post(Severity severity, const QString &text, const QString &category)
+{
+    QString key = category.isEmpty() ? QString(severity == Error ? "error" : "info") : category;
+
+    // Identical messages always end up in the same notification
+    for (Entry *entry : qAsConst(entries)) {
+        if (entry->notification.category == key && entry->notification.text == text) {
+            entry->notification.count++;
+            startExpiry(entry);
+            emit notificationChanged(entry->notification.id);
+            return;
+        }
+    }
+
+    // Too soon for another one of this category, the last one lists it
+    // without its own text being replaced
+    Entry *latest = latestOfCategory(key);
+    QElapsedTimer &started = lastStarted[key];
+    if (latest != nullptr && started.isValid() && started.elapsed() < rateLimitInterval) {
+        if (!latest->notification.more.contains(text))
+            latest->notification.more.append(text);
+        startExpiry(latest);
+        emit notificationChanged(latest->notification.id);
+        return;
+    }
+    started.start();
+
+    auto *entry = new Entry;
+    entry->notification.id = nextId++;
+    entry->notification.severity = severity;
+    entry->notification.category = key;
+    entry->notification.text = text;
+    entry->expiryTimer = new QTimer(this);
+    entry->expiryTimer->setSingleShot(true);
+    int id = entry->notification.id;
+    connect(entry->expiryTimer, &QTimer::timeout, this, [=]() {
+        dismiss(id);
+    });
+    entries.append(entry);
+    startExpiry(entry);
+
+    if (!isViewShown())
+        util::sendNotification(severity == Error ? tr("Error") : tr("Information"), text);
+    emit notificationAdded(id);
+}
+
+void NotificationCenter::dismiss(int id)
+{
+    Entry *entry = find(id);
+    if (entry == nullptr)
+        return;
+
+    entries.removeOne(entry);
+    delete entry->expiryTimer;
+    delete entry;
+    emit notificationRemoved(id);
+}
+
+QList<NotificationCenter::Notification> NotificationCenter::notifications() const
+{
+    QList<Notification> list;
+    for (Entry *entry : entries)
+        list.append(entry->notification);
+    return list;
+}
+
+NotificationCenter::Notification NotificationCenter::notification(int id) const
+{
+    Entry *entry = find(id);
+    if (entry == nullptr)
+        return Notification();
+    return entry->notification;
+}
+
+void NotificationCenter::addView(QWidget *view)
+{
+    views.append(view);
+}
+
+void NotificationCenter::removeView(QWidget *view)
+{
+    views.removeOne(view);
+}
+
+NotificationCenter::Entry *NotificationCenter::find(int id) const
+{
+    for (Entry *entry : entries) {
+        if (entry->notification.id == id)
+            return entry;
+    }
+    return nullptr;
+}
+
+NotificationCenter::Entry *NotificationCenter::latestOfCategory(const QString &category) const
+{
+    for (int i = entries.size() - 1; i >= 0; i--) {
+        if (entries.at(i)->notification.category == category)
+            return entries.at(i);
+    }
+    return nullptr;
+}
+
+void NotificationCenter::startExpiry(Entry *entry)
+{
+    entry->expiryTimer->start(entry->notification.severity == Error ? errorLifetime : infoLifetime);
+}
+
+bool NotificationCenter::isViewShown() const
+{
+    for (QWidget *view : views) {
+        QWidget *window = view->window();
+        if (window->isVisible() && !window->isMinimized())
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef NOTIFICATIONCENTER_H
+#define NOTIFICATIONCENTER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QStringList>
+
+class QTimer;
+class QWidget;
+
+/*
+ * Collects the errors and information messages of the application and
+ * hands them to the notification bar of the window, without blocking.
+ *
+ * Identical messages are grouped into one notification with a count. Per
+ * category, a new notification is started at most every few seconds; other
+ * messages coming in between are listed as "more" on the last one. A slider
+ * dragged against a daemon that's gone therefore produces a single
+ * notification.
+ *
+ * While no window showing them is on screen, e.g. with only the tray icon
+ * around, new notifications are sent as desktop notifications instead.
+ */
+class NotificationCenter : public QObject
+{
+    Q_OBJECT
+public:
+    enum Severity {
+        Info,
+        Error,
+    };
+    Q_ENUM(Severity)
+
+    struct Notification {
+        int id = 0;
+        Severity severity = Info;
+        QString category;
+        QString text;
+        /* How often the text was posted */
+        int count = 1;
+        /* Other messages of the category that came in too soon after this one */
+        QStringList more;
+    };
+
+    static NotificationCenter *instance();
+
+    /* An empty category groups the message with the others of its severity */
+    void post(Severity severity, const QString &text, const QString &category = QString());
+    void dismiss(int id);
+
+    QList<Notification> notifications() const;
+    Notification notification(int id) const;
+
+    /* Called by the notification bars, while one of them is on screen the
+     * desktop notifications aren't used */
+    void addView(QWidget *view);
+    void removeView(QWidget *view);
+
+signals:
+    void notificationAdded(int id);
+    void notificationChanged(int id);
+    void notificationRemoved(int id);
+
+private:
+    explicit NotificationCenter(QObject *parent = nullptr);
+    ~NotificationCenter() override;
+
+    struct Entry {
+        Notification notification;
+        QTimer *expiryTimer = nullptr;
+    };
+
+    QList<Entry *> entries;
+    /* When the last notification of a category was started */
+    QHash<QString, QElapsedTimer> lastStarted;
+    int nextId;
+    QList<QWidget *> views;
+
+    Entry *find(int id) const;
+    Entry *latestOfCategory(const QString &category) const;
+    void startExpiry(Entry *entry);
+    bool isViewShown() const;
+};
+
+#endif // NOTIFICATIONCENTER_H
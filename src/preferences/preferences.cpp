@@ -4,18 +4,27 @@
 
 #include "preferences.h"
 
+#include "backgroundservices.h"
+#include "profiles/profile.h"
+#include "profiles/profileswitcher.h"
+
+#include <QApplication>
 #include <QCheckBox>
 #include <QComboBox>
 #include <QFormLayout>
+#include <QHeaderView>
 #include <QLabel>
-#include <QMessageBox>
+#include <QPushButton>
 #include <QScrollArea>
+#include <QSignalBlocker>
+#include <QSpinBox>
+#include <QTableWidget>
 #include <QVBoxLayout>
 #include <config.h>
 #include <libopenrazer.h>
 
-Preferences::Preferences(libopenrazer::Manager *manager, QWidget *parent)
-    : QDialog(parent), manager(manager)
+Preferences::Preferences(BackgroundServices *services, QWidget *parent)
+    : QDialog(parent), services(services)
 {
     setWindowTitle(tr("RazerGenie - Preferences"));
     resize(600, 500);
@@ -57,14 +66,11 @@ Preferences::Preferences(libopenrazer::Manager *manager, QWidget *parent)
     formLayout->addRow(tr("RazerGenie Version:"), razergenieVersionLabel);
 
     QLabel *openrazerVersionLabel = new QLabel(this);
-    QString daemonVersion = "unknown";
-    try {
-        daemonVersion = manager->getDaemonVersion();
-    } catch (const libopenrazer::DBusException &e) {
-        qDebug() << "Failed to get daemon version:" << e.name() << e.message();
-    }
-    openrazerVersionLabel->setText(daemonVersion);
+    showDaemonVersion(openrazerVersionLabel);
     formLayout->addRow(tr("OpenRazer Daemon Version:"), openrazerVersionLabel);
+    connect(services, &BackgroundServices::managerChanged, openrazerVersionLabel, [=]() {
+        showDaemonVersion(openrazerVersionLabel);
+    });
 
     QLabel *generalLabel = new QLabel(this);
     generalLabel->setText(tr("General"));
@@ -88,8 +94,9 @@ Preferences::Preferences(libopenrazer::Manager *manager, QWidget *parent)
     QLabel *downloadText = new QLabel(this);
     downloadText->setText(tr("For displaying device images, RazerGenie downloads the image behind "
                              "the URL specified for a device in the OpenRazer daemon source code. "
-                             "This will only be done for devices that are connected to the PC and "
-                             "only once, as the images are cached locally. For reviewing, what "
+                             "This will only be done for devices that are connected to the PC. "
+                             "The images are cached locally and only checked for changes as often "
+                             "as configured below. For reviewing, what "
                              "information Razer might collect with these connections, please "
                              "consult the <a href=\"https://www.razer.com/legal/privacy-policy\">"
                              "Razer Privacy Policy</a>."));
@@ -97,6 +104,19 @@ Preferences::Preferences(libopenrazer::Manager *manager, QWidget *parent)
     downloadText->setWordWrap(true);
     formLayout->addRow(nullptr, downloadText);
 
+    QComboBox *revalidationComboBox = new QComboBox(this);
+    revalidationComboBox->addItem(tr("Never"), 0);
+    revalidationComboBox->addItem(tr("Daily"), 1);
+    revalidationComboBox->addItem(tr("Weekly"), 7);
+    revalidationComboBox->addItem(tr("Monthly"), 30);
+    revalidationComboBox->setCurrentIndex(qMax(0, revalidationComboBox->findData(settings.value("imageRevalidationDays", 7).toInt())));
+    revalidationComboBox->setEnabled(downloadCheckBox->isChecked());
+    connect(revalidationComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int index) {
+        settings.setValue("imageRevalidationDays", revalidationComboBox->itemData(index));
+    });
+    connect(downloadCheckBox, &QCheckBox::toggled, revalidationComboBox, &QComboBox::setEnabled);
+    formLayout->addRow(tr("Check for updated images:"), revalidationComboBox);
+
     QCheckBox *noAutostartCheckBox = new QCheckBox(this);
     noAutostartCheckBox->setText(tr("Ask to auto-start daemon on startup"));
     noAutostartCheckBox->setChecked(settings.value("askAutostartDaemon", true).toBool());
@@ -105,19 +125,167 @@ Preferences::Preferences(libopenrazer::Manager *manager, QWidget *parent)
     });
     formLayout->addRow(tr("Daemon auto-start:"), noAutostartCheckBox);
 
+    QSpinBox *maxPagesSpinBox = new QSpinBox(this);
+    maxPagesSpinBox->setRange(1, 100);
+    maxPagesSpinBox->setValue(settings.value("maxDevicePages", 4).toInt());
+    connect(maxPagesSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        settings.setValue("maxDevicePages", value);
+    });
+    formLayout->addRow(tr("Device pages kept in memory:"), maxPagesSpinBox);
+
+    QLabel *maxPagesText = new QLabel(this);
+    maxPagesText->setText(tr("Pages of devices that weren't viewed recently are released and "
+                             "rebuilt when the device is selected again."));
+    maxPagesText->setWordWrap(true);
+    formLayout->addRow(nullptr, maxPagesText);
+
+    QSpinBox *writeTimeoutSpinBox = new QSpinBox(this);
+    writeTimeoutSpinBox->setRange(500, 60000);
+    writeTimeoutSpinBox->setSingleStep(500);
+    writeTimeoutSpinBox->setSuffix(tr(" ms"));
+    writeTimeoutSpinBox->setValue(settings.value("writeTimeout", 3000).toInt());
+    connect(writeTimeoutSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        settings.setValue("writeTimeout", value);
+    });
+    formLayout->addRow(tr("Timeout for changes:"), writeTimeoutSpinBox);
+
+    QSpinBox *readTimeoutSpinBox = new QSpinBox(this);
+    readTimeoutSpinBox->setRange(500, 60000);
+    readTimeoutSpinBox->setSingleStep(500);
+    readTimeoutSpinBox->setSuffix(tr(" ms"));
+    readTimeoutSpinBox->setValue(settings.value("readTimeout", 10000).toInt());
+    connect(readTimeoutSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [=](int value) {
+        settings.setValue("readTimeout", value);
+    });
+    formLayout->addRow(tr("Timeout for reading devices:"), readTimeoutSpinBox);
+
+    QLabel *timeoutText = new QLabel(this);
+    timeoutText->setText(tr("A device that repeatedly doesn't answer in time is considered not responding. "
+                            "Nothing is sent to it until it answers a periodic check again."));
+    timeoutText->setWordWrap(true);
+    formLayout->addRow(nullptr, timeoutText);
+
     QComboBox *backendComboBox = new QComboBox(this);
     backendComboBox->addItem("OpenRazer");
     backendComboBox->addItem("razer_test");
+    backendComboBox->addItem("sysfs");
     backendComboBox->setCurrentText(settings.value("backend").toString());
     connect(backendComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), [=](int index) {
-        settings.setValue("backend", backendComboBox->itemText(index));
-        // Show popup to restart program
-        QMessageBox msgBox;
-        msgBox.setText(tr("Please restart the application for the switch to take effect."));
-        msgBox.addButton(QMessageBox::Ok);
-        msgBox.exec();
+        // Enumerates the devices of the new backend, which can take a moment
+        QApplication::setOverrideCursor(Qt::WaitCursor);
+        services->switchBackend(backendComboBox->itemText(index));
+        QApplication::restoreOverrideCursor();
     });
     formLayout->addRow(tr("Daemon backend:"), backendComboBox);
+
+    QLabel *backendText = new QLabel(this);
+    backendText->setText(tr("The sysfs backend talks to the OpenRazer kernel driver directly, without the daemon. "
+                            "It is faster for custom effects but doesn't support device images, software effects and syncing."));
+    backendText->setWordWrap(true);
+    formLayout->addRow(nullptr, backendText);
+
+    QLabel *profilesLabel = new QLabel(this);
+    profilesLabel->setText(tr("Profiles"));
+    profilesLabel->setFont(titleFont);
+    profilesLabel->setAlignment(Qt::AlignHCenter);
+    formLayout->addRow(profilesLabel);
+
+    QFrame *profilesSeparator = new QFrame(this);
+    profilesSeparator->setFrameShape(QFrame::HLine);
+    profilesSeparator->setFrameShadow(QFrame::Sunken);
+    formLayout->addRow(profilesSeparator);
+
+    QStringList profiles = Profile::list();
+
+    QComboBox *defaultProfileComboBox = new QComboBox(this);
+    defaultProfileComboBox->addItem(tr("None"), QString());
+    for (const QString &profile : profiles) {
+        defaultProfileComboBox->addItem(profile, profile);
+    }
+    defaultProfileComboBox->setCurrentIndex(qMax(0, defaultProfileComboBox->findData(settings.value("defaultProfile").toString())));
+    connect(defaultProfileComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int index) {
+        settings.setValue("defaultProfile", defaultProfileComboBox->itemData(index));
+    });
+    formLayout->addRow(tr("Default profile:"), defaultProfileComboBox);
+
+    QLabel *rulesText = new QLabel(this);
+    rulesText->setText(tr("While an application with one of the following executable names is "
+                          "running, its profile gets applied. When it exits, the default profile "
+                          "gets applied again."));
+    rulesText->setWordWrap(true);
+    formLayout->addRow(nullptr, rulesText);
+
+    rulesTable = new QTableWidget(0, 2, this);
+    rulesTable->setHorizontalHeaderLabels({ tr("Application"), tr("Profile") });
+    rulesTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    rulesTable->verticalHeader()->hide();
+    rulesTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    rulesTable->setMinimumHeight(150);
+
+    QHashIterator<QString, QString> i(ProfileSwitcher::loadRules());
+    while (i.hasNext()) {
+        i.next();
+        addRuleRow(i.key(), i.value(), profiles);
+    }
+    connect(rulesTable, &QTableWidget::itemChanged, this, &Preferences::saveRules);
+    formLayout->addRow(rulesTable);
+
+    auto *rulesButtonsHBox = new QHBoxLayout();
+    QPushButton *addRuleButton = new QPushButton(QIcon::fromTheme("list-add-symbolic"), tr("Add"), this);
+    QPushButton *removeRuleButton = new QPushButton(QIcon::fromTheme("list-remove-symbolic"), tr("Remove"), this);
+    rulesButtonsHBox->addWidget(addRuleButton);
+    rulesButtonsHBox->addWidget(removeRuleButton);
+    rulesButtonsHBox->addStretch();
+    formLayout->addRow(rulesButtonsHBox);
+
+    addRuleButton->setEnabled(!profiles.isEmpty());
+    connect(addRuleButton, &QPushButton::clicked, this, [=]() {
+        addRuleRow(QString(), profiles.first(), profiles);
+        rulesTable->editItem(rulesTable->item(rulesTable->rowCount() - 1, 0));
+    });
+    connect(removeRuleButton, &QPushButton::clicked, this, [=]() {
+        rulesTable->removeRow(rulesTable->currentRow());
+        saveRules();
+    });
+}
+
+void Preferences::addRuleRow(const QString &application, const QString &profile, const QStringList &profiles)
+{
+    int row = rulesTable->rowCount();
+    rulesTable->insertRow(row);
+
+    QSignalBlocker blocker(rulesTable);
+    rulesTable->setItem(row, 0, new QTableWidgetItem(application));
+
+    auto *profileComboBox = new QComboBox(rulesTable);
+    profileComboBox->addItems(profiles);
+    if (!profiles.contains(profile))
+        profileComboBox->addItem(profile);
+    profileComboBox->setCurrentText(profile);
+    connect(profileComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &Preferences::saveRules);
+    rulesTable->setCellWidget(row, 1, profileComboBox);
+}
+
+void Preferences::saveRules()
+{
+    QHash<QString, QString> rules;
+    for (int row = 0; row < rulesTable->rowCount(); row++) {
+        QTableWidgetItem *item = rulesTable->item(row, 0);
+        auto *profileComboBox = qobject_cast<QComboBox *>(rulesTable->cellWidget(row, 1));
+        if (item == nullptr || item->text().trimmed().isEmpty() || profileComboBox == nullptr)
+            continue;
+        rules.insert(item->text().trimmed(), profileComboBox->currentText());
+    }
+    ProfileSwitcher::saveRules(rules);
+}
+
+void Preferences::showDaemonVersion(QLabel *label)
+{
+    label->setText(tr("Loading..."));
+    services->callManager<QString>(
+            label, [](libopenrazer::Manager *manager) { return manager->getDaemonVersion(); },
+            [=](const QString &version) { label->setText(version); },
+            [=]() { label->setText("unknown"); });
 }
 
 Preferences::~Preferences() = default;
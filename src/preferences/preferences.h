@@ -9,17 +9,27 @@
 #include <QSettings>
 #include <libopenrazer.h>
 
+class BackgroundServices;
+class QLabel;
+class QTableWidget;
+
 class Preferences : public QDialog
 {
     Q_OBJECT
 public:
-    Preferences(libopenrazer::Manager *manager, QWidget *parent = nullptr);
+    Preferences(BackgroundServices *services, QWidget *parent = nullptr);
     ~Preferences() override;
 
 private:
     QSettings settings;
 
-    libopenrazer::Manager *manager;
+    BackgroundServices *services;
+
+    void showDaemonVersion(QLabel *label);
+
+    QTableWidget *rulesTable;
+    void addRuleRow(const QString &application, const QString &profile, const QStringList &profiles);
+    void saveRules();
 };
 
 #endif // PREFERENCES_H
@@ -0,0 +1,347 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "processwatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <linux/cn_proc.h>
+#include <linux/connector.h>
+#include <linux/netlink.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* The values are ABI, but newer kernel headers moved the enum out of
+ * struct proc_event which changes how it has to be spelled in C++ */
+static const quint32 procEventExec = 0x00000002;
+static const quint32 procEventExit = 0x80000000;
+#endif
+
+ProcessWatcher::ProcessWatcher(QObject *parent)
+    : QObject(parent)
+{
+    netlinkFd = -1;
+    netlinkNotifier = nullptr;
+    inotifyFd = -1;
+    inotifyNotifier = nullptr;
+
+#ifdef Q_OS_LINUX
+    if (!setupNetlink())
+        qInfo("ProcessWatcher: Process connector not available, falling back to inotify.");
+#else
+    qInfo("ProcessWatcher: Watching processes is only supported on Linux.");
+#endif
+}
+
+ProcessWatcher::~ProcessWatcher()
+{
+#ifdef Q_OS_LINUX
+    // The notifiers have to go before their descriptors are closed
+    teardownInotify();
+    delete netlinkNotifier;
+    if (netlinkFd != -1)
+        close(netlinkFd);
+    for (QSocketNotifier *notifier : qAsConst(pidfdNotifiers)) {
+        int pidfd = static_cast<int>(notifier->socket());
+        delete notifier;
+        close(pidfd);
+    }
+    pidfdNotifiers.clear();
+#endif
+}
+
+void ProcessWatcher::setWatchedNames(const QSet<QString> &names)
+{
+    watchedNames = names;
+
+#ifdef Q_OS_LINUX
+    // The inotify watches depend on the names, rebuild them
+    if (netlinkFd == -1) {
+        teardownInotify();
+        if (!watchedNames.isEmpty())
+            setupInotify();
+    }
+#endif
+
+    // Pick up processes that are already running
+    scanProcesses();
+}
+
+#ifdef Q_OS_LINUX
+
+bool ProcessWatcher::setupNetlink()
+{
+    netlinkFd = socket(PF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_CONNECTOR);
+    if (netlinkFd == -1)
+        return false;
+
+    struct sockaddr_nl addr = {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = CN_IDX_PROC;
+    addr.nl_pid = 0;
+
+    // Subscribe to the process events, this fails without CAP_NET_ADMIN
+    char buf[NLMSG_SPACE(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op))] = {};
+    auto *nlh = reinterpret_cast<struct nlmsghdr *>(buf);
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct cn_msg) + sizeof(enum proc_cn_mcast_op));
+    nlh->nlmsg_type = NLMSG_DONE;
+    auto *msg = reinterpret_cast<struct cn_msg *>(NLMSG_DATA(nlh));
+    msg->id.idx = CN_IDX_PROC;
+    msg->id.val = CN_VAL_PROC;
+    msg->len = sizeof(enum proc_cn_mcast_op);
+    *reinterpret_cast<enum proc_cn_mcast_op *>(msg->data) = PROC_CN_MCAST_LISTEN;
+
+    if (bind(netlinkFd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1
+        || send(netlinkFd, buf, nlh->nlmsg_len, 0) == -1) {
+        close(netlinkFd);
+        netlinkFd = -1;
+        return false;
+    }
+
+    netlinkNotifier = new QSocketNotifier(netlinkFd, QSocketNotifier::Read, this);
+    connect(netlinkNotifier, &QSocketNotifier::activated, this, &ProcessWatcher::readNetlink);
+    qInfo("ProcessWatcher: Using the process connector.");
+    return true;
+}
+
+void ProcessWatcher::setupInotify()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd == -1) {
+        qWarning("ProcessWatcher: Failed to initialize inotify");
+        return;
+    }
+
+    // Watch the directories that contain the executables we're interested in
+    QSet<QString> directories;
+    for (const QString &name : qAsConst(watchedNames)) {
+        QString path = QStandardPaths::findExecutable(name);
+        if (path.isEmpty()) {
+            qInfo("ProcessWatcher: Can't find %s in PATH, it won't be detected without the process connector.", qUtf8Printable(name));
+            continue;
+        }
+        directories.insert(QFileInfo(path).canonicalPath());
+    }
+
+    for (const QString &directory : qAsConst(directories)) {
+        int wd = inotify_add_watch(inotifyFd, QFile::encodeName(directory).constData(), IN_OPEN);
+        if (wd == -1) {
+            qWarning("ProcessWatcher: Failed to watch %s", qUtf8Printable(directory));
+            continue;
+        }
+        inotifyWatches.insert(wd, directory);
+    }
+
+    inotifyNotifier = new QSocketNotifier(inotifyFd, QSocketNotifier::Read, this);
+    connect(inotifyNotifier, &QSocketNotifier::activated, this, &ProcessWatcher::readInotify);
+}
+
+void ProcessWatcher::teardownInotify()
+{
+    delete inotifyNotifier;
+    inotifyNotifier = nullptr;
+    inotifyWatches.clear();
+    if (inotifyFd != -1) {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+}
+
+void ProcessWatcher::readNetlink()
+{
+    alignas(struct nlmsghdr) char buf[8192];
+    ssize_t received;
+    while ((received = recv(netlinkFd, buf, sizeof(buf), 0)) > 0) {
+        int len = static_cast<int>(received);
+        for (auto *nlh = reinterpret_cast<struct nlmsghdr *>(buf); NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+            if (nlh->nlmsg_type == NLMSG_NOOP)
+                continue;
+            if (nlh->nlmsg_type == NLMSG_ERROR || nlh->nlmsg_type == NLMSG_OVERRUN)
+                break;
+
+            auto *msg = reinterpret_cast<struct cn_msg *>(NLMSG_DATA(nlh));
+            auto *event = reinterpret_cast<struct proc_event *>(msg->data);
+            quint32 what = static_cast<quint32>(event->what);
+            if (what == procEventExec) {
+                handleExec(event->event_data.exec.process_tgid);
+            } else if (what == procEventExit) {
+                // Ignore threads exiting
+                if (event->event_data.exit.process_pid == event->event_data.exit.process_tgid)
+                    handleExit(event->event_data.exit.process_tgid);
+            }
+        }
+    }
+}
+
+void ProcessWatcher::readInotify()
+{
+    alignas(struct inotify_event) char buf[4096];
+    ssize_t received;
+    while ((received = read(inotifyFd, buf, sizeof(buf))) > 0) {
+        for (char *ptr = buf; ptr < buf + received;) {
+            auto *event = reinterpret_cast<struct inotify_event *>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->len == 0)
+                continue;
+            QString name = QFile::decodeName(event->name);
+            if (!watchedNames.contains(name))
+                continue;
+
+            /* IN_OPEN fires before the exec completes and also for plain
+             * reads of the file, so look for the process a bit later */
+            QTimer::singleShot(50, this, [=]() { scanProcesses(name); });
+        }
+    }
+}
+
+QString ProcessWatcher::matchProcess(qint64 pid) const
+{
+    QString procPath = QString("/proc/%1/").arg(pid);
+
+    // Name of the executable, e.g. "steam"
+    QString exe = QFileInfo(QFile::symLinkTarget(procPath + "exe")).fileName();
+    if (watchedNames.contains(exe))
+        return exe;
+
+    // argv[0] also catches programs started through an interpreter or Wine
+    QFile cmdline(procPath + "cmdline");
+    if (cmdline.open(QIODevice::ReadOnly)) {
+        QString argv0 = QFile::decodeName(cmdline.read(4096).split('\0').value(0));
+        argv0 = argv0.section('/', -1).section('\\', -1);
+        if (watchedNames.contains(argv0))
+            return argv0;
+    }
+
+    return QString();
+}
+
+void ProcessWatcher::watchExit(qint64 pid)
+{
+    // With the process connector we get exit events anyways
+    if (netlinkFd != -1)
+        return;
+
+#ifdef SYS_pidfd_open
+    int pidfd = static_cast<int>(syscall(SYS_pidfd_open, static_cast<pid_t>(pid), 0));
+    if (pidfd == -1) {
+        qWarning("ProcessWatcher: Failed to watch process %lld for exiting", pid);
+        return;
+    }
+
+    // A pidfd becomes readable once the process has exited
+    auto *notifier = new QSocketNotifier(pidfd, QSocketNotifier::Read, this);
+    pidfdNotifiers.insert(pid, notifier);
+    connect(notifier, &QSocketNotifier::activated, this, [=]() {
+        handleExit(pid);
+    });
+#else
+    qWarning("ProcessWatcher: pidfd_open is not available, can't detect process %lld exiting", pid);
+#endif
+}
+
+#else
+
+bool ProcessWatcher::setupNetlink()
+{
+    return false;
+}
+
+void ProcessWatcher::setupInotify()
+{
+}
+
+void ProcessWatcher::teardownInotify()
+{
+}
+
+void ProcessWatcher::readNetlink()
+{
+}
+
+void ProcessWatcher::readInotify()
+{
+}
+
+QString ProcessWatcher::matchProcess(qint64 /* pid */) const
+{
+    return QString();
+}
+
+void ProcessWatcher::watchExit(qint64 /* pid */)
+{
+}
+
+#endif
+
+void ProcessWatcher::handleExec(qint64 pid)
+{
+    if (watchedNames.isEmpty())
+        return;
+
+    QString name = matchProcess(pid);
+    if (trackedProcesses.contains(pid)) {
+        if (name == trackedProcesses.value(pid))
+            return;
+        // A watched process replaced itself with something else
+        handleExit(pid);
+    }
+    if (name.isEmpty())
+        return;
+
+    trackedProcesses.insert(pid, name);
+    watchExit(pid);
+    emit processStarted(pid, name);
+}
+
+void ProcessWatcher::handleExit(qint64 pid)
+{
+    if (!trackedProcesses.contains(pid))
+        return;
+
+    QString name = trackedProcesses.take(pid);
+
+    QSocketNotifier *notifier = pidfdNotifiers.take(pid);
+    if (notifier != nullptr) {
+        // This might run from the notifier's own signal, so it's deleted
+        // later but stops watching before the descriptor gets closed
+        notifier->setEnabled(false);
+#ifdef Q_OS_LINUX
+        close(static_cast<int>(notifier->socket()));
+#endif
+        notifier->deleteLater();
+    }
+
+    emit processExited(pid, name);
+}
+
+void ProcessWatcher::scanProcesses(const QString &onlyName)
+{
+    if (watchedNames.isEmpty())
+        return;
+
+    QDir proc("/proc");
+    for (const QString &entry : proc.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        bool ok;
+        qint64 pid = entry.toLongLong(&ok);
+        if (!ok || trackedProcesses.contains(pid))
+            continue;
+
+        QString name = matchProcess(pid);
+        if (name.isEmpty() || (!onlyName.isEmpty() && name != onlyName))
+            continue;
+
+        trackedProcesses.insert(pid, name);
+        watchExit(pid);
+        emit processStarted(pid, name);
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROCESSWATCHER_H
+#define PROCESSWATCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QSocketNotifier;
+
+/*
+ * Reports when processes with one of the watched executable names start
+ * and exit, without polling.
+ *
+ * On Linux this listens to exec and exit events from the netlink process
+ * connector. As the connector requires CAP_NET_ADMIN, the fallback watches
+ * the directories of the watched executables with inotify for IN_OPEN
+ * events, which the kernel also generates for execve(), and uses a pidfd
+ * per matched process to notice when it exits.
+ */
+class ProcessWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProcessWatcher(QObject *parent = nullptr);
+    ~ProcessWatcher() override;
+
+    /* Executable names (e.g. "steam" or "game.exe") to report */
+    void setWatchedNames(const QSet<QString> &names);
+
+signals:
+    void processStarted(qint64 pid, const QString &name);
+    void processExited(qint64 pid, const QString &name);
+
+private:
+    QSet<QString> watchedNames;
+    QHash<qint64, QString> trackedProcesses;
+
+    int netlinkFd;
+    QSocketNotifier *netlinkNotifier;
+
+    int inotifyFd;
+    QSocketNotifier *inotifyNotifier;
+    QHash<int, QString> inotifyWatches;
+
+    QHash<qint64, QSocketNotifier *> pidfdNotifiers;
+
+    bool setupNetlink();
+    void setupInotify();
+    void teardownInotify();
+
+    void readNetlink();
+    void readInotify();
+
+    QString matchProcess(qint64 pid) const;
+    void handleExec(qint64 pid);
+    void handleExit(qint64 pid);
+    void scanProcesses(const QString &onlyName = QString());
+    void watchExit(qint64 pid);
+};
+
+#endif // PROCESSWATCHER_H
@@ -0,0 +1,109 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "profile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+
+Profile::Profile() = default;
+
+Profile::Profile(const QString &name)
+    : name(name)
+{
+}
+
+bool Profile::isNull() const
+{
+    return name.isEmpty();
+}
+
+QString Profile::getName() const
+{
+    return name;
+}
+
+QHash<QString, DeviceState> Profile::getDevices() const
+{
+    return devices;
+}
+
+void Profile::setDeviceState(const QString &serial, const DeviceState &state)
+{
+    devices.insert(serial, state);
+}
+
+bool Profile::save() const
+{
+    QDir dir;
+    dir.mkpath(getProfilePath());
+
+    QJsonObject devicesObject;
+    QHashIterator<QString, DeviceState> i(devices);
+    while (i.hasNext()) {
+        i.next();
+        devicesObject.insert(i.key(), i.value().toJson());
+    }
+
+    QJsonObject object;
+    object.insert("name", name);
+    object.insert("devices", devicesObject);
+
+    QSaveFile file(getFilePath(name));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("Failed to save profile %s: %s", qUtf8Printable(name), qUtf8Printable(file.errorString()));
+        return false;
+    }
+    file.write(QJsonDocument(object).toJson());
+    return file.commit();
+}
+
+Profile Profile::load(const QString &name)
+{
+    QFile file(getFilePath(name));
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning("Failed to load profile %s: %s", qUtf8Printable(name), qUtf8Printable(file.errorString()));
+        return Profile();
+    }
+
+    QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+
+    Profile profile(object.value("name").toString(name));
+    QJsonObject devicesObject = object.value("devices").toObject();
+    for (auto it = devicesObject.constBegin(); it != devicesObject.constEnd(); ++it) {
+        profile.setDeviceState(it.key(), DeviceState::fromJson(it.value().toObject()));
+    }
+    return profile;
+}
+
+bool Profile::remove(const QString &name)
+{
+    return QFile::remove(getFilePath(name));
+}
+
+QStringList Profile::list()
+{
+    QStringList names;
+    QDir dir(getProfilePath());
+    for (const QString &fileName : dir.entryList({ "*.json" }, QDir::Files, QDir::Name)) {
+        names << QUrl::fromPercentEncoding(fileName.chopped(5).toUtf8());
+    }
+    return names;
+}
+
+QString Profile::getProfilePath()
+{
+    // Should be ~/.local/share/razergenie/profiles/
+    return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/razergenie/profiles/";
+}
+
+QString Profile::getFilePath(const QString &name)
+{
+    // Keep the profile name usable as file name whatever characters it contains
+    return getProfilePath() + QString::fromUtf8(QUrl::toPercentEncoding(name, " ")) + ".json";
+}
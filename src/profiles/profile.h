@@ -0,0 +1,45 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "devicestate.h"
+
+#include <QHash>
+#include <QString>
+#include <libopenrazer.h>
+
+/*
+ * A named set of device settings, keyed by the serial number of the device.
+ *
+ * Profiles are stored as JSON files in ~/.local/share/razergenie/profiles/
+ */
+class Profile
+{
+public:
+    Profile();
+    explicit Profile(const QString &name);
+
+    bool isNull() const;
+    QString getName() const;
+
+    QHash<QString, DeviceState> getDevices() const;
+    void setDeviceState(const QString &serial, const DeviceState &state);
+
+    bool save() const;
+
+    static Profile load(const QString &name);
+    static bool remove(const QString &name);
+    static QStringList list();
+    static QString getProfilePath();
+
+private:
+    QString name;
+    QHash<QString, DeviceState> devices;
+
+    static QString getFilePath(const QString &name);
+};
+
+#endif // PROFILE_H
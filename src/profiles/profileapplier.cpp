@@ -0,0 +1,188 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "profileapplier.h"
+
+#include "devicecommandqueue.h"
+
+#include <QElapsedTimer>
+#include <functional>
+#include <memory>
+
+ProfileApplier::ProfileApplier(DeviceCommandQueue *commandQueue, QObject *parent)
+    : QObject(parent)
+{
+    this->commandQueue = commandQueue;
+    running = false;
+    remaining = 0;
+    hasQueued = false;
+}
+
+ProfileApplier::~ProfileApplier()
+{
+    // The batches in the queues have this as context, so the queue skips
+    // the ones that haven't started. The queue keeps the device of a
+    // running one until it returns, nothing waits for it here.
+    hasQueued = false;
+    queuedDevices.clear();
+}
+
+bool ProfileApplier::isRunning() const
+{
+    return running;
+}
+
+void ProfileApplier::removeDevice(libopenrazer::Device *device)
+{
+    // A queued profile must not be applied to a device that's gone by then
+    queuedDevices.removeAll(device);
+}
+
+void ProfileApplier::apply(const Profile &profile, const QList<libopenrazer::Device *> &devices)
+{
+    if (running) {
+        queuedProfile = profile;
+        queuedDevices = devices;
+        hasQueued = true;
+        return;
+    }
+
+    running = true;
+    remaining = devices.size();
+    results.clear();
+
+    if (devices.isEmpty()) {
+        running = false;
+        emit finished(profile.getName(), results);
+        return;
+    }
+
+    QString profileName = profile.getName();
+    auto timer = std::make_shared<QElapsedTimer>();
+    timer->start();
+
+    auto onDeviceFinished = [=](const ProfileApplyResult &result) {
+        results.append(result);
+        emit deviceFinished(profileName, result);
+
+        if (--remaining > 0)
+            return;
+
+        qDebug("ProfileApplier: Applied profile %s in %lld ms", qUtf8Printable(profileName), timer->elapsed());
+
+        running = false;
+        emit finished(profileName, results);
+
+        if (hasQueued) {
+            hasQueued = false;
+            apply(queuedProfile, queuedDevices);
+        }
+    };
+
+    // Every device is one batch in its queue, so it runs in order with the
+    // changes made on the device pages and in parallel to the other devices
+    for (libopenrazer::Device *device : devices) {
+        // The failure can be reported while the device gets removed
+        QString devicePath = device->objectPath().path();
+        commandQueue->read<ProfileApplyResult>(
+                device, this,
+                [=]() {
+                    return applyToDevice(device, profile);
+                },
+                onDeviceFinished,
+                [=](const QString &error) {
+                    ProfileApplyResult result;
+                    result.deviceName = devicePath;
+                    result.errors << error;
+                    onDeviceFinished(result);
+                });
+    }
+}
+
+ProfileApplyResult ProfileApplier::applyToDevice(libopenrazer::Device *device, const Profile &profile)
+{
+    ProfileApplyResult result;
+    result.deviceName = device->getDeviceName();
+
+    try {
+        result.serial = device->getSerial();
+    } catch (const libopenrazer::DBusException &e) {
+        result.errors << QString("Failed to get serial: %1").arg(e.message());
+        return result;
+    }
+
+    QHash<QString, DeviceState> devices = profile.getDevices();
+    if (!devices.contains(result.serial)) {
+        result.skipped = true;
+        return result;
+    }
+
+    DeviceState target = devices.value(result.serial);
+    DeviceState current = DeviceState::read(device);
+
+    auto write = [&](const QString &what, std::function<void()> function) {
+        try {
+            function();
+            result.changedSettings++;
+        } catch (const libopenrazer::DBusException &e) {
+            result.errors << QString("Failed to set %1: %2").arg(what, e.message());
+        }
+    };
+
+    for (libopenrazer::Led *led : device->getLeds()) {
+        if (!target.leds.contains(led->getLedId()))
+            continue;
+        LedSettings targetLed = target.leds.value(led->getLedId());
+        LedSettings currentLed = current.leds.value(led->getLedId());
+
+        if (targetLed.hasEffect && (!currentLed.hasEffect || !effectEqual(targetLed, currentLed))) {
+            write("effect", [=]() {
+                LedSettings::applyEffect(led, targetLed.effect, targetLed.colors, targetLed.direction);
+            });
+        }
+        if (targetLed.hasBrightness && led->hasBrightness()
+            && (!currentLed.hasBrightness || targetLed.brightness != currentLed.brightness)) {
+            write("brightness", [=]() {
+                led->setBrightness(targetLed.brightness);
+            });
+        }
+    }
+
+    if (target.hasDpiStages && device->hasFeature("dpi_stages")) {
+        if (!current.hasDpiStages || target.activeStage != current.activeStage || !dpiStagesEqual(target.dpiStages, current.dpiStages)) {
+            write("DPI stages", [=]() {
+                device->setDPIStages(target.activeStage, target.dpiStages);
+            });
+        }
+    } else if (target.hasDpi && device->hasFeature("dpi")) {
+        if (!current.hasDpi || !dpiEqual(target.dpi, current.dpi)) {
+            write("DPI", [=]() {
+                device->setDPI(target.dpi);
+            });
+        }
+    }
+
+    if (target.hasPollRate && device->hasFeature("poll_rate")
+        && (!current.hasPollRate || target.pollRate != current.pollRate)) {
+        write("polling rate", [=]() {
+            device->setPollRate(target.pollRate);
+        });
+    }
+
+    if (target.hasIdleTime && device->hasFeature("idle_time")
+        && (!current.hasIdleTime || target.idleTime != current.idleTime)) {
+        write("idle time", [=]() {
+            device->setIdleTime(target.idleTime);
+        });
+    }
+
+    if (target.hasLowBatteryThreshold && device->hasFeature("low_battery_threshold")
+        && (!current.hasLowBatteryThreshold || target.lowBatteryThreshold != current.lowBatteryThreshold)) {
+        write("low battery threshold", [=]() {
+            device->setLowBatteryThreshold(target.lowBatteryThreshold);
+        });
+    }
+
+    return result;
+}
@@ -0,0 +1,63 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROFILEAPPLIER_H
+#define PROFILEAPPLIER_H
+
+#include "profile.h"
+
+#include <QObject>
+#include <QStringList>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+
+struct ProfileApplyResult {
+    QString serial;
+    QString deviceName;
+    /* The profile doesn't contain any settings for this device */
+    bool skipped = false;
+    int changedSettings = 0;
+    QStringList errors;
+};
+
+/*
+ * Applies a profile to the connected devices.
+ *
+ * Every device is handled as one batch in its command queue, so slow
+ * devices don't hold up the others. Only settings that differ from the current
+ * state of the device get written. When a new profile is applied while
+ * another one is still running, only the latest one is applied afterwards.
+ */
+class ProfileApplier : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProfileApplier(DeviceCommandQueue *commandQueue, QObject *parent = nullptr);
+    ~ProfileApplier() override;
+
+    void apply(const Profile &profile, const QList<libopenrazer::Device *> &devices);
+    bool isRunning() const;
+    /* Has to be called before the device gets deleted */
+    void removeDevice(libopenrazer::Device *device);
+
+signals:
+    void deviceFinished(const QString &profileName, const ProfileApplyResult &result);
+    void finished(const QString &profileName, const QVector<ProfileApplyResult> &results);
+
+private:
+    DeviceCommandQueue *commandQueue;
+
+    bool running;
+    int remaining;
+    QVector<ProfileApplyResult> results;
+
+    bool hasQueued;
+    Profile queuedProfile;
+    QList<libopenrazer::Device *> queuedDevices;
+
+    static ProfileApplyResult applyToDevice(libopenrazer::Device *device, const Profile &profile);
+};
+
+#endif // PROFILEAPPLIER_H
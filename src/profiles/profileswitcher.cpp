@@ -0,0 +1,115 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "profileswitcher.h"
+
+#include "processwatcher.h"
+
+#include <QSet>
+
+ProfileSwitcher::ProfileSwitcher(QObject *parent)
+    : QObject(parent)
+{
+    watcher = new ProcessWatcher(this);
+    connect(watcher, &ProcessWatcher::processStarted, this, &ProfileSwitcher::processStarted);
+    connect(watcher, &ProcessWatcher::processExited, this, &ProfileSwitcher::processExited);
+
+    reloadRules();
+}
+
+ProfileSwitcher::~ProfileSwitcher() = default;
+
+void ProfileSwitcher::reloadRules()
+{
+    rules = loadRules();
+    defaultProfile = settings.value("defaultProfile").toString();
+
+    // Forget about applications that don't have a rule anymore
+    QMutableListIterator<QPair<qint64, QString>> i(runningApplications);
+    while (i.hasNext()) {
+        if (!rules.contains(i.next().second))
+            i.remove();
+    }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 14, 0))
+    QList<QString> names = rules.keys();
+    watcher->setWatchedNames(QSet<QString>(names.begin(), names.end()));
+#else
+    watcher->setWatchedNames(rules.keys().toSet());
+#endif
+}
+
+QHash<QString, QString> ProfileSwitcher::loadRules()
+{
+    QSettings settings;
+    QHash<QString, QString> rules;
+
+    int size = settings.beginReadArray("applicationProfiles");
+    for (int i = 0; i < size; i++) {
+        settings.setArrayIndex(i);
+        QString application = settings.value("application").toString();
+        QString profile = settings.value("profile").toString();
+        if (!application.isEmpty() && !profile.isEmpty())
+            rules.insert(application, profile);
+    }
+    settings.endArray();
+
+    return rules;
+}
+
+void ProfileSwitcher::saveRules(const QHash<QString, QString> &rules)
+{
+    QSettings settings;
+
+    settings.remove("applicationProfiles");
+    settings.beginWriteArray("applicationProfiles", rules.size());
+    int i = 0;
+    QHashIterator<QString, QString> it(rules);
+    while (it.hasNext()) {
+        it.next();
+        settings.setArrayIndex(i++);
+        settings.setValue("application", it.key());
+        settings.setValue("profile", it.value());
+    }
+    settings.endArray();
+}
+
+void ProfileSwitcher::processStarted(qint64 pid, const QString &name)
+{
+    if (!rules.contains(name))
+        return;
+
+    qInfo("ProfileSwitcher: %s (%lld) started", qUtf8Printable(name), pid);
+    runningApplications.append(qMakePair(pid, name));
+    switchTo(rules.value(name));
+}
+
+void ProfileSwitcher::processExited(qint64 pid, const QString &name)
+{
+    bool wasActive = !runningApplications.isEmpty() && runningApplications.last().first == pid;
+    runningApplications.removeAll(qMakePair(pid, name));
+
+    qInfo("ProfileSwitcher: %s (%lld) exited", qUtf8Printable(name), pid);
+
+    if (!wasActive)
+        return;
+
+    // Go back to the profile of the application started before, or the default one
+    if (!runningApplications.isEmpty()) {
+        switchTo(rules.value(runningApplications.last().second));
+    } else if (!defaultProfile.isEmpty()) {
+        switchTo(defaultProfile);
+    } else {
+        currentProfile.clear();
+    }
+}
+
+void ProfileSwitcher::switchTo(const QString &profile)
+{
+    if (profile == currentProfile)
+        return;
+
+    currentProfile = profile;
+    emit switchProfile(profile);
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef PROFILESWITCHER_H
+#define PROFILESWITCHER_H
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QSettings>
+
+class ProcessWatcher;
+
+/*
+ * Switches profiles while applications are running, based on rules that
+ * map executable names to profile names.
+ *
+ * When the last matching application exits, the default profile is applied
+ * again. If several matching applications are running, the most recently
+ * started one wins.
+ */
+class ProfileSwitcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ProfileSwitcher(QObject *parent = nullptr);
+    ~ProfileSwitcher() override;
+
+    /* Re-read the rules and the default profile from the settings */
+    void reloadRules();
+
+    static QHash<QString, QString> loadRules();
+    static void saveRules(const QHash<QString, QString> &rules);
+
+signals:
+    void switchProfile(const QString &name);
+
+private:
+    QSettings settings;
+    ProcessWatcher *watcher;
+
+    QHash<QString, QString> rules;
+    QString defaultProfile;
+    QString currentProfile;
+    QList<QPair<qint64, QString>> runningApplications;
+
+    void processStarted(qint64 pid, const QString &name);
+    void processExited(qint64 pid, const QString &name);
+    void switchTo(const QString &profile);
+};
+
+#endif // PROFILESWITCHER_H
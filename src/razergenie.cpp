@@ -4,180 +4,276 @@
 
 #include "razergenie.h"
 
-#include "devicelistwidget.h"
+#include "devicecommandqueue.h"
+#include "devicelistdelegate.h"
+#include "devicelistmodel.h"
+#include "customeditor/customeditor.h"
 #include "devicewidget/devicewidget.h"
+#include "memoryreport.h"
+#include "notificationbar.h"
 #include "preferences/preferences.h"
+#include "profiles/profileswitcher.h"
 #include "razerimagedownloader.h"
 #include "util.h"
 
-#include <QDBusServiceWatcher>
 #include <QtWidgets>
 #include <config.h>
+#include <cstdio>
 
 const char *newIssueUrl = "https://github.com/openrazer/openrazer/issues/new/choose";
 const char *supportedDevicesUrl = "https://github.com/openrazer/openrazer/blob/master/README.md#device-support";
 const char *troubleshootingUrl = "https://github.com/openrazer/openrazer/wiki/Troubleshooting";
 const char *websiteUrl = "https://openrazer.github.io/";
 
-RazerGenie::RazerGenie(QWidget *parent)
+RazerGenie::RazerGenie(BackgroundServices *services, QWidget *parent)
     : QWidget(parent)
 {
     // Set the directory of the application to where the application is located. Needed for the custom editor and relative paths.
     QDir::setCurrent(QCoreApplication::applicationDirPath());
 
-    /* Migrate setting values */
-    if (settings.contains("noAutostartDaemon")) {
-        qInfo() << "Migrating setting key noAutostartDaemon...";
-        settings.setValue("askAutostartDaemon", !settings.value("noAutostartDaemon").toBool());
-        settings.remove("noAutostartDaemon");
-    }
+    this->services = services;
+    connect(services, &BackgroundServices::managerChanged, this, &RazerGenie::managerChanged);
+    connect(services, &BackgroundServices::daemonRunningChanged, this, &RazerGenie::daemonRunningChanged);
 
-    QString backend = settings.value("backend").toString();
-    if (backend == "OpenRazer") {
-        manager = new libopenrazer::openrazer::Manager();
-    } else if (backend == "razer_test") {
-        manager = new libopenrazer::razer_test::Manager();
-    } else {
-        qWarning() << "Invalid backend value. Using openrazer backend.";
-        manager = new libopenrazer::openrazer::Manager();
-    }
+    setupContent();
+}
+
+RazerGenie::~RazerGenie() = default;
 
+void RazerGenie::setupContent()
+{
     // What to do:
     // If disabled, popup to enable : "The daemon service is not auto-started. Press this button to use the full potential of the daemon right after login." => DONE
     // If enabled: Do nothing => DONE
     // If not_installed: "The daemon is not installed (or the version is too old). Please follow the instructions on the website https://openrazer.github.io/"
     // If no_systemd: Check if daemon is not running: "It seems you are not using systemd as your init system. You have to find a way to auto-start the daemon yourself."
-    libopenrazer::DaemonStatus daemonStatus = manager->getDaemonStatus();
+    std::function<libopenrazer::DaemonStatus(libopenrazer::Manager *)> getDaemonStatus = [](libopenrazer::Manager *manager) {
+        return manager->getDaemonStatus();
+    };
 
     // Check if daemon available
-    if (!manager->isDaemonRunning()) {
-        // Build a UI depending on what the status is.
-
-        if (daemonStatus == libopenrazer::DaemonStatus::NotInstalled) {
-            auto *boxLayout = new QVBoxLayout(this);
-            QLabel *titleLabel = new QLabel(tr("The OpenRazer daemon is not installed"));
-            QLabel *textLabel = new QLabel(tr("The daemon is not installed or the version installed is too old. Please follow the installation instructions on the website!\n\nIf you are running RazerGenie as a flatpak, you will still have to install OpenRazer outside of flatpak from a distribution package."));
-            QPushButton *button = new QPushButton(tr("Open OpenRazer website"));
-            connect(button, &QPushButton::pressed, this, &RazerGenie::openWebsiteUrl);
-            QPushButton *settingsButton = new QPushButton(tr("Open settings"));
-            connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
-
-            boxLayout->setAlignment(Qt::AlignTop);
-
-            QFont titleFont("Arial", 18, QFont::Bold);
-            titleLabel->setFont(titleFont);
-
-            boxLayout->addWidget(titleLabel);
-            boxLayout->addWidget(textLabel);
-            boxLayout->addWidget(button);
-            boxLayout->addWidget(settingsButton);
-        } else if (daemonStatus == libopenrazer::DaemonStatus::NoSystemd) {
-            auto *boxLayout = new QVBoxLayout(this);
-            QLabel *titleLabel = new QLabel(tr("The OpenRazer daemon is not available."));
-            QLabel *textLabel = new QLabel(tr("The OpenRazer daemon is not started and you are not using systemd as your init system.\nYou have to either start the daemon manually every time you log in or set up another method of autostarting the daemon.\n\nPlease consult the documentation for details."));
-            QPushButton *settingsButton = new QPushButton(tr("Open settings"));
-            connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
-
-            boxLayout->setAlignment(Qt::AlignTop);
-
-            QFont titleFont("Arial", 18, QFont::Bold);
-            titleLabel->setFont(titleFont);
-
-            boxLayout->addWidget(titleLabel);
-            boxLayout->addWidget(textLabel);
-            boxLayout->addWidget(settingsButton);
-        } else { // Daemon status here can be enabled, unknown (and potentially disabled)
-            auto *gridLayout = new QGridLayout(this);
-            QLabel *label = new QLabel(tr("The OpenRazer daemon is currently not available. The status output is below."));
-            auto *textEdit = new QTextEdit();
-            QLabel *issueLabel = new QLabel(tr("If you think, there's a bug, you can report an issue on GitHub:"));
-            QPushButton *issueButton = new QPushButton(tr("Report issue"));
-            connect(issueButton, &QPushButton::pressed, this, &RazerGenie::openIssueUrl);
-            QPushButton *settingsButton = new QPushButton(tr("Open settings"));
-            connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
-
-            textEdit->setReadOnly(true);
-            textEdit->setText(manager->getDaemonStatusOutput());
-
-            gridLayout->addWidget(label, 0, 1, 1, 3);
-            gridLayout->addWidget(textEdit, 1, 1, 1, 3);
-            gridLayout->addWidget(issueLabel, 2, 1);
-            gridLayout->addWidget(issueButton, 2, 2);
-            gridLayout->addWidget(settingsButton, 2, 3);
-        }
+    if (!services->isDaemonRunning()) {
         this->resize(1024, 600);
         this->setMinimumSize(QSize(800, 500));
         this->setWindowTitle("RazerGenie");
-    } else {
-        // Set up the normal UI
-        setupUi();
-
-        if (daemonStatus == libopenrazer::DaemonStatus::Disabled
-            && settings.value("askAutostartDaemon", true).toBool()) {
-            QMessageBox msgBox;
-            msgBox.setText(tr("The OpenRazer daemon is not set to auto-start. Click \"Enable\" to use the full potential of the daemon right after login."));
-            QPushButton *enableButton = msgBox.addButton(tr("Enable"), QMessageBox::ActionRole);
-            msgBox.addButton(QMessageBox::Ignore);
-            // Show message box
-            msgBox.exec();
-
-            if (msgBox.clickedButton() == enableButton) {
-                manager->enableDaemon();
-            } // ignore the cancel button
-        }
 
-        // Watch for dbus service changes (= daemon ends or gets started)
-        QDBusServiceWatcher *watcher = manager->getServiceWatcher();
+        // Build a UI depending on what the status is.
+        services->callManager<libopenrazer::DaemonStatus>(
+                this, getDaemonStatus,
+                [=](const libopenrazer::DaemonStatus &daemonStatus) { setupDaemonMissing(daemonStatus); },
+                [=]() { setupDaemonMissing(libopenrazer::DaemonStatus::Unknown); });
+        return;
+    }
 
-        connect(watcher, &QDBusServiceWatcher::serviceRegistered,
-                this, &RazerGenie::dbusServiceRegistered);
-        connect(watcher, &QDBusServiceWatcher::serviceUnregistered,
-                this, &RazerGenie::dbusServiceUnregistered);
+    // Set up the normal UI
+    setupUi();
+
+    if (!settings.value("askAutostartDaemon", true).toBool())
+        return;
+    services->callManager<libopenrazer::DaemonStatus>(this, getDaemonStatus, [=](const libopenrazer::DaemonStatus &daemonStatus) {
+        if (daemonStatus != libopenrazer::DaemonStatus::Disabled || !settings.value("askAutostartDaemon", true).toBool())
+            return;
+
+        // Asked only once, the preferences can turn it back on. The
+        // content gets rebuilt e.g. when the daemon comes back, so the
+        // flag is cleared right away instead of once it's answered.
+        settings.setValue("askAutostartDaemon", false);
+
+        auto *msgBox = new QMessageBox(this);
+        msgBox->setAttribute(Qt::WA_DeleteOnClose);
+        msgBox->setModal(false);
+        msgBox->setText(tr("The OpenRazer daemon is not set to auto-start. Click \"Enable\" to use the full potential of the daemon right after login."));
+        QPushButton *enableButton = msgBox->addButton(tr("Enable"), QMessageBox::ActionRole);
+        msgBox->addButton(QMessageBox::Ignore);
+        connect(msgBox, &QMessageBox::buttonClicked, this, [=](QAbstractButton *button) {
+            if (button == enableButton)
+                services->getManager()->enableDaemon();
+            // ignore the cancel button
+        });
+        msgBox->show();
+    });
+}
+
+void RazerGenie::setupDaemonMissing(libopenrazer::DaemonStatus daemonStatus)
+{
+    // The content was built again while the status was read
+    if (layout() != nullptr)
+        return;
+
+    if (daemonStatus == libopenrazer::DaemonStatus::NotInstalled) {
+        auto *boxLayout = new QVBoxLayout(this);
+        QLabel *titleLabel = new QLabel(tr("The OpenRazer daemon is not installed"));
+        QLabel *textLabel = new QLabel(tr("The daemon is not installed or the version installed is too old. Please follow the installation instructions on the website!\n\nIf you are running RazerGenie as a flatpak, you will still have to install OpenRazer outside of flatpak from a distribution package."));
+        QPushButton *button = new QPushButton(tr("Open OpenRazer website"));
+        connect(button, &QPushButton::pressed, this, &RazerGenie::openWebsiteUrl);
+        QPushButton *settingsButton = new QPushButton(tr("Open settings"));
+        connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
+
+        boxLayout->setAlignment(Qt::AlignTop);
+
+        QFont titleFont("Arial", 18, QFont::Bold);
+        titleLabel->setFont(titleFont);
+
+        boxLayout->addWidget(titleLabel);
+        boxLayout->addWidget(textLabel);
+        boxLayout->addWidget(button);
+        boxLayout->addWidget(settingsButton);
+    } else if (daemonStatus == libopenrazer::DaemonStatus::NoSystemd) {
+        auto *boxLayout = new QVBoxLayout(this);
+        QLabel *titleLabel = new QLabel(tr("The OpenRazer daemon is not available."));
+        QLabel *textLabel = new QLabel(tr("The OpenRazer daemon is not started and you are not using systemd as your init system.\nYou have to either start the daemon manually every time you log in or set up another method of autostarting the daemon.\n\nPlease consult the documentation for details."));
+        QPushButton *settingsButton = new QPushButton(tr("Open settings"));
+        connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
+
+        boxLayout->setAlignment(Qt::AlignTop);
+
+        QFont titleFont("Arial", 18, QFont::Bold);
+        titleLabel->setFont(titleFont);
+
+        boxLayout->addWidget(titleLabel);
+        boxLayout->addWidget(textLabel);
+        boxLayout->addWidget(settingsButton);
+    } else { // Daemon status here can be enabled, unknown (and potentially disabled)
+        auto *gridLayout = new QGridLayout(this);
+        QLabel *label = new QLabel(tr("The OpenRazer daemon is currently not available. The status output is below."));
+        auto *textEdit = new QTextEdit();
+        QLabel *issueLabel = new QLabel(tr("If you think, there's a bug, you can report an issue on GitHub:"));
+        QPushButton *issueButton = new QPushButton(tr("Report issue"));
+        connect(issueButton, &QPushButton::pressed, this, &RazerGenie::openIssueUrl);
+        QPushButton *settingsButton = new QPushButton(tr("Open settings"));
+        connect(settingsButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
+
+        textEdit->setReadOnly(true);
+        textEdit->setText(tr("Loading..."));
+        services->callManager<QString>(
+                textEdit, [](libopenrazer::Manager *manager) { return manager->getDaemonStatusOutput(); },
+                [=](const QString &output) { textEdit->setText(output); },
+                [=]() { textEdit->setText(tr("The status output couldn't be read.")); });
+
+        gridLayout->addWidget(label, 0, 1, 1, 3);
+        gridLayout->addWidget(textEdit, 1, 1, 1, 3);
+        gridLayout->addWidget(issueLabel, 2, 1);
+        gridLayout->addWidget(issueButton, 2, 2);
+        gridLayout->addWidget(settingsButton, 2, 3);
     }
 }
 
-RazerGenie::~RazerGenie()
+void RazerGenie::rebuildContent()
 {
-    QHashIterator<QDBusObjectPath, libopenrazer::Device *> i(devices);
-    while (i.hasNext()) {
-        i.next();
-        delete i.value();
+    // Only used while the screen about the missing daemon is shown. Dialogs
+    // like the preferences stay open.
+    for (QWidget *child : findChildren<QWidget *>(QString(), Qt::FindDirectChildrenOnly)) {
+        if (!child->isWindow())
+            delete child;
     }
+    delete layout();
+    setupContent();
 }
 
-void RazerGenie::setupUi()
+void RazerGenie::managerChanged(libopenrazer::Manager * /* newManager */)
 {
-    ui_main.setupUi(this);
+    if (deviceListModel == nullptr) {
+        // Only the screen about the missing daemon is shown, build the
+        // window again for the new backend
+        rebuildContent();
+        return;
+    }
 
-    ui_main.versionLabel->setText(tr("Daemon version: %1").arg(manager->getDaemonVersion()));
+    // Without the daemon the calls would only fail, daemonRunningChanged
+    // already put the controls into their waiting state
+    if (services->isDaemonRunning())
+        updateDaemonControls();
+}
 
-    fillDeviceList();
+void RazerGenie::daemonRunningChanged(bool running)
+{
+    if (deviceListModel == nullptr) {
+        // The daemon showed up while the screen about it missing is shown
+        if (running)
+            rebuildContent();
+        return;
+    }
 
-    // Connect signals
-    connect(ui_main.preferencesButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
-    connect(ui_main.syncCheckBox, &QCheckBox::clicked, this, &RazerGenie::toggleSync);
-    ui_main.syncCheckBox->setChecked(manager->getSyncEffects());
-    connect(ui_main.screensaverCheckBox, &QCheckBox::clicked, this, &RazerGenie::toggleOffOnScreesaver);
-    ui_main.screensaverCheckBox->setChecked(manager->getTurnOffOnScreensaver());
+    // The pages are kept while the daemon is gone, they just can't be used
+    ui_main.stackedWidget->setEnabled(running);
+    ui_main.profilesButton->setEnabled(running);
+    ui_main.syncCheckBox->setEnabled(running);
+    ui_main.screensaverCheckBox->setEnabled(running);
+
+    if (!running) {
+        ui_main.versionLabel->setText(tr("The daemon is not running, waiting for it to come back..."));
+        return;
+    }
 
-    connect(ui_main.listWidget, &QListWidget::currentRowChanged, ui_main.stackedWidget, &QStackedWidget::setCurrentIndex);
+    updateDaemonControls();
 
-    manager->connectDevicesChanged(this, SLOT(devicesChanged()));
+    // A page that couldn't be read while the daemon was gone gets another try
+    libopenrazer::Device *device = currentDevice();
+    if (device != nullptr && !devicePages.contains(device))
+        currentDeviceChanged(ui_main.listView->currentIndex());
 }
 
-void RazerGenie::dbusServiceRegistered(const QString &serviceName)
+void RazerGenie::updateDaemonControls()
 {
-    qInfo() << "Registered! " << serviceName;
-    fillDeviceList();
-    util::showInfo(tr("The D-Bus connection was re-established."));
+    services->callManager<QString>(
+            this, [](libopenrazer::Manager *manager) { return manager->getDaemonVersion(); },
+            [=](const QString &version) { ui_main.versionLabel->setText(tr("Daemon version: %1").arg(version)); });
+    services->callManager<bool>(
+            this, [](libopenrazer::Manager *manager) { return manager->getSyncEffects(); },
+            [=](const bool &sync) { ui_main.syncCheckBox->setChecked(sync); });
+    services->callManager<bool>(
+            this, [](libopenrazer::Manager *manager) { return manager->getTurnOffOnScreensaver(); },
+            [=](const bool &on) { ui_main.screensaverCheckBox->setChecked(on); });
 }
 
-void RazerGenie::dbusServiceUnregistered(const QString &serviceName)
+void RazerGenie::setupUi()
 {
-    qInfo() << "Unregistered! " << serviceName;
-    clearDeviceList();
-    // TODO: Show another placeholder screen with information that the daemon has been stopped?
-    util::showError(tr("The D-Bus connection was lost, which probably means that the daemon has crashed."));
+    ui_main.setupUi(this);
+
+    // Errors show up above everything else instead of in dialogs
+    ui_main.verticalLayout->insertWidget(0, new NotificationBar(this));
+
+    // Device list
+    deviceListModel = new DeviceListModel(services, this);
+    deviceListProxy = new QSortFilterProxyModel(this);
+    deviceListProxy->setSourceModel(deviceListModel);
+    deviceListProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    deviceListProxy->setSortCaseSensitivity(Qt::CaseInsensitive);
+    deviceListProxy->setSortLocaleAware(true);
+    deviceListProxy->sort(0);
+    ui_main.listView->setModel(deviceListProxy);
+    ui_main.listView->setItemDelegate(new DeviceListDelegate(ui_main.listView));
+    connect(ui_main.filterLineEdit, &QLineEdit::textChanged, deviceListProxy, &QSortFilterProxyModel::setFilterFixedString);
+    connect(ui_main.listView->selectionModel(), &QItemSelectionModel::currentChanged, this, &RazerGenie::currentDeviceChanged);
+
+    fillDeviceList();
+    connect(services, &BackgroundServices::deviceAdded, this, &RazerGenie::addDeviceToGui);
+    connect(services, &BackgroundServices::deviceRemoved, this, &RazerGenie::removeDeviceFromGui);
+    connect(services, &BackgroundServices::deviceReplaced, this, &RazerGenie::replaceDeviceInGui);
+    connect(services, &BackgroundServices::deviceReconnected, this, &RazerGenie::deviceReconnected);
+
+    // Connect signals
+    connect(ui_main.preferencesButton, &QPushButton::pressed, this, &RazerGenie::openPreferences);
+    connect(ui_main.syncCheckBox, &QCheckBox::clicked, this, &RazerGenie::toggleSync);
+    connect(ui_main.screensaverCheckBox, &QCheckBox::clicked, this, &RazerGenie::toggleOffOnScreesaver);
+    updateDaemonControls();
+
+    // Profiles
+    connect(services, &BackgroundServices::profileApplyStarted, this, [=](const QString &name) {
+        ui_main.profileStatusLabel->setText(tr("Applying profile %1...").arg(name));
+        ui_main.profileStatusLabel->setToolTip(QString());
+    });
+    connect(services->getProfileApplier(), &ProfileApplier::finished, this, &RazerGenie::profileApplied);
+
+    auto *profilesMenu = new QMenu(this);
+    ui_main.profilesButton->setMenu(profilesMenu);
+    connect(profilesMenu, &QMenu::aboutToShow, this, &RazerGenie::updateProfilesMenu);
+
+    // Debug action, not shown anywhere
+    auto *memoryReportAction = new QAction(tr("Memory report"), this);
+    memoryReportAction->setShortcut(QKeySequence(Qt::CTRL + Qt::SHIFT + Qt::Key_M));
+    connect(memoryReportAction, &QAction::triggered, this, &RazerGenie::showMemoryReport);
+    addAction(memoryReportAction);
 }
 
 /**
@@ -217,135 +313,169 @@ QList<QPair<int, int>> RazerGenie::getConnectedDevices_lsusb()
 
 void RazerGenie::fillDeviceList()
 {
-    // Get all connected devices
-    QList<QDBusObjectPath> devicePaths = manager->getDevices();
+    QList<libopenrazer::Device *> devices = services->getDevices();
 
     // Iterate through all devices
-    for (const QDBusObjectPath &devicePath : devicePaths) {
-        addDeviceToGui(devicePath);
+    for (libopenrazer::Device *device : devices) {
+        addDeviceToGui(device);
     }
 
-    if (devicePaths.size() == 0) {
+    if (devices.size() == 0) {
         // Add placeholder widget
         ui_main.stackedWidget->addWidget(getNoDevicePlaceholder());
     }
 }
 
-void RazerGenie::refreshDeviceList()
+void RazerGenie::addDeviceToGui(libopenrazer::Device *currentDevice)
 {
-    // LOGIC:
-    // - list of current
-    // - hash of old
-    // go through old
-    // if still in new, remove from new list
-    // if not in new, remove from both
-    // go through new (remaining items) list and add
-    QList<QDBusObjectPath> devicePaths = manager->getDevices();
-    QMutableHashIterator<QDBusObjectPath, libopenrazer::Device *> i(devices);
-    while (i.hasNext()) {
-        i.next();
-        if (devicePaths.contains(i.key())) {
-            qDebug() << "Keep: " << i.key().path();
-            devicePaths.removeOne(i.key());
-        } else {
-            libopenrazer::Device *dev = i.value();
-            qDebug() << "Remove: " << i.key().path();
-            devicePaths.removeOne(i.key());
-            removeDeviceFromGui(i.key());
-            devices.remove(i.key());
-            delete dev;
-        }
-    }
-    QListIterator<QDBusObjectPath> j(devicePaths);
-    while (j.hasNext()) {
-        QDBusObjectPath devicePath = j.next();
-        qDebug() << "Add: " << devicePath.path();
-        addDeviceToGui(devicePath);
+    if (deviceListModel->rowCount() == 0 && noDevicePlaceholder != nullptr) {
+        // Remove placeholder widget if inserted.
+        ui_main.stackedWidget->removeWidget(noDevicePlaceholder);
     }
+
+    // Add new device to the list, the model takes care of the image. The
+    // page only gets built once the device is selected.
+    deviceListModel->addDevice(currentDevice);
+
+    // Keep the list selection in line with the page that's shown
+    if (!ui_main.listView->currentIndex().isValid())
+        ui_main.listView->setCurrentIndex(deviceListProxy->mapFromSource(deviceListModel->indexOf(currentDevice)));
 }
 
-void RazerGenie::clearDeviceList()
+bool RazerGenie::removeDeviceFromGui(libopenrazer::Device *device)
 {
-    // Clear devices QHash
-    devices.clear();
-    // Clear device list
-    ui_main.listWidget->clear();
-    // Clear stackedwidget
-    for (int i = ui_main.stackedWidget->count(); i >= 0; i--) {
-        QWidget *widget = ui_main.stackedWidget->widget(i);
-        ui_main.stackedWidget->removeWidget(widget);
-        widget->deleteLater();
+    QModelIndex index = deviceListModel->indexOf(device);
+    if (!index.isValid()) {
+        return false;
     }
-    // Add placeholder widget
-    // TODO: Add placeholder widget with crash information and link to bug report?
-    ui_main.stackedWidget->addWidget(getNoDevicePlaceholder());
+
+    // The device gets deleted right after this, so the page has to go now
+    destroyDevicePage(device);
+    savedViewStates.remove(device);
+    deviceListModel->removeDevice(device);
+
+    // Add placeholder widget if the stackedWidget is empty after removing.
+    if (deviceListModel->rowCount() == 0) {
+        ui_main.stackedWidget->addWidget(getNoDevicePlaceholder());
+    }
+    return true;
 }
 
-void RazerGenie::addDeviceToGui(const QDBusObjectPath &devicePath)
+void RazerGenie::replaceDeviceInGui(libopenrazer::Device *oldDevice, libopenrazer::Device *newDevice)
 {
-    // Create device instance with current serial
-    libopenrazer::Device *currentDevice = manager->getDevice(devicePath);
+    // The page can't be moved to the new device, it's rebuilt from its view state instead
+    bool current = currentDevice() == oldDevice;
+    if (devicePages.contains(oldDevice))
+        savedViewStates.insert(newDevice, devicePages.value(oldDevice)->saveViewState());
+    else if (savedViewStates.contains(oldDevice))
+        savedViewStates.insert(newDevice, savedViewStates.value(oldDevice));
+
+    destroyDevicePage(oldDevice);
+    savedViewStates.remove(oldDevice);
+    deviceListModel->replaceDevice(oldDevice, newDevice);
+
+    if (current)
+        currentDeviceChanged(ui_main.listView->currentIndex());
+}
 
-    if (devices.isEmpty()) {
-        // Remove placeholder widget if inserted.
-        QWidget *widget = ui_main.stackedWidget->widget(0);
-        if (widget != nullptr)
-            ui_main.stackedWidget->removeWidget(widget);
-    }
+void RazerGenie::deviceReconnected(libopenrazer::Device *device)
+{
+    // The page keeps working with the same handle, only its settings might be outdated
+    DeviceWidget *widget = devicePages.value(device);
+    if (widget != nullptr)
+        widget->refreshState();
+}
 
-    // Add new device to the list
-    auto *listItem = new QListWidgetItem();
-    listItem->setSizeHint(QSize(/* any small width */ 1, 120));
-    ui_main.listWidget->addItem(listItem);
-    auto *listItemWidget = new DeviceListWidget(ui_main.listWidget, currentDevice);
-    ui_main.listWidget->setItemWidget(listItem, listItemWidget);
-
-    // Insert current device pointer with serial lookup into a QHash
-    devices.insert(devicePath, currentDevice);
-
-    // Download image for device
-    if (!currentDevice->getDeviceImageUrl().isEmpty()) {
-        RazerImageDownloader *dl = new RazerImageDownloader(QUrl(currentDevice->getDeviceImageUrl()), this);
-        connect(dl, &RazerImageDownloader::downloadFinished, listItemWidget, &DeviceListWidget::imageDownloaded);
-        connect(dl, &RazerImageDownloader::downloadErrored, listItemWidget, &DeviceListWidget::imageDownloadErrored);
-        dl->startDownload();
-    } else {
-        qWarning() << "Device image for" << currentDevice->getDeviceName() << "is missing.";
-        listItemWidget->setNoImage();
+libopenrazer::Device *RazerGenie::currentDevice() const
+{
+    return deviceListModel->device(deviceListProxy->mapToSource(ui_main.listView->currentIndex()));
+}
+
+void RazerGenie::currentDeviceChanged(const QModelIndex &current)
+{
+    libopenrazer::Device *device = deviceListModel->device(deviceListProxy->mapToSource(current));
+    if (device == nullptr)
+        return;
+
+    DeviceWidget *widget = devicePages.value(device);
+    if (widget == nullptr) {
+        // The page gets built once its state was read
+        ui_main.stackedWidget->setCurrentWidget(getLoadingPlaceholder());
+        getLoadingPlaceholder()->setText(tr("Loading device..."));
+        loadDevicePage(device);
+        return;
     }
+    ui_main.stackedWidget->setCurrentWidget(widget);
+
+    // Most recently viewed first
+    recentDevicePages.removeOne(device);
+    recentDevicePages.prepend(device);
+    evictDevicePages();
+}
 
-    /* Create actual DeviceWidget */
-    auto *widget = new DeviceWidget(currentDevice);
+void RazerGenie::loadDevicePage(libopenrazer::Device *device)
+{
+    if (loadingPages.contains(device))
+        return;
+    loadingPages.insert(device);
+
+    services->getCommandQueue()->read<PageState>(
+            device, this, [=]() { return PageState::read(device); },
+            [=](const PageState &state) {
+                loadingPages.remove(device);
+                showDevicePage(device, state);
+            },
+            [=](const QString &error) {
+                loadingPages.remove(device);
+                if (currentDevice() == device)
+                    getLoadingPlaceholder()->setText(tr("Failed to read the device: %1").arg(error));
+            });
+}
 
-    // Add the new widget to the stacked widget
+void RazerGenie::showDevicePage(libopenrazer::Device *device, const PageState &state)
+{
+    // Only build the page if it's still wanted, the view state stays saved otherwise
+    if (currentDevice() != device || devicePages.contains(device))
+        return;
+
+    DeviceWidget *widget = new DeviceWidget(device, state, services->getCommandQueue(), services->getBatteryMonitor());
     ui_main.stackedWidget->addWidget(widget);
+    devicePages.insert(device, widget);
+    if (savedViewStates.contains(device))
+        widget->restoreViewState(savedViewStates.take(device));
+
+    currentDeviceChanged(ui_main.listView->currentIndex());
 }
 
-bool RazerGenie::removeDeviceFromGui(const QDBusObjectPath &devicePath)
+void RazerGenie::evictDevicePages()
 {
-    int index = -1;
-    for (int i = 0; i < ui_main.listWidget->count(); i++) {
-        // get item for index
-        QListWidgetItem *item = ui_main.listWidget->item(i);
-        // get itemwidget for the item
-        auto *widget = dynamic_cast<DeviceListWidget *>(ui_main.listWidget->itemWidget(item));
-        // compare serial
-        if (widget->device()->objectPath() == devicePath) {
-            index = i;
-            break;
-        }
-    }
-    if (index == -1) {
-        return false;
+    int maxPages = qMax(1, settings.value("maxDevicePages", 4).toInt());
+    while (recentDevicePages.size() > maxPages) {
+        libopenrazer::Device *device = recentDevicePages.last();
+        savedViewStates.insert(device, devicePages.value(device)->saveViewState());
+        destroyDevicePage(device);
     }
-    ui_main.stackedWidget->removeWidget(ui_main.stackedWidget->widget(index));
-    delete ui_main.listWidget->takeItem(index);
+}
 
-    // Add placeholder widget if the stackedWidget is empty after removing.
-    if (devices.isEmpty()) {
-        ui_main.stackedWidget->addWidget(getNoDevicePlaceholder());
+void RazerGenie::destroyDevicePage(libopenrazer::Device *device)
+{
+    recentDevicePages.removeOne(device);
+    DeviceWidget *widget = devicePages.take(device);
+    if (widget == nullptr)
+        return;
+    ui_main.stackedWidget->removeWidget(widget);
+    delete widget;
+}
+
+QLabel *RazerGenie::getLoadingPlaceholder()
+{
+    if (loadingPlaceholder == nullptr) {
+        loadingPlaceholder = new QLabel(this);
+        loadingPlaceholder->setAlignment(Qt::AlignCenter);
+        loadingPlaceholder->setWordWrap(true);
+        ui_main.stackedWidget->addWidget(loadingPlaceholder);
     }
-    return true;
+    return loadingPlaceholder;
 }
 
 QWidget *RazerGenie::getNoDevicePlaceholder()
@@ -355,60 +485,17 @@ QWidget *RazerGenie::getNoDevicePlaceholder()
     }
     // Generate placeholder widget with text "No device is connected.". Maybe add a usb pid check - at least add link to readme and troubleshooting page. Maybe add support for the future daemon troubleshooting option.
 
-    QList<QPair<int, int>> connectedDevices = getConnectedDevices_lsusb();
-    QList<QPair<int, int>> matches;
-
-    // Don't even iterate if there are no devices detected by lsusb.
-    if (connectedDevices.count() != 0) {
-        QHashIterator<QString, QVariant> i(manager->getSupportedDevices());
-        // Iterate through the supported devices
-        while (i.hasNext()) {
-            i.next();
-            QList<QVariant> list = i.value().toList();
-            if (list.count() != 2) {
-                qWarning() << "RazerGenie: Error while iterating through supportedDevices";
-                qWarning() << list;
-                continue;
-            }
-            int vid = list[0].toInt();
-            int pid = list[1].toInt();
-
-            QListIterator<QPair<int, int>> j(connectedDevices);
-            while (j.hasNext()) {
-                QPair<int, int> x = j.next();
-                if (x.first == vid && x.second == pid) {
-                    qDebug() << "Found a device match!";
-                    matches.append(x);
-                }
-            }
-        }
-    }
-
     noDevicePlaceholder = new QWidget();
     auto *boxLayout = new QVBoxLayout(noDevicePlaceholder);
     boxLayout->setAlignment(Qt::AlignTop);
 
     QFont headerFont("Arial", 15, QFont::Bold);
-    QLabel *headerLabel;
-    QLabel *textLabel;
-    QPushButton *button1;
-    QPushButton *button2;
-    if (matches.size() == 0) {
-        headerLabel = new QLabel(tr("No device was detected"));
-        textLabel = new QLabel(tr("The OpenRazer daemon didn't detect a device that is supported.\nThis could also be caused due to a misconfiguration of this PC."));
-        button1 = new QPushButton(tr("Open supported devices"));
-        connect(button1, &QPushButton::pressed, this, &RazerGenie::openSupportedDevicesUrl);
-        button2 = new QPushButton(tr("Report issue"));
-        connect(button2, &QPushButton::pressed, this, &RazerGenie::openIssueUrl);
-    } else {
-        headerLabel = new QLabel(tr("The daemon didn't detect a device that is connected"));
-        textLabel = new QLabel(tr("Linux detected connected devices but the daemon didn't. This could be either due to a permission problem or a kernel module problem."));
-        qDebug() << matches;
-        button1 = new QPushButton(tr("Open troubleshooting page"));
-        connect(button1, &QPushButton::pressed, this, &RazerGenie::openTroubleshootingUrl);
-        button2 = new QPushButton(tr("Report issue"));
-        connect(button2, &QPushButton::pressed, this, &RazerGenie::openIssueUrl);
-    }
+    QLabel *headerLabel = new QLabel(tr("No device was detected"));
+    QLabel *textLabel = new QLabel(tr("The OpenRazer daemon didn't detect a device that is supported.\nThis could also be caused due to a misconfiguration of this PC."));
+    QPushButton *button1 = new QPushButton(tr("Open supported devices"));
+    connect(button1, &QPushButton::pressed, this, &RazerGenie::openSupportedDevicesUrl);
+    QPushButton *button2 = new QPushButton(tr("Report issue"));
+    connect(button2, &QPushButton::pressed, this, &RazerGenie::openIssueUrl);
     headerLabel->setFont(headerFont);
 
     boxLayout->addWidget(headerLabel);
@@ -417,39 +504,276 @@ QWidget *RazerGenie::getNoDevicePlaceholder()
     hbox->addWidget(button1);
     hbox->addWidget(button2);
     boxLayout->addLayout(hbox);
+
+    // lsusb and the daemon are asked off the UI thread, the text changes if
+    // Linux sees a supported device that the daemon doesn't
+    services->callManager<int>(
+            noDevicePlaceholder, [](libopenrazer::Manager *manager) {
+                QList<QPair<int, int>> connectedDevices = getConnectedDevices_lsusb();
+                QList<QPair<int, int>> matches;
+
+                // Don't even iterate if there are no devices detected by lsusb.
+                if (connectedDevices.count() == 0)
+                    return 0;
+
+                QHashIterator<QString, QVariant> i(manager->getSupportedDevices());
+                // Iterate through the supported devices
+                while (i.hasNext()) {
+                    i.next();
+                    QList<QVariant> list = i.value().toList();
+                    if (list.count() != 2) {
+                        qWarning() << "RazerGenie: Error while iterating through supportedDevices";
+                        qWarning() << list;
+                        continue;
+                    }
+                    int vid = list[0].toInt();
+                    int pid = list[1].toInt();
+
+                    QListIterator<QPair<int, int>> j(connectedDevices);
+                    while (j.hasNext()) {
+                        QPair<int, int> x = j.next();
+                        if (x.first == vid && x.second == pid) {
+                            qDebug() << "Found a device match!";
+                            matches.append(x);
+                        }
+                    }
+                }
+                qDebug() << matches;
+                return matches.size();
+            },
+            [=](const int &matches) {
+                if (matches == 0)
+                    return;
+                headerLabel->setText(tr("The daemon didn't detect a device that is connected"));
+                textLabel->setText(tr("Linux detected connected devices but the daemon didn't. This could be either due to a permission problem or a kernel module problem."));
+                button1->setText(tr("Open troubleshooting page"));
+                button1->disconnect(this);
+                connect(button1, &QPushButton::pressed, this, &RazerGenie::openTroubleshootingUrl);
+            });
     return noDevicePlaceholder;
 }
 
 void RazerGenie::toggleSync(bool sync)
 {
-    try {
-        manager->syncEffects(sync);
-    } catch (const libopenrazer::DBusException &e) {
-        util::showError(tr("Error while syncing devices."));
-    }
+    services->callManager<bool>(
+            this, [=](libopenrazer::Manager *manager) {
+                manager->syncEffects(sync);
+                return true;
+            },
+            [](const bool & /* success */) {},
+            [=]() { util::showError(tr("Error while syncing devices."), "sync"); });
 }
 
 void RazerGenie::toggleOffOnScreesaver(bool on)
 {
-    try {
-        manager->setTurnOffOnScreensaver(on);
-    } catch (const libopenrazer::DBusException &e) {
-        util::showError(tr("Error while toggling 'turn off on screensaver'"));
-    }
+    services->callManager<bool>(
+            this, [=](libopenrazer::Manager *manager) {
+                manager->setTurnOffOnScreensaver(on);
+                return true;
+            },
+            [](const bool & /* success */) {},
+            [=]() { util::showError(tr("Error while toggling 'turn off on screensaver'"), "screensaver"); });
 }
 
 void RazerGenie::openPreferences()
 {
-    auto *prefs = new Preferences(manager, this);
+    auto *prefs = new Preferences(services, this);
     prefs->setWindowModality(Qt::WindowModal);
     prefs->setAttribute(Qt::WA_DeleteOnClose);
+    connect(prefs, &QDialog::finished, services->getProfileSwitcher(), &ProfileSwitcher::reloadRules);
+    connect(prefs, &QDialog::finished, this, &RazerGenie::evictDevicePages);
     prefs->show();
 }
 
-void RazerGenie::devicesChanged()
+void RazerGenie::showMemoryReport()
 {
-    qInfo() << "DEVICE HAVE CHANGED!";
-    refreshDeviceList();
+    auto *dialog = new QDialog(this);
+    dialog->setWindowTitle(tr("Memory report"));
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    auto *layout = new QVBoxLayout(dialog);
+
+    auto *textEdit = new QPlainTextEdit(createMemoryReport(), dialog);
+    textEdit->setReadOnly(true);
+    textEdit->setLineWrapMode(QPlainTextEdit::NoWrap);
+    textEdit->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    layout->addWidget(textEdit);
+
+    auto *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, dialog);
+    connect(buttonBox, &QDialogButtonBox::rejected, dialog, &QDialog::close);
+    layout->addWidget(buttonBox);
+
+    dialog->resize(800, 400);
+    dialog->show();
+}
+
+QString RazerGenie::createMemoryReport()
+{
+    MemoryReport report;
+
+    if (deviceListModel != nullptr) {
+        for (libopenrazer::Device *device : services->getDevices()) {
+            QString name = deviceListModel->indexOf(device).data(Qt::DisplayRole).toString();
+            if (devicePages.contains(device)) {
+                ObjectStats stats;
+                stats.addTree(devicePages.value(device));
+                report.addRow(tr("%1: page").arg(name), stats);
+            }
+            // The editors are windows of their own
+            for (QWidget *window : QApplication::topLevelWidgets()) {
+                auto *editor = qobject_cast<CustomEditor *>(window);
+                if (editor != nullptr && editor->getDevice() == device) {
+                    ObjectStats stats;
+                    stats.addTree(editor);
+                    report.addRow(tr("%1: custom editor").arg(name), stats);
+                }
+            }
+        }
+
+        // The rows are painted by the delegate, only their images are kept
+        ObjectStats listStats;
+        listStats.addTree(ui_main.listView);
+        for (int row = 0; row < deviceListModel->rowCount(); row++) {
+            QVariant decoration = deviceListModel->index(row).data(Qt::DecorationRole);
+            if (decoration.canConvert<QPixmap>() && !decoration.value<QPixmap>().isNull())
+                listStats.addPixmap(decoration.value<QPixmap>());
+            else if (decoration.canConvert<QImage>() && !decoration.value<QImage>().isNull())
+                listStats.addImage(decoration.value<QImage>());
+        }
+        report.addRow(tr("Device list"), listStats);
+    }
+
+    ObjectStats windowStats;
+    windowStats.addTree(this);
+    report.addRow(tr("Whole window"), windowStats);
+
+    return report.toString();
+}
+
+void RazerGenie::closeEvent(QCloseEvent *event)
+{
+    if (MemoryReport::isPrintOnCloseEnabled())
+        printf("%s\n", qUtf8Printable(createMemoryReport()));
+    QWidget::closeEvent(event);
+}
+
+void RazerGenie::applyProfile(const QString &name)
+{
+    if (!services->applyProfile(name))
+        util::showError(tr("Failed to load the profile \"%1\".").arg(name), "profiles");
+}
+
+void RazerGenie::saveProfile()
+{
+    bool ok;
+    QString name = QInputDialog::getText(this, tr("Save profile"), tr("Save the current settings of all devices as:"), QLineEdit::Normal, QString(), &ok);
+    if (!ok || name.trimmed().isEmpty())
+        return;
+    name = name.trimmed();
+
+    // Devices that can't be read keep what the replaced profile had for them
+    Profile previous;
+    if (Profile::list().contains(name)) {
+        QMessageBox::StandardButton button = QMessageBox::question(this, tr("Save profile"), tr("The profile \"%1\" already exists. Do you want to replace it?").arg(name));
+        if (button != QMessageBox::Yes)
+            return;
+        previous = Profile::load(name);
+    }
+    QHash<QString, DeviceState> previousDevices = previous.getDevices();
+
+    // Read all devices through their queues, the profile gets written once
+    // the last one answered
+    QList<libopenrazer::Device *> devices = services->getDevices();
+    auto profile = std::make_shared<Profile>(name);
+    auto remaining = std::make_shared<int>(devices.size() + 1);
+    auto failedDevices = std::make_shared<QStringList>();
+    auto deviceDone = [=]() {
+        if (--*remaining > 0)
+            return;
+        if (!profile->save()) {
+            util::showError(tr("Failed to save the profile \"%1\".").arg(name), "profiles");
+            return;
+        }
+        ui_main.profileStatusLabel->setText(tr("Profile %1 saved").arg(name));
+        if (!failedDevices->isEmpty()) {
+            ui_main.profileStatusLabel->setToolTip(failedDevices->join("\n"));
+            util::showError(tr("The profile \"%1\" was saved without the current settings of %n device(s), they couldn't be read.", nullptr, failedDevices->size()).arg(name), "profiles");
+        }
+    };
+    auto deviceFailed = [=](libopenrazer::Device *device, const QString &serial) {
+        failedDevices->append(services->getDeviceName(device));
+        if (previousDevices.contains(serial))
+            profile->setDeviceState(serial, previousDevices.value(serial));
+        deviceDone();
+    };
+
+    ui_main.profileStatusLabel->setText(tr("Saving profile %1...").arg(name));
+    ui_main.profileStatusLabel->setToolTip(QString());
+    for (libopenrazer::Device *device : devices) {
+        QString serial = services->getSerial(device);
+        if (serial.isEmpty()) {
+            qWarning("Failed to get serial");
+            deviceFailed(device, serial);
+            continue;
+        }
+        services->getCommandQueue()->read<DeviceState>(
+                device, this, [=]() { return DeviceState::read(device); },
+                [=](const DeviceState &state) {
+                    profile->setDeviceState(serial, state);
+                    deviceDone();
+                },
+                [=](const QString & /* error */) { deviceFailed(device, serial); });
+    }
+    // Also saves a profile without any devices
+    deviceDone();
+}
+
+void RazerGenie::updateProfilesMenu()
+{
+    QMenu *menu = ui_main.profilesButton->menu();
+    menu->clear();
+
+    QStringList profiles = Profile::list();
+    for (const QString &name : profiles) {
+        menu->addAction(name, this, [=]() { applyProfile(name); });
+    }
+    if (profiles.isEmpty()) {
+        menu->addAction(tr("No profiles saved"))->setEnabled(false);
+    }
+
+    menu->addSeparator();
+    menu->addAction(QIcon::fromTheme("document-save-symbolic"), tr("Save current settings as profile..."), this, &RazerGenie::saveProfile);
+
+    QMenu *deleteMenu = menu->addMenu(QIcon::fromTheme("edit-delete-symbolic"), tr("Delete profile"));
+    deleteMenu->setEnabled(!profiles.isEmpty());
+    for (const QString &name : profiles) {
+        deleteMenu->addAction(name, this, [=]() { Profile::remove(name); });
+    }
+}
+
+void RazerGenie::profileApplied(const QString &profileName, const QVector<ProfileApplyResult> &results)
+{
+    int failed = 0;
+    QStringList lines;
+    for (const ProfileApplyResult &result : results) {
+        if (result.skipped) {
+            lines << tr("%1: Not part of the profile").arg(result.deviceName);
+        } else if (!result.errors.isEmpty()) {
+            failed++;
+            lines << tr("%1: %2").arg(result.deviceName, result.errors.join(", "));
+        } else if (result.changedSettings == 0) {
+            lines << tr("%1: Already up to date").arg(result.deviceName);
+        } else {
+            lines << tr("%1: %2 settings changed").arg(result.deviceName).arg(result.changedSettings);
+        }
+    }
+
+    if (failed == 0) {
+        ui_main.profileStatusLabel->setText(tr("Profile %1 applied").arg(profileName));
+    } else {
+        qWarning("Failed to apply profile %s to %d device(s)", qUtf8Printable(profileName), failed);
+        ui_main.profileStatusLabel->setText(tr("Profile %1 failed on %2 device(s)").arg(profileName).arg(failed));
+    }
+    ui_main.profileStatusLabel->setToolTip(lines.join("\n"));
 }
 
 void RazerGenie::openIssueUrl()
@@ -5,16 +5,23 @@
 #ifndef RAZERGENIE_H
 #define RAZERGENIE_H
 
+#include "backgroundservices.h"
+#include "devicelistmodel.h"
+#include "devicewidget/devicewidget.h"
+#include "devicewidget/pagestate.h"
+#include "profiles/profileapplier.h"
 #include "ui_razergenie.h"
 
+#include <QSet>
 #include <QSettings>
+#include <QSortFilterProxyModel>
 #include <libopenrazer.h>
 
 class RazerGenie : public QWidget
 {
     Q_OBJECT
 public:
-    RazerGenie(QWidget *parent = nullptr);
+    RazerGenie(BackgroundServices *services, QWidget *parent = nullptr);
     ~RazerGenie() override;
 public slots:
     // General checkboxes
@@ -22,38 +29,68 @@ public slots:
     void toggleOffOnScreesaver(bool on);
 
     void openPreferences();
+    /* Debug aid, see MemoryReport */
+    void showMemoryReport();
 
-    void dbusServiceRegistered(const QString &serviceName);
-    void dbusServiceUnregistered(const QString &serviceName);
-
-    // device signals
-    void devicesChanged();
+    // Profiles
+    void applyProfile(const QString &name);
+    void saveProfile();
+    void updateProfilesMenu();
+    void profileApplied(const QString &profileName, const QVector<ProfileApplyResult> &results);
 
     void openIssueUrl();
     void openSupportedDevicesUrl();
     void openTroubleshootingUrl();
     void openWebsiteUrl();
 
+protected:
+    void closeEvent(QCloseEvent *event) override;
+
 private:
     Ui::RazerGenieUi ui_main;
+    void setupContent();
+    /* The screen shown instead of the devices while the daemon isn't running */
+    void setupDaemonMissing(libopenrazer::DaemonStatus daemonStatus);
+    void rebuildContent();
     void setupUi();
+    void managerChanged(libopenrazer::Manager *newManager);
+    void daemonRunningChanged(bool running);
+    void updateDaemonControls();
 
     QWidget *noDevicePlaceholder = nullptr;
+    /* Shown while the state of a device page is read */
+    QLabel *loadingPlaceholder = nullptr;
 
-    QList<QPair<int, int>> getConnectedDevices_lsusb();
+    static QList<QPair<int, int>> getConnectedDevices_lsusb();
 
     void fillDeviceList();
-    void refreshDeviceList();
-    void clearDeviceList();
 
-    void addDeviceToGui(const QDBusObjectPath &devicePath);
-    bool removeDeviceFromGui(const QDBusObjectPath &devicePath);
+    void addDeviceToGui(libopenrazer::Device *device);
+    bool removeDeviceFromGui(libopenrazer::Device *device);
+    void replaceDeviceInGui(libopenrazer::Device *oldDevice, libopenrazer::Device *newDevice);
+    void deviceReconnected(libopenrazer::Device *device);
+    libopenrazer::Device *currentDevice() const;
+    void currentDeviceChanged(const QModelIndex &current);
+    void loadDevicePage(libopenrazer::Device *device);
+    void showDevicePage(libopenrazer::Device *device, const PageState &state);
+    void evictDevicePages();
+    void destroyDevicePage(libopenrazer::Device *device);
     QWidget *getNoDevicePlaceholder();
+    QLabel *getLoadingPlaceholder();
+    QString createMemoryReport();
 
     void getRazerDevices();
 
-    QHash<QDBusObjectPath, libopenrazer::Device *> devices;
-    libopenrazer::Manager *manager;
+    BackgroundServices *services;
+
+    DeviceListModel *deviceListModel = nullptr;
+    QSortFilterProxyModel *deviceListProxy;
+    /* Pages of devices that haven't been viewed for a while get destroyed and
+     * are rebuilt from their saved view state when they're shown again */
+    QHash<libopenrazer::Device *, DeviceWidget *> devicePages;
+    QList<libopenrazer::Device *> recentDevicePages;
+    QHash<libopenrazer::Device *, DeviceWidget::ViewState> savedViewStates;
+    QSet<libopenrazer::Device *> loadingPages;
 
     QSettings settings;
 };
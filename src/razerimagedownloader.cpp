@@ -4,67 +4,355 @@
 
 #include "razerimagedownloader.h"
 
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <QImageReader>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
 #include <QStandardPaths>
+#include <QTimer>
+#include <cstdio>
 
-RazerImageDownloader::RazerImageDownloader(QUrl url, QObject *parent)
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+/* Suffix of files that are still being downloaded */
+static const char *partialSuffix = ".part";
+/* Suffix of the files with the HTTP metadata of a cached image */
+static const char *metadataSuffix = ".json";
+/* Time to wait after a request before revalidating anything */
+static const int revalidationDelay = 30 * 1000;
+/* Partial files older than this were left behind by a crash, in seconds.
+ * Younger ones might belong to another instance that's still downloading. */
+static const int partialFileMaxAge = 60 * 60;
+
+ImageDownload::ImageDownload(const QUrl &url, QObject *parent)
     : QObject(parent)
 {
-    manager = new QNetworkAccessManager(this);
     this->url = url;
 }
 
-void RazerImageDownloader::startDownload()
+ImageDownload::~ImageDownload() = default;
+
+QUrl ImageDownload::getUrl() const
+{
+    return url;
+}
+
+RazerImageDownloader::RazerImageDownloader(QObject *parent)
+    : QObject(parent)
 {
-    QString path = getDownloadPath();
-    // Create directory
-    QDir dir(path);
-    dir.mkpath(path);
+    running = 0;
+    revalidationReply = nullptr;
+
+    revalidationTimer = new QTimer(this);
+    revalidationTimer->setSingleShot(true);
+    revalidationTimer->setInterval(revalidationDelay);
+    connect(revalidationTimer, &QTimer::timeout, this, &RazerImageDownloader::startRevalidation);
 
-    _filepath = path + QFileInfo(url.path()).fileName();
-    _file = new QFile(_filepath);
-    if (_file->exists()) {
+    manager = new QNetworkAccessManager(this);
+    connect(manager, &QNetworkAccessManager::finished, this, &RazerImageDownloader::finished);
+
+    // Clean up after downloads that were interrupted by a crash
+    QDir dir(getDownloadPath());
+    QDateTime cutoff = QDateTime::currentDateTime().addSecs(-partialFileMaxAge);
+    for (const QFileInfo &info : dir.entryInfoList({ QString("*") + partialSuffix }, QDir::Files)) {
+        if (info.lastModified() < cutoff)
+            dir.remove(info.fileName());
+    }
+}
+
+RazerImageDownloader::~RazerImageDownloader()
+{
+    qDeleteAll(files);
+}
+
+ImageDownload *RazerImageDownloader::download(const QUrl &url)
+{
+    // Somebody else is waiting for this image already
+    ImageDownload *download = downloads.value(url);
+    if (download != nullptr)
+        return download;
+
+    download = new ImageDownload(url, this);
+    downloads.insert(url, download);
+
+    // Finish asynchronously, so the caller gets a chance to connect to the signals
+    if (isCached(url)) {
+        QTimer::singleShot(0, this, [=]() { finish(url, true); });
+    } else if (!settings.value("downloadImages").toBool()) {
+        QTimer::singleShot(0, this, [=]() {
+            finish(url, false, tr("Image download disabled"), tr("Image downloading is disabled. Visit the preferences to enable it."));
+        });
+    } else {
+        queue.enqueue(url);
+        startNext();
+    }
+
+    return download;
+}
+
+void RazerImageDownloader::startNext()
+{
+    while (running < maxRunningDownloads && !queue.isEmpty()) {
+        QUrl url = queue.dequeue();
+
+        QDir().mkpath(getDownloadPath());
+        auto *file = new QTemporaryFile(getDownloadPath() + "XXXXXX" + partialSuffix);
+        if (!file->open()) {
+            finish(url, false, tr("Failed to save image"), file->errorString());
+            delete file;
+            continue;
+        }
+
+        QNetworkRequest request;
+        request.setUrl(url);
+        request.setRawHeader("User-Agent", "Mozilla Firefox");
+
+        QNetworkReply *reply = manager->get(request);
+        connect(reply, &QNetworkReply::readyRead, this, [=]() { readyRead(reply); });
+        files.insert(reply, file);
+        running++;
+    }
+}
+
+void RazerImageDownloader::readyRead(QNetworkReply *reply)
+{
+    QTemporaryFile *file = files.value(reply);
+    if (file == nullptr)
+        return;
+
+    // Write the body out as it arrives instead of collecting it in memory
+    QByteArray data = reply->readAll();
+    if (file->write(data) != data.size()) {
+        qWarning("RazerImageDownloader: Failed to write %s: %s", qUtf8Printable(file->fileName()), qUtf8Printable(file->errorString()));
+        reply->abort();
+    }
+}
+
+void RazerImageDownloader::finished(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply == revalidationReply) {
+        revalidationFinished(reply);
         return;
     }
-    if (!settings.value("downloadImages").toBool()) {
-        emit downloadErrored(tr("Image download disabled"), tr("Image downloading is disabled. Visit the preferences to enable it."));
+    running--;
+
+    QUrl url = reply->request().url();
+    if (reply->error() == QNetworkReply::NoError)
+        readyRead(reply);
+    QTemporaryFile *file = files.take(reply);
+
+    if (reply->error() != QNetworkReply::NoError) {
+        finish(url, false, tr("Network Error"), QVariant::fromValue(reply->error()).toString());
+    } else {
+        QString error;
+        if (checkLength(reply, file, &error) && store(file, url, &error)) {
+            writeMetadata(url, reply);
+            finish(url, true);
+        } else {
+            qWarning("RazerImageDownloader: Discarding download of %s: %s", qUtf8Printable(url.toString()), qUtf8Printable(error));
+            finish(url, false, tr("Invalid image"), error);
+        }
+    }
+
+    // Removes the temporary file unless it was moved into the cache
+    delete file;
+
+    startNext();
+}
+
+bool RazerImageDownloader::checkLength(QNetworkReply *reply, QTemporaryFile *file, QString *error)
+{
+    QVariant contentLength = reply->header(QNetworkRequest::ContentLengthHeader);
+    if (contentLength.isValid() && contentLength.toLongLong() != file->size()) {
+        *error = tr("Received %1 of %2 bytes").arg(file->size()).arg(contentLength.toLongLong());
+        return false;
+    }
+    return true;
+}
+
+bool RazerImageDownloader::store(QTemporaryFile *file, const QUrl &url, QString *error)
+{
+    if (!file->flush()) {
+        *error = file->errorString();
+        return false;
+    }
+
+    // Make sure this is an image before anybody gets to see it. Decoding the
+    // header is enough, the length was checked already.
+    file->seek(0);
+    QImageReader reader(file);
+    if (!reader.canRead() || !reader.size().isValid()) {
+        *error = reader.errorString();
+        return false;
+    }
+
+    // QTemporaryFile creates the file readable by the owner only
+    file->setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ReadGroup | QFileDevice::ReadOther);
+
+#ifdef Q_OS_UNIX
+    // The data has to be on disk before the rename, or a crash could still leave a truncated image behind
+    fsync(file->handle());
+#endif
+
+    // rename() atomically replaces an existing file
+    QString filePath = getFilePath(url);
+    if (std::rename(QFile::encodeName(file->fileName()).constData(), QFile::encodeName(filePath).constData()) != 0) {
+        *error = tr("Failed to move the image into place");
+        return false;
+    }
+    file->setAutoRemove(false);
+    return true;
+}
+
+void RazerImageDownloader::revalidate(const QUrl &url)
+{
+    int days = settings.value("imageRevalidationDays", 7).toInt();
+    if (days <= 0 || !settings.value("downloadImages").toBool())
+        return;
+    if (!isCached(url) || revalidationQueued.contains(url))
+        return;
+
+    CacheMetadata metadata = readMetadata(url);
+    if (metadata.checked + days * 24 * 3600 > QDateTime::currentSecsSinceEpoch())
+        return;
+
+    revalidationQueue.enqueue(url);
+    revalidationQueued.insert(url);
+    if (revalidationReply == nullptr)
+        revalidationTimer->start();
+}
+
+void RazerImageDownloader::startRevalidation()
+{
+    if (revalidationReply != nullptr || revalidationQueue.isEmpty())
+        return;
+
+    // Downloads somebody is waiting for go first
+    if (running > 0 || !queue.isEmpty()) {
+        revalidationTimer->start();
         return;
     }
 
-    // TODO: What happens when two devices of the same model are connected?
+    QUrl url = revalidationQueue.dequeue();
+    revalidationQueued.remove(url);
+
+    QDir().mkpath(getDownloadPath());
+    auto *file = new QTemporaryFile(getDownloadPath() + "XXXXXX" + partialSuffix);
+    if (!file->open()) {
+        qWarning("RazerImageDownloader: Failed to create a temporary file: %s", qUtf8Printable(file->errorString()));
+        delete file;
+        return;
+    }
 
+    // An unchanged image only costs a 304 response without a body
+    CacheMetadata metadata = readMetadata(url);
     QNetworkRequest request;
     request.setUrl(url);
     request.setRawHeader("User-Agent", "Mozilla Firefox");
+    if (!metadata.etag.isEmpty())
+        request.setRawHeader("If-None-Match", metadata.etag);
+    if (!metadata.lastModified.isEmpty())
+        request.setRawHeader("If-Modified-Since", metadata.lastModified);
 
-    connect(manager, &QNetworkAccessManager::finished, this, &RazerImageDownloader::finished);
+    revalidationReply = manager->get(request);
+    QNetworkReply *reply = revalidationReply;
+    connect(reply, &QNetworkReply::readyRead, this, [=]() { readyRead(reply); });
+    files.insert(reply, file);
+}
 
-    manager->get(request);
+void RazerImageDownloader::revalidationFinished(QNetworkReply *reply)
+{
+    revalidationReply = nullptr;
+
+    QUrl url = reply->request().url();
+    if (reply->error() == QNetworkReply::NoError)
+        readyRead(reply);
+    QTemporaryFile *file = files.take(reply);
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError) {
+        // Try again next time
+        qWarning("RazerImageDownloader: Failed to revalidate %s: %s", qUtf8Printable(url.toString()), qUtf8Printable(reply->errorString()));
+    } else if (status == 304) {
+        CacheMetadata metadata = readMetadata(url);
+        metadata.checked = QDateTime::currentSecsSinceEpoch();
+        writeMetadata(url, metadata);
+    } else {
+        QString error;
+        if (checkLength(reply, file, &error) && store(file, url, &error)) {
+            qInfo("RazerImageDownloader: Updated %s", qUtf8Printable(url.toString()));
+            writeMetadata(url, reply);
+            emit imageChanged(url, getFilePath(url));
+        } else {
+            qWarning("RazerImageDownloader: Discarding new version of %s: %s", qUtf8Printable(url.toString()), qUtf8Printable(error));
+        }
+    }
+
+    delete file;
+
+    if (!revalidationQueue.isEmpty())
+        revalidationTimer->start();
 }
 
-RazerImageDownloader::~RazerImageDownloader()
+RazerImageDownloader::CacheMetadata RazerImageDownloader::readMetadata(const QUrl &url)
 {
-    // TODO: Complete destructor (no idea how they work / what you have to do)
-    delete _file;
-    delete manager;
+    CacheMetadata metadata;
+
+    QFile file(getFilePath(url) + metadataSuffix);
+    if (!file.open(QIODevice::ReadOnly))
+        return metadata;
+
+    QJsonObject object = QJsonDocument::fromJson(file.readAll()).object();
+    metadata.etag = object.value("etag").toString().toLatin1();
+    metadata.lastModified = object.value("lastModified").toString().toLatin1();
+    metadata.checked = object.value("checked").toVariant().toLongLong();
+    return metadata;
 }
 
-void RazerImageDownloader::finished(QNetworkReply *reply)
+void RazerImageDownloader::writeMetadata(const QUrl &url, const CacheMetadata &metadata)
 {
-    if (reply->error() != QNetworkReply::NoError) {
-        emit downloadErrored(tr("Network Error"), QVariant::fromValue(reply->error()).toString());
+    QJsonObject object;
+    object.insert("url", url.toString());
+    object.insert("etag", QString::fromLatin1(metadata.etag));
+    object.insert("lastModified", QString::fromLatin1(metadata.lastModified));
+    object.insert("checked", metadata.checked);
+
+    QSaveFile file(getFilePath(url) + metadataSuffix);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning("RazerImageDownloader: Failed to write metadata for %s: %s", qUtf8Printable(url.toString()), qUtf8Printable(file.errorString()));
         return;
     }
+    file.write(QJsonDocument(object).toJson());
+    file.commit();
+}
 
-    _file->open(QFile::WriteOnly);
-    _file->write(reply->readAll());
-    _file->flush();
-    _file->close();
+void RazerImageDownloader::writeMetadata(const QUrl &url, QNetworkReply *reply)
+{
+    CacheMetadata metadata;
+    metadata.etag = reply->rawHeader("ETag");
+    metadata.lastModified = reply->rawHeader("Last-Modified");
+    metadata.checked = QDateTime::currentSecsSinceEpoch();
+    writeMetadata(url, metadata);
+}
 
-    reply->deleteLater();
+void RazerImageDownloader::finish(const QUrl &url, bool success, const QString &reason, const QString &longReason)
+{
+    ImageDownload *download = downloads.take(url);
+    if (download == nullptr)
+        return;
 
-    emit downloadFinished(_filepath);
+    if (success) {
+        emit download->downloadFinished(getFilePath(url));
+    } else {
+        emit download->downloadErrored(reason, longReason);
+    }
+    download->deleteLater();
 }
 
 QString RazerImageDownloader::getDownloadPath()
@@ -72,3 +360,14 @@ QString RazerImageDownloader::getDownloadPath()
     // Should be ~/.local/share/razergenie/devicepictures/
     return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + "/razergenie/devicepictures/";
 }
+
+QString RazerImageDownloader::getFilePath(const QUrl &url)
+{
+    return getDownloadPath() + QFileInfo(url.path()).fileName();
+}
+
+bool RazerImageDownloader::isCached(const QUrl &url)
+{
+    QFileInfo info(getFilePath(url));
+    return info.exists() && info.isFile();
+}
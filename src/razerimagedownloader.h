@@ -5,30 +5,109 @@
 #ifndef RAZERIMAGEDOWNLOADER_H
 #define RAZERIMAGEDOWNLOADER_H
 
-#include <QFile>
+#include <QHash>
 #include <QNetworkReply>
+#include <QQueue>
+#include <QSet>
 #include <QSettings>
+#include <QTemporaryFile>
+#include <QUrl>
 
+class QTimer;
+
+/*
+ * A download of one image, shared by everyone who requested the same URL.
+ * Deletes itself after emitting one of its signals.
+ */
+class ImageDownload : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ImageDownload(const QUrl &url, QObject *parent = nullptr);
+    ~ImageDownload() override;
+
+    QUrl getUrl() const;
+
+signals:
+    void downloadFinished(const QString &filename);
+    void downloadErrored(const QString &reason, const QString &longReason);
+
+private:
+    QUrl url;
+};
+
+/*
+ * Downloads device images into the image cache.
+ *
+ * There's one instance for the whole application, so all downloads share
+ * the connections of one QNetworkAccessManager. Only a few transfers run at
+ * the same time, and requests for a URL that's already being downloaded are
+ * attached to the running download.
+ *
+ * Replies are streamed into a temporary file next to the cache, which is
+ * only renamed into place once it has been checked to contain an image. A
+ * file in the cache is therefore always complete.
+ *
+ * Cached images remember their ETag and Last-Modified headers. Every few
+ * days, as configured in the preferences, they're revalidated with a
+ * conditional request while no other downloads are running.
+ */
 class RazerImageDownloader : public QObject
 {
     Q_OBJECT
 public:
-    RazerImageDownloader(QUrl url, QObject *parent);
+    explicit RazerImageDownloader(QObject *parent = nullptr);
     ~RazerImageDownloader() override;
-    void startDownload();
+
+    /* Returns the download for the URL, starting one if necessary.
+     * If the image is cached already, the download finishes right away. */
+    ImageDownload *download(const QUrl &url);
+    /* Checks a cached image for changes later on, if it's due */
+    void revalidate(const QUrl &url);
+
     static QString getDownloadPath();
+    static QString getFilePath(const QUrl &url);
+    static bool isCached(const QUrl &url);
+
 signals:
-    void downloadFinished(QString &filename);
-    void downloadErrored(QString reason, QString longReason);
+    /* A cached image was replaced with a newer version */
+    void imageChanged(const QUrl &url, const QString &filename);
 
 private:
-    QFile *_file;
-    QString _filepath;
-    QUrl url;
+    struct CacheMetadata {
+        QByteArray etag;
+        QByteArray lastModified;
+        /* Seconds since the epoch of the last download or revalidation */
+        qint64 checked = 0;
+    };
+
+    static const int maxRunningDownloads = 4;
+
     QNetworkAccessManager *manager;
     QSettings settings;
-private slots:
+
+    QHash<QUrl, ImageDownload *> downloads;
+    QHash<QNetworkReply *, QTemporaryFile *> files;
+    QQueue<QUrl> queue;
+    int running;
+
+    QQueue<QUrl> revalidationQueue;
+    QSet<QUrl> revalidationQueued;
+    QTimer *revalidationTimer;
+    QNetworkReply *revalidationReply;
+
+    void startNext();
+    void readyRead(QNetworkReply *reply);
     void finished(QNetworkReply *reply);
+    bool store(QTemporaryFile *file, const QUrl &url, QString *error);
+    bool checkLength(QNetworkReply *reply, QTemporaryFile *file, QString *error);
+    void startRevalidation();
+    void revalidationFinished(QNetworkReply *reply);
+
+    static CacheMetadata readMetadata(const QUrl &url);
+    static void writeMetadata(const QUrl &url, const CacheMetadata &metadata);
+    static void writeMetadata(const QUrl &url, QNetworkReply *reply);
+    void finish(const QUrl &url, bool success, const QString &reason = QString(), const QString &longReason = QString());
 };
 
 #endif // RAZERIMAGEDOWNLOADER_H
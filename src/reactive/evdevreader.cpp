@@ -0,0 +1,188 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "evdevreader.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+EvdevReader::EvdevReader(QObject *parent)
+    : QObject(parent)
+{
+    epollFd = -1;
+    notifier = nullptr;
+    recordFile = nullptr;
+    replayPosition = 0;
+    replayStart = 0;
+
+    replayTimer = new QTimer(this);
+    replayTimer->setSingleShot(true);
+    replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(replayTimer, &QTimer::timeout, this, &EvdevReader::replayNext);
+}
+
+EvdevReader::~EvdevReader()
+{
+    for (int fd : qAsConst(fds))
+        close(fd);
+    if (epollFd != -1)
+        close(epollFd);
+}
+
+QStringList EvdevReader::razerKeyboardNodes()
+{
+    QDir dir("/dev/input/by-id/");
+    QStringList nodes;
+    for (const QString &name : dir.entryList({ "usb-Razer_*-event-kbd" }, QDir::Files | QDir::System))
+        nodes << dir.absoluteFilePath(name);
+    return nodes;
+}
+
+qint64 EvdevReader::monotonicNow()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+bool EvdevReader::open(const QStringList &paths)
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        qWarning("EvdevReader: Failed to create epoll instance: %s", strerror(errno));
+        return false;
+    }
+
+    for (const QString &path : paths) {
+        int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd == -1) {
+            qWarning("EvdevReader: Failed to open %s: %s", qUtf8Printable(path), strerror(errno));
+            return false;
+        }
+        fds.append(fd);
+
+        // Timestamps comparable to the time the frames get sent
+        int clock = CLOCK_MONOTONIC;
+        if (ioctl(fd, EVIOCSCLOCKID, &clock) == -1)
+            qWarning("EvdevReader: Failed to switch %s to the monotonic clock", qUtf8Printable(path));
+
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+            qWarning("EvdevReader: Failed to watch %s: %s", qUtf8Printable(path), strerror(errno));
+            return false;
+        }
+    }
+
+    notifier = new QSocketNotifier(epollFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &EvdevReader::readEvents);
+    return true;
+}
+
+bool EvdevReader::record(const QString &path)
+{
+    recordFile = new QFile(path, this);
+    if (!recordFile->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning("EvdevReader: Failed to open %s: %s", qUtf8Printable(path), qUtf8Printable(recordFile->errorString()));
+        return false;
+    }
+    recordFile->write("# EvdevReader log, replay with razergenie --reactive <serial> --replay <file>\n");
+    return true;
+}
+
+void EvdevReader::readEvents()
+{
+    epoll_event ready[8];
+    int count = epoll_wait(epollFd, ready, 8, 0);
+
+    for (int i = 0; i < count; i++) {
+        input_event events[64];
+        ssize_t size;
+        while ((size = read(ready[i].data.fd, events, sizeof(events))) > 0) {
+            for (size_t j = 0; j < size / sizeof(input_event); j++) {
+                const input_event &event = events[j];
+                qint64 timestamp = qint64(event.input_event_sec) * 1000000000 + qint64(event.input_event_usec) * 1000;
+                handleEvent(event.type, event.code, event.value, timestamp);
+            }
+        }
+        if (size == -1 && errno == ENODEV) {
+            // The keyboard was unplugged
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, ready[i].data.fd, nullptr);
+        }
+    }
+}
+
+void EvdevReader::handleEvent(int type, int code, int value, qint64 timestamp)
+{
+    if (recordFile != nullptr) {
+        recordFile->write(QString("E: %1.%2 %3 %4 %5\n")
+                                  .arg(timestamp / 1000000000)
+                                  .arg((timestamp / 1000) % 1000000, 6, 10, QChar('0'))
+                                  .arg(type, 4, 16, QChar('0'))
+                                  .arg(code, 4, 16, QChar('0'))
+                                  .arg(value)
+                                  .toUtf8());
+    }
+
+    // Only presses light up keys, repeats and releases don't
+    if (type == EV_KEY && value == 1)
+        emit keyPressed(code, timestamp);
+}
+
+bool EvdevReader::replay(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning("EvdevReader: Failed to open %s: %s", qUtf8Printable(path), qUtf8Printable(file.errorString()));
+        return false;
+    }
+
+    replayEvents.clear();
+    while (!file.atEnd()) {
+        QList<QByteArray> fields = file.readLine().simplified().split(' ');
+        if (fields.size() != 5 || fields.at(0) != "E:")
+            continue;
+
+        LoggedEvent event;
+        QList<QByteArray> time = fields.at(1).split('.');
+        event.time = time.value(0).toLongLong() * 1000000000 + time.value(1).leftJustified(6, '0').toLongLong() * 1000;
+        event.type = fields.at(2).toInt(nullptr, 16);
+        event.code = fields.at(3).toInt(nullptr, 16);
+        event.value = fields.at(4).toInt();
+        replayEvents.append(event);
+    }
+
+    replayPosition = 0;
+    replayStart = monotonicNow();
+    QTimer::singleShot(0, this, &EvdevReader::replayNext);
+    return true;
+}
+
+void EvdevReader::replayNext()
+{
+    // Events keep the spacing they were recorded with
+    qint64 now = monotonicNow();
+    while (replayPosition < replayEvents.size()) {
+        const LoggedEvent &event = replayEvents.at(replayPosition);
+        qint64 due = replayStart + event.time - replayEvents.first().time;
+        if (due > now) {
+            replayTimer->start(int((due - now + 999999) / 1000000));
+            return;
+        }
+        handleEvent(event.type, event.code, event.value, now);
+        replayPosition++;
+    }
+    emit finished();
+}
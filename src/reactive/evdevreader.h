@@ -0,0 +1,73 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EVDEVREADER_H
+#define EVDEVREADER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+class QFile;
+class QSocketNotifier;
+class QTimer;
+
+/*
+ * Reports key presses, either read from evdev nodes (/dev/input/event*) or
+ * replayed from a log recorded earlier.
+ *
+ * All nodes are watched through one epoll instance, so a keyboard with
+ * several nodes costs a single wakeup per batch of events. Timestamps are
+ * on CLOCK_MONOTONIC in nanoseconds, for replayed events the time they got
+ * replayed at.
+ *
+ * Logs use the event lines of evemu-record ("E: <seconds> <type> <code>
+ * <value>", type and code in hex), other lines are ignored. Logs recorded
+ * with evemu-record can therefore be replayed as well.
+ */
+class EvdevReader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit EvdevReader(QObject *parent = nullptr);
+    ~EvdevReader() override;
+
+    /* The keyboard nodes of the connected Razer devices */
+    static QStringList razerKeyboardNodes();
+    static qint64 monotonicNow();
+
+    bool open(const QStringList &paths);
+    bool replay(const QString &path);
+    /* Writes all events read from the nodes to the file, in the log format */
+    bool record(const QString &path);
+
+signals:
+    void keyPressed(int keyCode, qint64 timestamp);
+    /* The replayed log is over, never emitted for nodes */
+    void finished();
+
+private:
+    struct LoggedEvent {
+        qint64 time;
+        int type;
+        int code;
+        int value;
+    };
+
+    int epollFd;
+    QList<int> fds;
+    QSocketNotifier *notifier;
+    QFile *recordFile;
+
+    QVector<LoggedEvent> replayEvents;
+    int replayPosition;
+    qint64 replayStart;
+    QTimer *replayTimer;
+
+    void readEvents();
+    void handleEvent(int type, int code, int value, qint64 timestamp);
+    void replayNext();
+};
+
+#endif // EVDEVREADER_H
@@ -0,0 +1,217 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "keymap.h"
+
+#include "customeditor/matrixlayout.h"
+
+#include <QJsonArray>
+#include <QStringList>
+#include <linux/input-event-codes.h>
+
+/* The labels used in the layout files, without the keys of the numpad */
+static const QHash<QString, int> keyCodes = {
+    { "esc", KEY_ESC },
+    { "F1", KEY_F1 },
+    { "F2", KEY_F2 },
+    { "F3", KEY_F3 },
+    { "F4", KEY_F4 },
+    { "F5", KEY_F5 },
+    { "F6", KEY_F6 },
+    { "F7", KEY_F7 },
+    { "F8", KEY_F8 },
+    { "F9", KEY_F9 },
+    { "F10", KEY_F10 },
+    { "F11", KEY_F11 },
+    { "F12", KEY_F12 },
+    { "prt sc", KEY_SYSRQ },
+    { "scr\nlk", KEY_SCROLLLOCK },
+    { "pause", KEY_PAUSE },
+    { "`", KEY_GRAVE },
+    { "¬", KEY_GRAVE },
+    { "1", KEY_1 },
+    { "2", KEY_2 },
+    { "3", KEY_3 },
+    { "4", KEY_4 },
+    { "5", KEY_5 },
+    { "6", KEY_6 },
+    { "7", KEY_7 },
+    { "8", KEY_8 },
+    { "9", KEY_9 },
+    { "0", KEY_0 },
+    { "-", KEY_MINUS },
+    { "=", KEY_EQUAL },
+    { "backspace", KEY_BACKSPACE },
+    { "ins", KEY_INSERT },
+    { "home", KEY_HOME },
+    { "page\nup", KEY_PAGEUP },
+    { "tab", KEY_TAB },
+    { "Q", KEY_Q },
+    { "W", KEY_W },
+    { "E", KEY_E },
+    { "R", KEY_R },
+    { "T", KEY_T },
+    { "Y", KEY_Y },
+    { "U", KEY_U },
+    { "I", KEY_I },
+    { "O", KEY_O },
+    { "P", KEY_P },
+    { "[", KEY_LEFTBRACE },
+    { "]", KEY_RIGHTBRACE },
+    { "\\", KEY_BACKSLASH },
+    { "del", KEY_DELETE },
+    { "end", KEY_END },
+    { "page\ndown", KEY_PAGEDOWN },
+    { "caps", KEY_CAPSLOCK },
+    { "caps\nlk", KEY_CAPSLOCK },
+    { "A", KEY_A },
+    { "S", KEY_S },
+    { "D", KEY_D },
+    { "F", KEY_F },
+    { "G", KEY_G },
+    { "H", KEY_H },
+    { "J", KEY_J },
+    { "K", KEY_K },
+    { "L", KEY_L },
+    { ";", KEY_SEMICOLON },
+    { "'", KEY_APOSTROPHE },
+    { "enter", KEY_ENTER },
+    { "Z", KEY_Z },
+    { "X", KEY_X },
+    { "C", KEY_C },
+    { "V", KEY_V },
+    { "B", KEY_B },
+    { "N", KEY_N },
+    { "M", KEY_M },
+    { ",", KEY_COMMA },
+    { ".", KEY_DOT },
+    { "/", KEY_SLASH },
+    { "space", KEY_SPACE },
+    { "[logo]", KEY_LEFTMETA },
+    { "🐧", KEY_LEFTMETA },
+    { "☰", KEY_COMPOSE },
+    { "🠸", KEY_LEFT },
+    { "🠹", KEY_UP },
+    { "🠺", KEY_RIGHT },
+    { "🠻", KEY_DOWN },
+    { "|<<", KEY_PREVIOUSSONG },
+    { ">||", KEY_PLAYPAUSE },
+    { ">>|", KEY_NEXTSONG },
+    { "mute", KEY_MUTE },
+    { "alt gr", KEY_RIGHTALT },
+};
+
+/* ISO layouts, recognized by their "#" key, have "#" where US has the
+ * backslash and another backslash key right of the left shift */
+static const QHash<QString, int> isoKeyCodes = {
+    { "#", KEY_BACKSLASH },
+    { "\\", KEY_102ND },
+};
+
+/* Keys right of the navigation block, where the layouts have one */
+static const QHash<QString, int> numpadKeyCodes = {
+    { "num\nlk", KEY_NUMLOCK },
+    { "/", KEY_KPSLASH },
+    { "*", KEY_KPASTERISK },
+    { "-", KEY_KPMINUS },
+    { "+", KEY_KPPLUS },
+    { "enter", KEY_KPENTER },
+    { ".", KEY_KPDOT },
+    { "0", KEY_KP0 },
+    { "1", KEY_KP1 },
+    { "2", KEY_KP2 },
+    { "3", KEY_KP3 },
+    { "4", KEY_KP4 },
+    { "5", KEY_KP5 },
+    { "6", KEY_KP6 },
+    { "7", KEY_KP7 },
+    { "8", KEY_KP8 },
+    { "9", KEY_KP9 },
+};
+
+/* Modifiers are in the layouts twice per row, left one first */
+static const QHash<QString, QPair<int, int>> modifierKeyCodes = {
+    { "shift", { KEY_LEFTSHIFT, KEY_RIGHTSHIFT } },
+    { "ctrl", { KEY_LEFTCTRL, KEY_RIGHTCTRL } },
+    { "alt", { KEY_LEFTALT, KEY_RIGHTALT } },
+};
+
+KeyMap KeyMap::forKeyboard(int rows, int columns, const QString &layout)
+{
+    QString name = MatrixLayout::keyboardLayoutName({ static_cast<uchar>(rows), static_cast<uchar>(columns) });
+    if (name.isEmpty())
+        return KeyMap();
+
+    QJsonObject variants = MatrixLayout::load(name).object();
+    if (variants.isEmpty())
+        return KeyMap();
+    if (!layout.isEmpty() && variants.contains(layout))
+        return fromLayout(variants.value(layout).toObject());
+    for (const QString &variant : { QString("US"), QString("UK") }) {
+        if (variants.contains(variant))
+            return fromLayout(variants.value(variant).toObject());
+    }
+    return fromLayout(variants.begin().value().toObject());
+}
+
+KeyMap KeyMap::fromLayout(const QJsonObject &rows)
+{
+    // The numpad starts after the column of the pause key
+    int numpadColumn = -1;
+    bool iso = false;
+    for (const QJsonValue &row : rows) {
+        for (const QJsonValue &key : row.toArray()) {
+            QJsonArray matrix = key.toObject().value("matrix").toArray();
+            QString label = key.toObject().value("label").toString();
+            if (label == "pause" && matrix.size() == 2)
+                numpadColumn = matrix.at(1).toInt() + 1;
+            iso |= label == "#";
+        }
+    }
+
+    KeyMap map;
+    for (const QJsonValue &row : rows) {
+        QHash<QString, int> seen;
+        for (const QJsonValue &value : row.toArray()) {
+            QJsonObject key = value.toObject();
+            QJsonArray matrix = key.value("matrix").toArray();
+            if (matrix.size() != 2)
+                continue;
+            QString label = key.value("label").toString();
+            QPoint position(matrix.at(0).toInt(), matrix.at(1).toInt());
+
+            int keyCode = -1;
+            if (modifierKeyCodes.contains(label)) {
+                QPair<int, int> codes = modifierKeyCodes.value(label);
+                keyCode = seen.value(label) == 0 ? codes.first : codes.second;
+            } else if (numpadColumn != -1 && position.y() >= numpadColumn && numpadKeyCodes.contains(label)) {
+                keyCode = numpadKeyCodes.value(label);
+            } else if (iso && isoKeyCodes.contains(label)) {
+                keyCode = isoKeyCodes.value(label);
+            } else if (keyCodes.contains(label)) {
+                keyCode = keyCodes.value(label);
+            }
+            seen[label]++;
+
+            if (keyCode != -1 && !map.positions.contains(keyCode))
+                map.positions.insert(keyCode, position);
+        }
+    }
+    return map;
+}
+
+bool KeyMap::isEmpty() const
+{
+    return positions.isEmpty();
+}
+
+bool KeyMap::contains(int keyCode) const
+{
+    return positions.contains(keyCode);
+}
+
+QPoint KeyMap::position(int keyCode) const
+{
+    return positions.value(keyCode, QPoint(-1, -1));
+}
@@ -0,0 +1,38 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef KEYMAP_H
+#define KEYMAP_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QPoint>
+
+/*
+ * Maps Linux key codes (KEY_* from evdev) to positions in the LED matrix of
+ * a keyboard, built from a layout file in data/matrix_layouts/.
+ *
+ * Key codes name physical positions, not what's printed on the keys. The
+ * variant of the keyboard's own layout is used when the file has it, as ISO
+ * keyboards have a key more than the US variant; otherwise it's US or UK.
+ */
+class KeyMap
+{
+public:
+    /* Loads the layout file of keyboards with these dimensions, the map is
+     * empty if there's none. layout is what the device reports, e.g. "UK". */
+    static KeyMap forKeyboard(int rows, int columns, const QString &layout = QString());
+    /* rows is one variant of a layout file, e.g. the object under "US" */
+    static KeyMap fromLayout(const QJsonObject &rows);
+
+    bool isEmpty() const;
+    bool contains(int keyCode) const;
+    /* x is the row, y the column */
+    QPoint position(int keyCode) const;
+
+private:
+    QHash<int, QPoint> positions;
+};
+
+#endif // KEYMAP_H
@@ -0,0 +1,270 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "reactivelighting.h"
+
+#include "devicecommandqueue.h"
+#include "evdevreader.h"
+
+#include <QTimer>
+
+struct RowSegment {
+    uchar row;
+    uchar startColumn;
+    uchar endColumn;
+    QVector<openrazer::RGB> colors;
+};
+
+static bool sameColor(const openrazer::RGB &a, const openrazer::RGB &b)
+{
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+ReactiveLighting::ReactiveLighting(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, openrazer::MatrixDimensions dimensions, const KeyMap &keyMap, QObject *parent)
+    : QObject(parent)
+{
+    this->commandQueue = commandQueue;
+    this->device = device;
+    this->dimensions = dimensions;
+    this->keyMap = keyMap;
+    color = { 0, 255, 0 };
+    fadeDuration = 500;
+    frameInterval = 33;
+    sending = false;
+    darkPending = false;
+    latencyCount = 0;
+    latencyTotal = 0;
+    latencyMax = 0;
+    lateCount = 0;
+    framesSent = 0;
+    unmapped = 0;
+
+    pressTimes.fill(-1, dimensions.x * dimensions.y);
+    shownColors.fill({ 0, 0, 0 }, dimensions.x * dimensions.y);
+
+    frameTimer = new QTimer(this);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    frameTimer->setInterval(frameInterval);
+    connect(frameTimer, &QTimer::timeout, this, [=]() {
+        // A frame still being sent renders the next one once it's done
+        if (!sending)
+            render();
+    });
+}
+
+ReactiveLighting::~ReactiveLighting() = default;
+
+void ReactiveLighting::setColor(const openrazer::RGB &color)
+{
+    this->color = color;
+}
+
+void ReactiveLighting::setFadeDuration(int milliseconds)
+{
+    fadeDuration = qMax(1, milliseconds);
+}
+
+void ReactiveLighting::setFrameInterval(int milliseconds)
+{
+    frameInterval = qMax(1, milliseconds);
+    frameTimer->setInterval(frameInterval);
+}
+
+void ReactiveLighting::start()
+{
+    // The device might show anything, start from a known frame
+    QVector<openrazer::RGB> dark(shownColors.size(), { 0, 0, 0 });
+    for (openrazer::RGB &shown : shownColors)
+        shown = { 1, 1, 1 };
+    sendFrame(dark);
+}
+
+void ReactiveLighting::stop()
+{
+    frameTimer->stop();
+    pressTimes.fill(-1);
+    pendingPresses.clear();
+
+    // Without fades the next frame is a dark one
+    if (sending)
+        darkPending = true;
+    else
+        render();
+}
+
+void ReactiveLighting::keyPressed(int keyCode, qint64 timestamp)
+{
+    if (!keyMap.contains(keyCode)) {
+        unmapped++;
+        return;
+    }
+
+    QPoint position = keyMap.position(keyCode);
+    if (position.x() >= dimensions.x || position.y() >= dimensions.y) {
+        unmapped++;
+        return;
+    }
+
+    pressTimes[position.x() * dimensions.y + position.y()] = EvdevReader::monotonicNow();
+    pendingPresses.append(timestamp);
+
+    if (!frameTimer->isActive())
+        frameTimer->start();
+    if (!sending)
+        render();
+}
+
+bool ReactiveLighting::isActive() const
+{
+    return sending || hasFades();
+}
+
+int ReactiveLighting::latencySamples() const
+{
+    return latencyCount;
+}
+
+qint64 ReactiveLighting::averageLatency() const
+{
+    return latencyCount == 0 ? 0 : latencyTotal / latencyCount;
+}
+
+qint64 ReactiveLighting::maxLatency() const
+{
+    return latencyMax;
+}
+
+int ReactiveLighting::lateSamples() const
+{
+    return lateCount;
+}
+
+int ReactiveLighting::sentFrames() const
+{
+    return framesSent;
+}
+
+int ReactiveLighting::unmappedKeys() const
+{
+    return unmapped;
+}
+
+void ReactiveLighting::render()
+{
+    qint64 now = EvdevReader::monotonicNow();
+    QVector<openrazer::RGB> colors(shownColors.size(), { 0, 0, 0 });
+
+    for (int i = 0; i < pressTimes.size(); i++) {
+        if (pressTimes.at(i) == -1)
+            continue;
+        qint64 elapsed = (now - pressTimes.at(i)) / 1000000;
+        if (elapsed >= fadeDuration) {
+            pressTimes[i] = -1;
+            continue;
+        }
+        double factor = 1.0 - double(elapsed) / fadeDuration;
+        colors[i] = { static_cast<uchar>(color.r * factor),
+                      static_cast<uchar>(color.g * factor),
+                      static_cast<uchar>(color.b * factor) };
+    }
+
+    sendFrame(colors);
+
+    if (!sending && !hasFades()) {
+        frameTimer->stop();
+        emit idle();
+    }
+}
+
+void ReactiveLighting::sendFrame(const QVector<openrazer::RGB> &colors)
+{
+    // Per row only the range from the first to the last changed key
+    QVector<RowSegment> segments;
+    for (int row = 0; row < dimensions.x; row++) {
+        int first = -1;
+        int last = -1;
+        for (int column = 0; column < dimensions.y; column++) {
+            int i = row * dimensions.y + column;
+            if (!sameColor(colors.at(i), shownColors.at(i))) {
+                if (first == -1)
+                    first = column;
+                last = column;
+            }
+        }
+        if (first == -1)
+            continue;
+
+        RowSegment segment;
+        segment.row = static_cast<uchar>(row);
+        segment.startColumn = static_cast<uchar>(first);
+        segment.endColumn = static_cast<uchar>(last);
+        segment.colors = colors.mid(row * dimensions.y + first, last - first + 1);
+        segments.append(segment);
+    }
+
+    QVector<qint64> presses = pendingPresses;
+    pendingPresses.clear();
+
+    if (segments.isEmpty()) {
+        // Pressed again while still fully lit, nothing to send
+        qint64 now = EvdevReader::monotonicNow();
+        for (qint64 timestamp : qAsConst(presses)) {
+            qint64 latency = (now - timestamp) / 1000;
+            latencyCount++;
+            latencyTotal += latency;
+            latencyMax = qMax(latencyMax, latency);
+        }
+        return;
+    }
+
+    shownColors = colors;
+    sending = true;
+
+    libopenrazer::Device *device = this->device;
+    commandQueue->write(
+            device, this,
+            [=]() {
+                for (const RowSegment &segment : segments)
+                    device->defineCustomFrame(segment.row, segment.startColumn, segment.endColumn, segment.colors);
+                device->displayCustomFrame();
+            },
+            [=](bool success) {
+                sending = false;
+                if (success) {
+                    framesSent++;
+                } else {
+                    // Unknown what the device shows now, the next frame is sent in full
+                    for (openrazer::RGB &shown : shownColors)
+                        shown = { 1, 1, 1 };
+                }
+
+                qint64 now = EvdevReader::monotonicNow();
+                for (qint64 timestamp : presses) {
+                    qint64 latency = (now - timestamp) / 1000;
+                    latencyCount++;
+                    latencyTotal += latency;
+                    latencyMax = qMax(latencyMax, latency);
+                    if (latency > qint64(frameInterval) * 1000)
+                        lateCount++;
+                }
+
+                // Presses don't wait for the frame tick, fades do
+                if (!pendingPresses.isEmpty() || darkPending) {
+                    darkPending = false;
+                    render();
+                } else if (!hasFades()) {
+                    frameTimer->stop();
+                    emit idle();
+                }
+            });
+}
+
+bool ReactiveLighting::hasFades() const
+{
+    for (qint64 pressTime : pressTimes) {
+        if (pressTime != -1)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,95 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef REACTIVELIGHTING_H
+#define REACTIVELIGHTING_H
+
+#include "keymap.h"
+
+#include <QObject>
+#include <QVector>
+#include <libopenrazer.h>
+
+class DeviceCommandQueue;
+class QTimer;
+
+/*
+ * Software version of the reactive effect: pressed keys light up and fade
+ * out again, rendered on the custom frame of the keyboard. This is an
+ * alternative to the hardware Reactive effect, which stays available with
+ * its fixed speed.
+ *
+ * Only the columns that changed since the last frame are sent, a single
+ * key press usually costs one short row. At most one frame is on its way
+ * to the device, key presses coming in meanwhile go into the next one. A
+ * press that finds the device idle is sent right away instead of waiting
+ * for the next frame tick, so it shows up within one frame.
+ */
+class ReactiveLighting : public QObject
+{
+    Q_OBJECT
+public:
+    ReactiveLighting(DeviceCommandQueue *commandQueue, libopenrazer::Device *device, openrazer::MatrixDimensions dimensions, const KeyMap &keyMap, QObject *parent = nullptr);
+    ~ReactiveLighting() override;
+
+    void setColor(const openrazer::RGB &color);
+    void setFadeDuration(int milliseconds);
+    void setFrameInterval(int milliseconds);
+
+    /* Sends a dark frame, the deltas start from there */
+    void start();
+    /* Cuts the fades short and sends a dark frame, idle() follows once the
+     * device took it */
+    void stop();
+    /* timestamp is on CLOCK_MONOTONIC in nanoseconds */
+    void keyPressed(int keyCode, qint64 timestamp);
+    /* True while keys are fading out or a frame is being sent */
+    bool isActive() const;
+
+    /* From the key press to the device having taken the frame, in microseconds */
+    int latencySamples() const;
+    qint64 averageLatency() const;
+    qint64 maxLatency() const;
+    /* How many key presses took longer than one frame interval */
+    int lateSamples() const;
+    int sentFrames() const;
+    int unmappedKeys() const;
+
+signals:
+    /* All fades are done and the last frame was sent */
+    void idle();
+
+private:
+    DeviceCommandQueue *commandQueue;
+    libopenrazer::Device *device;
+    openrazer::MatrixDimensions dimensions;
+    KeyMap keyMap;
+    openrazer::RGB color;
+    int fadeDuration;
+    int frameInterval;
+    QTimer *frameTimer;
+
+    /* Per key, when it was pressed last or -1 */
+    QVector<qint64> pressTimes;
+    /* What the device shows */
+    QVector<openrazer::RGB> shownColors;
+    bool sending;
+    /* stop() was called while a frame was being sent */
+    bool darkPending;
+    /* Presses waiting for the next frame */
+    QVector<qint64> pendingPresses;
+
+    int latencyCount;
+    qint64 latencyTotal;
+    qint64 latencyMax;
+    int lateCount;
+    int framesSent;
+    int unmapped;
+
+    void render();
+    void sendFrame(const QVector<openrazer::RGB> &colors);
+    bool hasFades() const;
+};
+
+#endif // REACTIVELIGHTING_H
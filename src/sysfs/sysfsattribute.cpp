@@ -0,0 +1,82 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sysfsattribute.h"
+
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QFile>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <libopenrazer.h>
+#include <unistd.h>
+
+namespace SysfsAttribute {
+
+static QString attributePath(const QString &devicePath, const QString &name)
+{
+    return devicePath + "/" + name;
+}
+
+bool exists(const QString &devicePath, const QString &name)
+{
+    return QFile::exists(attributePath(devicePath, name));
+}
+
+QByteArray read(const QString &devicePath, const QString &name)
+{
+    QFile file(attributePath(devicePath, name));
+    if (!file.open(QIODevice::ReadOnly))
+        throwError(QString("Failed to read %1: %2").arg(file.fileName(), file.errorString()));
+    return file.readAll();
+}
+
+QString readString(const QString &devicePath, const QString &name)
+{
+    return QString::fromUtf8(read(devicePath, name)).trimmed();
+}
+
+int readInt(const QString &devicePath, const QString &name)
+{
+    bool ok;
+    QString value = readString(devicePath, name);
+    int number = value.toInt(&ok);
+    if (!ok)
+        throwError(QString("Unexpected value in %1: %2").arg(attributePath(devicePath, name), value));
+    return number;
+}
+
+void write(const QString &devicePath, const QString &name, const QByteArray &data)
+{
+    // QFile might split or buffer the data, the driver expects one write per request
+    QByteArray path = QFile::encodeName(attributePath(devicePath, name));
+    int fd = ::open(path.constData(), O_WRONLY | O_CLOEXEC);
+    if (fd == -1)
+        throwError(QString("Failed to open %1: %2").arg(QString::fromLocal8Bit(path), strerror(errno)));
+
+    ssize_t written;
+    do {
+        written = ::write(fd, data.constData(), data.size());
+    } while (written == -1 && errno == EINTR);
+    int error = errno;
+    ::close(fd);
+
+    if (written == -1)
+        throwError(QString("Failed to write %1: %2").arg(QString::fromLocal8Bit(path), strerror(error)));
+    if (written != data.size())
+        throwError(QString("Short write to %1: %2 of %3 bytes").arg(QString::fromLocal8Bit(path)).arg(written).arg(data.size()));
+}
+
+void writeInt(const QString &devicePath, const QString &name, int value)
+{
+    write(devicePath, name, QByteArray::number(value));
+}
+
+void throwError(const QString &message)
+{
+    throw libopenrazer::DBusException(QDBusError(QDBusMessage::createError("io.github.openrazer.razergenie.SysfsError", message)));
+}
+
+}
@@ -0,0 +1,32 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYSFSATTRIBUTE_H
+#define SYSFSATTRIBUTE_H
+
+#include <QByteArray>
+#include <QString>
+
+/*
+ * Access to the attribute files the openrazer kernel driver creates for a
+ * device. Failures are thrown as libopenrazer::DBusException so callers can
+ * treat this backend like the D-Bus ones.
+ */
+namespace SysfsAttribute {
+bool exists(const QString &devicePath, const QString &name);
+
+QByteArray read(const QString &devicePath, const QString &name);
+/* Returns the attribute as text without the trailing newline */
+QString readString(const QString &devicePath, const QString &name);
+int readInt(const QString &devicePath, const QString &name);
+
+/* Writes data with a single write() call, the driver handles every call as
+ * one complete request. */
+void write(const QString &devicePath, const QString &name, const QByteArray &data);
+void writeInt(const QString &devicePath, const QString &name, int value);
+
+[[noreturn]] void throwError(const QString &message);
+}
+
+#endif // SYSFSATTRIBUTE_H
@@ -0,0 +1,291 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sysfsdevice.h"
+
+#include "sysfsattribute.h"
+#include "sysfsled.h"
+
+#include <QHash>
+
+/* The driver doesn't know the maximum of the sensor, this covers current mice */
+static const ushort fallbackMaxDPI = 16000;
+
+/* The driver doesn't report the matrix size either, this is the size of a
+ * full size keyboard which most of the Chroma keyboards use. */
+static const openrazer::MatrixDimensions keyboardMatrix = { 6, 22 };
+
+/* Values of kbd_layout, as interpreted by the daemon */
+static const QHash<QString, QString> keyboardLayouts = {
+    { "01", "en_US" },
+    { "02", "el_GR" },
+    { "03", "de_DE" },
+    { "04", "fr_FR" },
+    { "05", "ru_RU" },
+    { "06", "en_GB" },
+    { "07", "Nordic" },
+    { "0A", "tr_TR" },
+    { "0C", "ja_JP" },
+    { "10", "es_ES" },
+    { "11", "it_IT" },
+    { "12", "pt_PT" },
+    { "81", "en_US_mac" },
+};
+
+static QByteArray dpiBytes(openrazer::DPI dpi)
+{
+    QByteArray data;
+    data.append(static_cast<char>(dpi.dpi_x >> 8));
+    data.append(static_cast<char>(dpi.dpi_x & 0xFF));
+    data.append(static_cast<char>(dpi.dpi_y >> 8));
+    data.append(static_cast<char>(dpi.dpi_y & 0xFF));
+    return data;
+}
+
+SysfsDevice::SysfsDevice(const QDBusObjectPath &objectPath, const QString &devicePath, const QString &driver)
+{
+    this->path = objectPath;
+    this->devicePath = devicePath;
+    this->driver = driver;
+
+    struct Zone {
+        openrazer::LedId ledId;
+        const char *prefix;
+    };
+    // Mice without a matrix have their main zone as "backlight_" instead
+    const Zone zones[] = {
+        { openrazer::LedId::Backlight, "" },
+        { openrazer::LedId::Backlight, "backlight_" },
+        { openrazer::LedId::Logo, "logo_" },
+        { openrazer::LedId::ScrollWheel, "scroll_" },
+        { openrazer::LedId::LeftSide, "left_" },
+        { openrazer::LedId::RightSide, "right_" },
+    };
+    for (const Zone &zone : zones) {
+        bool duplicate = false;
+        for (libopenrazer::Led *led : leds)
+            duplicate |= led->getLedId() == zone.ledId;
+        if (duplicate)
+            continue;
+
+        SysfsLed *led = SysfsLed::create(devicePath, zone.ledId, zone.prefix);
+        if (led != nullptr)
+            leds.append(led);
+    }
+}
+
+SysfsDevice::~SysfsDevice()
+{
+    qDeleteAll(leds);
+}
+
+QDBusObjectPath SysfsDevice::objectPath()
+{
+    return path;
+}
+
+bool SysfsDevice::hasFeature(const QString &featureStr)
+{
+    if (featureStr == "battery")
+        return SysfsAttribute::exists(devicePath, "charge_level");
+    if (featureStr == "custom_frame")
+        return getDeviceType() == "keyboard" && SysfsAttribute::exists(devicePath, "matrix_custom_frame");
+    if (featureStr == "dpi")
+        return SysfsAttribute::exists(devicePath, "dpi");
+    if (featureStr == "dpi_stages")
+        return SysfsAttribute::exists(devicePath, "dpi_stages");
+    if (featureStr == "idle_time")
+        return SysfsAttribute::exists(devicePath, "device_idle_time");
+    if (featureStr == "low_battery_threshold")
+        return SysfsAttribute::exists(devicePath, "charge_low_threshold");
+    if (featureStr == "poll_rate")
+        return SysfsAttribute::exists(devicePath, "poll_rate");
+    return false;
+}
+
+QString SysfsDevice::getDeviceImageUrl()
+{
+    // Only the daemon knows the images
+    return QString();
+}
+
+QList<libopenrazer::Led *> SysfsDevice::getLeds()
+{
+    return leds;
+}
+
+QString SysfsDevice::getDeviceName()
+{
+    return SysfsAttribute::readString(devicePath, "device_type");
+}
+
+QString SysfsDevice::getDeviceType()
+{
+    if (driver == "razerkbd")
+        return "keyboard";
+    if (driver == "razermouse")
+        return "mouse";
+    if (driver == "razerfirefly")
+        return "mousemat";
+    if (driver == "razerkraken")
+        return "headset";
+    return "accessory";
+}
+
+QString SysfsDevice::getFirmwareVersion()
+{
+    return SysfsAttribute::readString(devicePath, "firmware_version");
+}
+
+QString SysfsDevice::getKeyboardLayout()
+{
+    if (!SysfsAttribute::exists(devicePath, "kbd_layout"))
+        return "unknown";
+    return keyboardLayouts.value(SysfsAttribute::readString(devicePath, "kbd_layout").toUpper(), "unknown");
+}
+
+QString SysfsDevice::getSerial()
+{
+    return SysfsAttribute::readString(devicePath, "device_serial");
+}
+
+ushort SysfsDevice::getPollRate()
+{
+    return static_cast<ushort>(SysfsAttribute::readInt(devicePath, "poll_rate"));
+}
+
+void SysfsDevice::setPollRate(ushort pollrate)
+{
+    SysfsAttribute::writeInt(devicePath, "poll_rate", pollrate);
+}
+
+QVector<ushort> SysfsDevice::getSupportedPollRates()
+{
+    return { 125, 500, 1000 };
+}
+
+void SysfsDevice::setDPI(openrazer::DPI dpi)
+{
+    SysfsAttribute::write(devicePath, "dpi", dpiBytes(dpi));
+}
+
+openrazer::DPI SysfsDevice::getDPI()
+{
+    // Reads as "<x>:<y>"
+    QString value = SysfsAttribute::readString(devicePath, "dpi");
+    QStringList parts = value.split(':');
+    bool okX, okY = true;
+    ushort x = parts.value(0).toUShort(&okX);
+    ushort y = parts.size() > 1 ? parts.value(1).toUShort(&okY) : x;
+    if (!okX || !okY)
+        SysfsAttribute::throwError(QString("Unexpected DPI value: %1").arg(value));
+    return { x, y };
+}
+
+void SysfsDevice::setDPIStages(uchar activeStage, QVector<openrazer::DPI> dpiStages)
+{
+    QByteArray data;
+    data.append(static_cast<char>(activeStage));
+    for (const openrazer::DPI &stage : dpiStages)
+        data.append(dpiBytes(stage));
+    SysfsAttribute::write(devicePath, "dpi_stages", data);
+}
+
+QPair<uchar, QVector<openrazer::DPI>> SysfsDevice::getDPIStages()
+{
+    // The active stage followed by big endian x and y values of each stage
+    QByteArray data = SysfsAttribute::read(devicePath, "dpi_stages");
+    if (data.isEmpty())
+        SysfsAttribute::throwError("Empty DPI stages");
+
+    const auto *bytes = reinterpret_cast<const uchar *>(data.constData());
+    QVector<openrazer::DPI> stages;
+    for (int i = 1; i + 4 <= data.size(); i += 4) {
+        ushort x = (bytes[i] << 8) | bytes[i + 1];
+        ushort y = (bytes[i + 2] << 8) | bytes[i + 3];
+        stages.append({ x, y });
+    }
+    return qMakePair(bytes[0], stages);
+}
+
+ushort SysfsDevice::maxDPI()
+{
+    return fallbackMaxDPI;
+}
+
+QVector<ushort> SysfsDevice::getAllowedDPI()
+{
+    return {};
+}
+
+void SysfsDevice::displayCustomFrame()
+{
+    QByteArray frame;
+    {
+        QMutexLocker locker(&frameMutex);
+        frame.swap(pendingFrame);
+    }
+
+    if (!frame.isEmpty())
+        SysfsAttribute::write(devicePath, "matrix_custom_frame", frame);
+    SysfsAttribute::write(devicePath, "matrix_effect_custom", "1");
+}
+
+void SysfsDevice::defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<openrazer::RGB> colorData)
+{
+    // Each row is "<row> <start> <end>" followed by the RGB values, the
+    // driver accepts any number of rows in one write
+    QByteArray data;
+    data.reserve(3 + colorData.size() * 3);
+    data.append(static_cast<char>(row));
+    data.append(static_cast<char>(startColumn));
+    data.append(static_cast<char>(endColumn));
+    for (const openrazer::RGB &color : colorData) {
+        data.append(static_cast<char>(color.r));
+        data.append(static_cast<char>(color.g));
+        data.append(static_cast<char>(color.b));
+    }
+
+    QMutexLocker locker(&frameMutex);
+    pendingFrame.append(data);
+}
+
+openrazer::MatrixDimensions SysfsDevice::getMatrixDimensions()
+{
+    if (getDeviceType() == "keyboard")
+        return keyboardMatrix;
+    return { 0, 0 };
+}
+
+double SysfsDevice::getBatteryPercent()
+{
+    // The driver reports 0-255
+    return SysfsAttribute::readInt(devicePath, "charge_level") * 100.0 / 255.0;
+}
+
+bool SysfsDevice::isCharging()
+{
+    return SysfsAttribute::readInt(devicePath, "charge_status") != 0;
+}
+
+void SysfsDevice::setIdleTime(ushort idleTime)
+{
+    SysfsAttribute::writeInt(devicePath, "device_idle_time", idleTime);
+}
+
+ushort SysfsDevice::getIdleTime()
+{
+    return static_cast<ushort>(SysfsAttribute::readInt(devicePath, "device_idle_time"));
+}
+
+void SysfsDevice::setLowBatteryThreshold(uchar threshold)
+{
+    // Percent on our side, 0-255 on the driver's
+    SysfsAttribute::writeInt(devicePath, "charge_low_threshold", qRound(threshold * 255.0 / 100.0));
+}
+
+uchar SysfsDevice::getLowBatteryThreshold()
+{
+    return static_cast<uchar>(qRound(SysfsAttribute::readInt(devicePath, "charge_low_threshold") * 100.0 / 255.0));
+}
@@ -0,0 +1,68 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYSFSDEVICE_H
+#define SYSFSDEVICE_H
+
+#include <QMutex>
+#include <libopenrazer.h>
+
+/*
+ * A device bound to one of the openrazer kernel drivers, accessed through
+ * its attribute directory (e.g. /sys/bus/hid/drivers/razerkbd/0003:1532:0203.0001)
+ * without going through the daemon.
+ *
+ * Custom frame rows are collected by defineCustomFrame() and sent to the
+ * driver in one write by displayCustomFrame().
+ */
+class SysfsDevice : public libopenrazer::Device
+{
+public:
+    SysfsDevice(const QDBusObjectPath &objectPath, const QString &devicePath, const QString &driver);
+    ~SysfsDevice() override;
+
+    QDBusObjectPath objectPath() override;
+    bool hasFeature(const QString &featureStr) override;
+    QString getDeviceImageUrl() override;
+    QList<libopenrazer::Led *> getLeds() override;
+
+    QString getDeviceName() override;
+    QString getDeviceType() override;
+    QString getFirmwareVersion() override;
+    QString getKeyboardLayout() override;
+    QString getSerial() override;
+
+    ushort getPollRate() override;
+    void setPollRate(ushort pollrate) override;
+    QVector<ushort> getSupportedPollRates() override;
+
+    void setDPI(openrazer::DPI dpi) override;
+    openrazer::DPI getDPI() override;
+    void setDPIStages(uchar activeStage, QVector<openrazer::DPI> dpiStages) override;
+    QPair<uchar, QVector<openrazer::DPI>> getDPIStages() override;
+    ushort maxDPI() override;
+    QVector<ushort> getAllowedDPI() override;
+
+    void displayCustomFrame() override;
+    void defineCustomFrame(uchar row, uchar startColumn, uchar endColumn, QVector<openrazer::RGB> colorData) override;
+    openrazer::MatrixDimensions getMatrixDimensions() override;
+
+    double getBatteryPercent() override;
+    bool isCharging() override;
+    void setIdleTime(ushort idleTime) override;
+    ushort getIdleTime() override;
+    void setLowBatteryThreshold(uchar threshold) override;
+    uchar getLowBatteryThreshold() override;
+
+private:
+    QDBusObjectPath path;
+    QString devicePath;
+    QString driver;
+    QList<libopenrazer::Led *> leds;
+
+    QMutex frameMutex;
+    QByteArray pendingFrame;
+};
+
+#endif // SYSFSDEVICE_H
@@ -0,0 +1,210 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sysfsled.h"
+
+#include "sysfsattribute.h"
+
+static QByteArray rgbBytes(openrazer::RGB color)
+{
+    QByteArray data;
+    data.append(static_cast<char>(color.r));
+    data.append(static_cast<char>(color.g));
+    data.append(static_cast<char>(color.b));
+    return data;
+}
+
+SysfsLed::SysfsLed(const QString &devicePath, openrazer::LedId ledId, const QString &prefix, const QString &brightnessAttribute)
+{
+    this->devicePath = devicePath;
+    this->ledId = ledId;
+    this->prefix = prefix;
+    this->brightnessAttribute = brightnessAttribute;
+
+    // The devices start up with the spectrum effect where they have one
+    currentEffect = hasFx(openrazer::Effect::Spectrum) ? openrazer::Effect::Spectrum : openrazer::Effect::Static;
+    currentColors = { { 0, 255, 0 } };
+}
+
+SysfsLed::~SysfsLed() = default;
+
+SysfsLed *SysfsLed::create(const QString &devicePath, openrazer::LedId ledId, const QString &prefix)
+{
+    // The main zone uses "matrix_brightness", the others "<zone>_led_brightness"
+    QString brightnessAttribute = prefix.isEmpty() ? "matrix_brightness" : prefix + "led_brightness";
+
+    bool hasEffects = SysfsAttribute::exists(devicePath, prefix + "matrix_effect_none")
+            || SysfsAttribute::exists(devicePath, prefix + "matrix_effect_static")
+            || SysfsAttribute::exists(devicePath, prefix + "matrix_effect_spectrum");
+    if (!hasEffects && !SysfsAttribute::exists(devicePath, brightnessAttribute))
+        return nullptr;
+
+    return new SysfsLed(devicePath, ledId, prefix, brightnessAttribute);
+}
+
+openrazer::LedId SysfsLed::getLedId()
+{
+    return ledId;
+}
+
+QString SysfsLed::effectAttribute(openrazer::Effect fx) const
+{
+    QString name;
+    switch (fx) {
+    case openrazer::Effect::Off:
+        name = "none";
+        break;
+    case openrazer::Effect::On:
+        name = "on";
+        break;
+    case openrazer::Effect::Static:
+        name = "static";
+        break;
+    case openrazer::Effect::Breathing:
+    case openrazer::Effect::BreathingDual:
+    case openrazer::Effect::BreathingRandom:
+        name = "breath";
+        break;
+    case openrazer::Effect::Blinking:
+        name = "blinking";
+        break;
+    case openrazer::Effect::Spectrum:
+        name = "spectrum";
+        break;
+    case openrazer::Effect::Wave:
+        name = "wave";
+        break;
+    case openrazer::Effect::Wheel:
+        name = "wheel";
+        break;
+    case openrazer::Effect::Reactive:
+        name = "reactive";
+        break;
+    default:
+        // Ripple is done in software by the daemon, mono breathing isn't exposed by the driver
+        return QString();
+    }
+    return prefix + "matrix_effect_" + name;
+}
+
+bool SysfsLed::hasFx(openrazer::Effect fx)
+{
+    QString attribute = effectAttribute(fx);
+    return !attribute.isEmpty() && SysfsAttribute::exists(devicePath, attribute);
+}
+
+bool SysfsLed::hasBrightness()
+{
+    return SysfsAttribute::exists(devicePath, brightnessAttribute);
+}
+
+openrazer::Effect SysfsLed::getCurrentEffect()
+{
+    QMutexLocker locker(&stateMutex);
+    return currentEffect;
+}
+
+QVector<openrazer::RGB> SysfsLed::getCurrentColors()
+{
+    QMutexLocker locker(&stateMutex);
+    return currentColors;
+}
+
+void SysfsLed::writeEffect(openrazer::Effect fx, const QByteArray &data, const QVector<openrazer::RGB> &colors)
+{
+    QString attribute = effectAttribute(fx);
+    if (attribute.isEmpty())
+        SysfsAttribute::throwError(QString("Effect %1 is not supported by the kernel driver").arg(static_cast<int>(fx)));
+
+    SysfsAttribute::write(devicePath, attribute, data);
+
+    QMutexLocker locker(&stateMutex);
+    currentEffect = fx;
+    if (!colors.isEmpty())
+        currentColors = colors;
+}
+
+void SysfsLed::setOff()
+{
+    writeEffect(openrazer::Effect::Off, "1");
+}
+
+void SysfsLed::setOn()
+{
+    writeEffect(openrazer::Effect::On, "1");
+}
+
+void SysfsLed::setStatic(openrazer::RGB color)
+{
+    writeEffect(openrazer::Effect::Static, rgbBytes(color), { color });
+}
+
+void SysfsLed::setBreathing(openrazer::RGB color)
+{
+    writeEffect(openrazer::Effect::Breathing, rgbBytes(color), { color });
+}
+
+void SysfsLed::setBreathingDual(openrazer::RGB color, openrazer::RGB color2)
+{
+    writeEffect(openrazer::Effect::BreathingDual, rgbBytes(color) + rgbBytes(color2), { color, color2 });
+}
+
+void SysfsLed::setBreathingRandom()
+{
+    // A single byte selects the random mode
+    writeEffect(openrazer::Effect::BreathingRandom, "1");
+}
+
+void SysfsLed::setBreathingMono()
+{
+    writeEffect(openrazer::Effect::BreathingMono, QByteArray());
+}
+
+void SysfsLed::setBlinking(openrazer::RGB color)
+{
+    writeEffect(openrazer::Effect::Blinking, rgbBytes(color), { color });
+}
+
+void SysfsLed::setSpectrum()
+{
+    writeEffect(openrazer::Effect::Spectrum, "1");
+}
+
+void SysfsLed::setWave(openrazer::WaveDirection direction)
+{
+    writeEffect(openrazer::Effect::Wave, direction == openrazer::WaveDirection::LEFT_TO_RIGHT ? "1" : "2");
+}
+
+void SysfsLed::setWheel(openrazer::WheelDirection direction)
+{
+    writeEffect(openrazer::Effect::Wheel, direction == openrazer::WheelDirection::CLOCKWISE ? "1" : "2");
+}
+
+void SysfsLed::setReactive(openrazer::RGB color, openrazer::ReactiveSpeed speed)
+{
+    QByteArray data;
+    data.append(static_cast<char>(speed));
+    data.append(rgbBytes(color));
+    writeEffect(openrazer::Effect::Reactive, data, { color });
+}
+
+void SysfsLed::setRipple(openrazer::RGB /* color */)
+{
+    writeEffect(openrazer::Effect::Ripple, QByteArray());
+}
+
+void SysfsLed::setRippleRandom()
+{
+    writeEffect(openrazer::Effect::RippleRandom, QByteArray());
+}
+
+void SysfsLed::setBrightness(uchar brightness)
+{
+    SysfsAttribute::writeInt(devicePath, brightnessAttribute, brightness);
+}
+
+uchar SysfsLed::getBrightness()
+{
+    return static_cast<uchar>(qBound(0, SysfsAttribute::readInt(devicePath, brightnessAttribute), 255));
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYSFSLED_H
+#define SYSFSLED_H
+
+#include <QMutex>
+#include <libopenrazer.h>
+
+/*
+ * One lighting zone of a device driven by the kernel driver, e.g. the
+ * logo or the scroll wheel. The attributes of a zone share a prefix
+ * ("logo_matrix_effect_static", "logo_led_brightness", ...).
+ *
+ * The driver can't report the active effect, so the last one set through
+ * this object is remembered instead.
+ */
+class SysfsLed : public libopenrazer::Led
+{
+public:
+    SysfsLed(const QString &devicePath, openrazer::LedId ledId, const QString &prefix, const QString &brightnessAttribute);
+    ~SysfsLed() override;
+
+    /* Returns the LED for the given zone, or nullptr if the device doesn't have it */
+    static SysfsLed *create(const QString &devicePath, openrazer::LedId ledId, const QString &prefix);
+
+    openrazer::LedId getLedId() override;
+    bool hasFx(openrazer::Effect fx) override;
+    bool hasBrightness() override;
+    openrazer::Effect getCurrentEffect() override;
+    QVector<openrazer::RGB> getCurrentColors() override;
+
+    void setOff() override;
+    void setOn() override;
+    void setStatic(openrazer::RGB color) override;
+    void setBreathing(openrazer::RGB color) override;
+    void setBreathingDual(openrazer::RGB color, openrazer::RGB color2) override;
+    void setBreathingRandom() override;
+    void setBreathingMono() override;
+    void setBlinking(openrazer::RGB color) override;
+    void setSpectrum() override;
+    void setWave(openrazer::WaveDirection direction) override;
+    void setWheel(openrazer::WheelDirection direction) override;
+    void setReactive(openrazer::RGB color, openrazer::ReactiveSpeed speed) override;
+    void setRipple(openrazer::RGB color) override;
+    void setRippleRandom() override;
+
+    void setBrightness(uchar brightness) override;
+    uchar getBrightness() override;
+
+private:
+    QString devicePath;
+    openrazer::LedId ledId;
+    QString prefix;
+    QString brightnessAttribute;
+
+    QMutex stateMutex;
+    openrazer::Effect currentEffect;
+    QVector<openrazer::RGB> currentColors;
+
+    QString effectAttribute(openrazer::Effect fx) const;
+    void writeEffect(openrazer::Effect fx, const QByteArray &data, const QVector<openrazer::RGB> &colors = {});
+};
+
+#endif // SYSFSLED_H
@@ -0,0 +1,233 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sysfsmanager.h"
+
+#include "sysfsdevice.h"
+
+#include <QDBusServiceWatcher>
+#include <QDir>
+#include <QFile>
+#include <QFileSystemWatcher>
+#include <QRegularExpression>
+#include <QSettings>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <algorithm>
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* HID devices are named <bus>:<vendor>:<product>.<instance>, 1532 is Razer */
+static const QRegularExpression hidDeviceName("^[0-9A-F]{4}:1532:[0-9A-F]{4}\\.[0-9A-F]{4}$");
+
+SysfsManager::SysfsManager(const QString &root)
+{
+    this->root = root;
+    serviceWatcher = new QDBusServiceWatcher(this);
+    fileSystemWatcher = nullptr;
+    ueventNotifier = nullptr;
+    ueventSocket = -1;
+
+    // The driver binds a while after the uevent, and one device sends
+    // several of them (one per interface)
+    changeTimer = new QTimer(this);
+    changeTimer->setSingleShot(true);
+    changeTimer->setInterval(500);
+    connect(changeTimer, &QTimer::timeout, this, [=]() {
+        scan();
+        emit devicesChanged();
+    });
+
+    scan();
+    setupHotplug();
+}
+
+SysfsManager::~SysfsManager()
+{
+    if (ueventSocket != -1)
+        ::close(ueventSocket);
+}
+
+QString SysfsManager::getDefaultRoot()
+{
+    QString root = qEnvironmentVariable("RAZERGENIE_SYSFS_ROOT");
+    if (root.isEmpty())
+        root = QSettings().value("sysfsRoot", "/sys").toString();
+    return root;
+}
+
+QString SysfsManager::getDriversPath() const
+{
+    return root + "/bus/hid/drivers";
+}
+
+QStringList SysfsManager::getDriverNames() const
+{
+    return QDir(getDriversPath()).entryList({ "razer*" }, QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+}
+
+void SysfsManager::scan()
+{
+    devicePaths.clear();
+
+    for (const QString &driver : getDriverNames()) {
+        QDir driverDir(getDriversPath() + "/" + driver);
+        for (const QString &name : driverDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name)) {
+            if (!hidDeviceName.match(name).hasMatch())
+                continue;
+            // Every interface of a device is bound to the driver, only one
+            // of them has the attributes
+            QString devicePath = driverDir.filePath(name);
+            if (!QFile::exists(devicePath + "/device_type"))
+                continue;
+
+            QString objectPath = "/io/github/openrazer/razergenie/sysfs/" + driver + "/" + QString(name).replace(QRegularExpression("[^A-Za-z0-9]"), "_");
+            devicePaths.insert(objectPath, qMakePair(devicePath, driver));
+        }
+    }
+}
+
+void SysfsManager::setupHotplug()
+{
+    // Real sysfs doesn't report changes through inotify, the kernel sends uevents instead
+    ueventSocket = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (ueventSocket != -1) {
+        sockaddr_nl address = {};
+        address.nl_family = AF_NETLINK;
+        address.nl_groups = 1; // kernel uevents
+        if (::bind(ueventSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0) {
+            ueventNotifier = new QSocketNotifier(ueventSocket, QSocketNotifier::Read, this);
+            connect(ueventNotifier, &QSocketNotifier::activated, this, &SysfsManager::readUevent);
+        } else {
+            qWarning("SysfsManager: Failed to bind uevent socket, devices won't be hotplugged");
+            ::close(ueventSocket);
+            ueventSocket = -1;
+        }
+    }
+
+    // A fake tree is a normal directory, watch that for devices being created
+    if (root != "/sys") {
+        fileSystemWatcher = new QFileSystemWatcher(this);
+        fileSystemWatcher->addPath(getDriversPath());
+        for (const QString &driver : getDriverNames())
+            fileSystemWatcher->addPath(getDriversPath() + "/" + driver);
+        connect(fileSystemWatcher, &QFileSystemWatcher::directoryChanged, this, [=]() {
+            for (const QString &driver : getDriverNames())
+                fileSystemWatcher->addPath(getDriversPath() + "/" + driver);
+            changeTimer->start();
+        });
+    }
+}
+
+void SysfsManager::readUevent()
+{
+    char buffer[4096];
+    ssize_t length;
+    bool relevant = false;
+    while ((length = ::recv(ueventSocket, buffer, sizeof(buffer) - 1, 0)) > 0) {
+        // "<action>@<devpath>" followed by null separated KEY=value pairs
+        QList<QByteArray> fields = QByteArray(buffer, length).split('\0');
+        if (!fields.contains("SUBSYSTEM=hid"))
+            continue;
+        // Remove and unbind don't carry DRIVER=, the device name in the
+        // path still tells it's a Razer device
+        QByteArray devicePath = fields.first().mid(fields.first().indexOf('@') + 1);
+        if (hidDeviceName.match(QString::fromUtf8(devicePath.mid(devicePath.lastIndexOf('/') + 1))).hasMatch())
+            relevant = true;
+        for (const QByteArray &field : fields)
+            relevant |= field.startsWith("HID_ID=0003:00001532:") || field.startsWith("DRIVER=razer");
+    }
+    if (relevant)
+        changeTimer->start();
+}
+
+QList<QDBusObjectPath> SysfsManager::getDevices()
+{
+    QList<QDBusObjectPath> list;
+    for (const QString &objectPath : devicePaths.keys())
+        list.append(QDBusObjectPath(objectPath));
+    std::sort(list.begin(), list.end(), [](const QDBusObjectPath &a, const QDBusObjectPath &b) {
+        return a.path() < b.path();
+    });
+    return list;
+}
+
+libopenrazer::Device *SysfsManager::getDevice(QDBusObjectPath objectPath)
+{
+    if (!devicePaths.contains(objectPath.path()))
+        return nullptr;
+    QPair<QString, QString> device = devicePaths.value(objectPath.path());
+    return new SysfsDevice(objectPath, device.first, device.second);
+}
+
+QString SysfsManager::getDaemonVersion()
+{
+    // Reports the version of the first loaded driver module
+    for (const QString &driver : getDriverNames()) {
+        QFile file(root + "/module/" + driver + "/version");
+        if (file.open(QIODevice::ReadOnly))
+            return QString::fromUtf8(file.readAll()).trimmed();
+    }
+    return "unknown";
+}
+
+bool SysfsManager::isDaemonRunning()
+{
+    return !getDriverNames().isEmpty();
+}
+
+QVariantHash SysfsManager::getSupportedDevices()
+{
+    // The list of the drivers isn't exposed through sysfs
+    return QVariantHash();
+}
+
+bool SysfsManager::syncEffects(bool /* yes */)
+{
+    // Syncing is done by the daemon
+    return false;
+}
+
+bool SysfsManager::getSyncEffects()
+{
+    return false;
+}
+
+bool SysfsManager::setTurnOffOnScreensaver(bool /* turnOffOnScreensaver */)
+{
+    return false;
+}
+
+bool SysfsManager::getTurnOffOnScreensaver()
+{
+    return false;
+}
+
+libopenrazer::DaemonStatus SysfsManager::getDaemonStatus()
+{
+    return isDaemonRunning() ? libopenrazer::DaemonStatus::Enabled : libopenrazer::DaemonStatus::NotInstalled;
+}
+
+QString SysfsManager::getDaemonStatusOutput()
+{
+    return QString("No openrazer kernel driver found in %1").arg(getDriversPath());
+}
+
+bool SysfsManager::enableDaemon()
+{
+    // Nothing to start, the driver is loaded by the kernel
+    return true;
+}
+
+bool SysfsManager::connectDevicesChanged(QObject *receiver, const char *slot)
+{
+    return static_cast<bool>(connect(this, SIGNAL(devicesChanged()), receiver, slot));
+}
+
+QDBusServiceWatcher *SysfsManager::getServiceWatcher()
+{
+    // There's no service to watch, this watcher never fires
+    return serviceWatcher;
+}
@@ -0,0 +1,71 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef SYSFSMANAGER_H
+#define SYSFSMANAGER_H
+
+#include <QHash>
+#include <libopenrazer.h>
+
+class QDBusServiceWatcher;
+class QFileSystemWatcher;
+class QSocketNotifier;
+class QTimer;
+
+/*
+ * Backend talking to the openrazer kernel drivers directly through sysfs,
+ * without the daemon. Lighting and custom frames skip the D-Bus round trip,
+ * software effects and device images of the daemon aren't available.
+ *
+ * Devices are searched in <root>/bus/hid/drivers/razer*. The root is "/sys"
+ * unless overridden with the RAZERGENIE_SYSFS_ROOT environment variable or
+ * the "sysfsRoot" setting, which allows running against a fake attribute
+ * tree.
+ */
+class SysfsManager : public libopenrazer::Manager
+{
+    Q_OBJECT
+public:
+    explicit SysfsManager(const QString &root = getDefaultRoot());
+    ~SysfsManager() override;
+
+    static QString getDefaultRoot();
+
+    QList<QDBusObjectPath> getDevices() override;
+    libopenrazer::Device *getDevice(QDBusObjectPath objectPath) override;
+    QString getDaemonVersion() override;
+    bool isDaemonRunning() override;
+    QVariantHash getSupportedDevices() override;
+    bool syncEffects(bool yes) override;
+    bool getSyncEffects() override;
+    bool setTurnOffOnScreensaver(bool turnOffOnScreensaver) override;
+    bool getTurnOffOnScreensaver() override;
+    libopenrazer::DaemonStatus getDaemonStatus() override;
+    QString getDaemonStatusOutput() override;
+    bool enableDaemon() override;
+    bool connectDevicesChanged(QObject *receiver, const char *slot) override;
+    QDBusServiceWatcher *getServiceWatcher() override;
+
+signals:
+    void devicesChanged();
+
+private:
+    QString root;
+    /* Object path -> (attribute directory, driver name) */
+    QHash<QString, QPair<QString, QString>> devicePaths;
+
+    QDBusServiceWatcher *serviceWatcher;
+    QFileSystemWatcher *fileSystemWatcher;
+    QSocketNotifier *ueventNotifier;
+    int ueventSocket;
+    QTimer *changeTimer;
+
+    QString getDriversPath() const;
+    QStringList getDriverNames() const;
+    void scan();
+    void setupHotplug();
+    void readUevent();
+};
+
+#endif // SYSFSMANAGER_H
@@ -0,0 +1,55 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailcache.h"
+
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+
+QImage ThumbnailCache::load(const QString &imagePath, const QSize &size, qreal devicePixelRatio)
+{
+    QSize pixelSize = size * devicePixelRatio;
+    QString thumbnailPath = getThumbnailPath(imagePath, pixelSize);
+
+    QFileInfo imageInfo(imagePath);
+    QFileInfo thumbnailInfo(thumbnailPath);
+
+    QImage image;
+    if (thumbnailInfo.exists() && thumbnailInfo.lastModified() >= imageInfo.lastModified()) {
+        image.load(thumbnailPath);
+    }
+
+    if (image.isNull()) {
+        QImageReader reader(imagePath);
+        QSize imageSize = reader.size();
+        if (imageSize.isValid())
+            reader.setScaledSize(imageSize.scaled(pixelSize, Qt::KeepAspectRatio));
+        image = reader.read();
+        if (image.isNull()) {
+            qWarning("ThumbnailCache: Failed to read %s: %s", qUtf8Printable(imagePath), qUtf8Printable(reader.errorString()));
+            return image;
+        }
+
+        // Written atomically, other instances might be reading it at the same time
+        QSaveFile file(thumbnailPath);
+        if (file.open(QIODevice::WriteOnly)) {
+            QImageWriter writer(&file, "png");
+            if (writer.write(image))
+                file.commit();
+            else
+                file.cancelWriting();
+        }
+    }
+
+    image.setDevicePixelRatio(devicePixelRatio);
+    return image;
+}
+
+QString ThumbnailCache::getThumbnailPath(const QString &imagePath, const QSize &pixelSize)
+{
+    QFileInfo info(imagePath);
+    return info.absolutePath() + "/" + info.completeBaseName() + QString(".thumb-%1x%2.png").arg(pixelSize.width()).arg(pixelSize.height());
+}
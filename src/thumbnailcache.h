@@ -0,0 +1,26 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QImage>
+#include <QString>
+
+/*
+ * Small pre-scaled copies of the device images.
+ *
+ * Thumbnails are stored next to the original image and get recreated when
+ * the original is newer. Creating one decodes the original straight into
+ * the target size, the full size image is never held in memory.
+ */
+namespace ThumbnailCache {
+/* Returns the thumbnail of the image fitted into size (in device independent
+ * pixels) at the given device pixel ratio. Blocks, call it from a worker thread. */
+QImage load(const QString &imagePath, const QSize &size, qreal devicePixelRatio);
+
+QString getThumbnailPath(const QString &imagePath, const QSize &pixelSize);
+}
+
+#endif // THUMBNAILCACHE_H
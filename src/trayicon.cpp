@@ -0,0 +1,97 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "trayicon.h"
+
+#include "backgroundservices.h"
+#include "profiles/profile.h"
+#include "razergenie.h"
+
+#include <QApplication>
+#include <QMenu>
+#include <QTimer>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+TrayIcon::TrayIcon(BackgroundServices *services, QObject *parent)
+    : QObject(parent)
+{
+    this->services = services;
+
+    menu = new QMenu();
+    menu->addAction(QIcon::fromTheme("xyz.z3ntu.razergenie"), tr("Open RazerGenie"), this, &TrayIcon::showWindow);
+    menu->addSeparator();
+    profilesMenu = menu->addMenu(tr("Apply profile"));
+    connect(profilesMenu, &QMenu::aboutToShow, this, &TrayIcon::updateProfilesMenu);
+    menu->addSeparator();
+    menu->addAction(QIcon::fromTheme("application-exit"), tr("Quit"), qApp, &QApplication::quit);
+
+    trayIcon = new QSystemTrayIcon(QIcon::fromTheme("xyz.z3ntu.razergenie"), this);
+    trayIcon->setToolTip("RazerGenie");
+    trayIcon->setContextMenu(menu);
+    connect(trayIcon, &QSystemTrayIcon::activated, this, &TrayIcon::activated);
+    trayIcon->show();
+
+    if (!QSystemTrayIcon::isSystemTrayAvailable())
+        qWarning("No system tray available, RazerGenie keeps running in the background without an icon.");
+}
+
+TrayIcon::~TrayIcon()
+{
+    delete window;
+    delete menu;
+}
+
+void TrayIcon::showWindow()
+{
+    if (window == nullptr) {
+        window = new RazerGenie(services);
+        window->setAttribute(Qt::WA_DeleteOnClose);
+        connect(window, &QObject::destroyed, this, &TrayIcon::windowDestroyed);
+    }
+    window->show();
+    window->raise();
+    window->activateWindow();
+}
+
+void TrayIcon::activated(QSystemTrayIcon::ActivationReason reason)
+{
+    if (reason != QSystemTrayIcon::Trigger && reason != QSystemTrayIcon::DoubleClick)
+        return;
+
+    if (window != nullptr && window->isVisible() && window->isActiveWindow()) {
+        window->close();
+    } else {
+        showWindow();
+    }
+}
+
+void TrayIcon::updateProfilesMenu()
+{
+    profilesMenu->clear();
+
+    QStringList profiles = Profile::list();
+    for (const QString &name : profiles) {
+        profilesMenu->addAction(name, this, [=]() {
+            if (!services->applyProfile(name))
+                qWarning("Failed to load the profile %s", qUtf8Printable(name));
+        });
+    }
+    if (profiles.isEmpty()) {
+        profilesMenu->addAction(tr("No profiles saved"))->setEnabled(false);
+    }
+}
+
+void TrayIcon::windowDestroyed()
+{
+#ifdef __GLIBC__
+    // Hand the memory of the torn down window back to the system once all
+    // deferred deletes of its children have run
+    QTimer::singleShot(0, this, []() {
+        malloc_trim(0);
+    });
+#endif
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2026  Luca Weiss <luca (at) z3ntu (dot) xyz>
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef TRAYICON_H
+#define TRAYICON_H
+
+#include <QObject>
+#include <QPointer>
+#include <QSystemTrayIcon>
+
+class BackgroundServices;
+class QMenu;
+class RazerGenie;
+
+/*
+ * Tray icon for running RazerGenie in the background.
+ *
+ * Only the background services exist until the icon is activated. The main
+ * window is created on demand and destroyed again once it gets closed.
+ */
+class TrayIcon : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TrayIcon(BackgroundServices *services, QObject *parent = nullptr);
+    ~TrayIcon() override;
+
+    void showWindow();
+
+private:
+    BackgroundServices *services;
+    QSystemTrayIcon *trayIcon;
+    QMenu *menu;
+    QMenu *profilesMenu;
+    QPointer<RazerGenie> window;
+
+    void activated(QSystemTrayIcon::ActivationReason reason);
+    void updateProfilesMenu();
+    void windowDestroyed();
+};
+
+#endif // TRAYICON_H
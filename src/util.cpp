@@ -4,18 +4,41 @@
 
 #include "util.h"
 
-#include <QMessageBox>
+#include "notificationcenter.h"
 
-void util::showError(QString error)
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <libopenrazer.h>
+
+void util::showError(QString error, QString category)
+{
+    NotificationCenter::instance()->post(NotificationCenter::Error, error, category);
+}
+
+void util::showInfo(QString info, QString category)
+{
+    NotificationCenter::instance()->post(NotificationCenter::Info, info, category);
+}
+
+QString util::deviceCategory(libopenrazer::Device *device, const QString &setting)
 {
-    QMessageBox messageBox;
-    messageBox.critical(nullptr, QMessageBox::tr("Error!"), error);
-    messageBox.setFixedSize(500, 200);
+    return device->objectPath().path() + "/" + setting;
 }
 
-void util::showInfo(QString info)
+void util::sendNotification(QString summary, QString body)
 {
-    QMessageBox messageBox;
-    messageBox.information(nullptr, QMessageBox::tr("Information!"), info);
-    messageBox.setFixedSize(500, 200);
+    QDBusMessage message = QDBusMessage::createMethodCall("org.freedesktop.Notifications",
+                                                          "/org/freedesktop/Notifications",
+                                                          "org.freedesktop.Notifications",
+                                                          "Notify");
+    message << QString("RazerGenie") // app_name
+            << uint(0) // replaces_id
+            << QString("xyz.z3ntu.razergenie") // app_icon
+            << summary
+            << body
+            << QStringList() // actions
+            << QVariantMap() // hints
+            << int(-1); // expire_timeout
+    if (!QDBusConnection::sessionBus().send(message))
+        qInfo("%s: %s", qUtf8Printable(summary), qUtf8Printable(body));
 }
@@ -7,6 +7,10 @@
 
 #include <QString>
 
+namespace libopenrazer {
+class Device;
+}
+
 #define QCOLOR_TO_RGB(c)                       \
     openrazer::RGB                             \
     {                                          \
@@ -16,8 +20,14 @@
     }
 
 namespace util {
-void showError(QString error);
-void showInfo(QString info);
+/* Both show a notification in the window, see NotificationCenter. Messages
+ * of the same category are rate limited together. */
+void showError(QString error, QString category = QString());
+void showInfo(QString info, QString category = QString());
+/* Category for the messages about one setting of a device */
+QString deviceCategory(libopenrazer::Device *device, const QString &setting);
+/* Shows a desktop notification without interrupting the user */
+void sendNotification(QString summary, QString body);
 }
 
 #endif // UTIL_H